@@ -83,6 +83,11 @@
   </ul>
   MP3 is not supported, and will not be supported.
  </p>
+ <p>
+  MAME "CHD" CD-ROM images(version 5, as made by "chdman createcd") are also supported, with the "cdzl", "cdzs", and "cdlz" codecs, and with "cdfl" when Mednafen
+  is built with FLAC support.  CHD images are decompressed as they're read, a hunk at a time, so they don't need CD image memory caching.  CHD images that depend on a
+  parent CHD are not supported, nor are CHD tracks with "RW" subchannel data("RW_RAW" and "NONE" are).
+ </p>
  <p>
   The cdrdao "TOC" support in Mednafen includes support for "RW_RAW" subchannel data, needed for CD+G.  Note that Mednafen assumes that the Q subchannel
   is also included in the RW_RAW data area in the disc image(even though the name "RW_RAW" would suggest it isn't present, cdrdao seems to included it).  If
@@ -46,6 +46,7 @@ namespace Time
  static INLINE std::string StrTime(void) { return StrTime("%c", LocalTime()); }
 
  int64 MonoUS(void);	// Microseconds
+ int64 MonoNS(void);	// Nanoseconds; for measuring short intervals, may be no more precise than MonoUS() on some platforms.
  static INLINE uint32 MonoMS(void) { return MonoUS() / 1000; } // Milliseconds
 
  void SleepMS(uint32) noexcept;	// Sleep for approximately the time specified in milliseconds.
@@ -0,0 +1,135 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* UsageMap.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "mednafen.h"
+#include "UsageMap.h"
+
+namespace Mednafen
+{
+
+UsageMap::UsageMap(const unsigned address_bits, const unsigned counter_bits) : AddressBits(address_bits), CounterBits(counter_bits),
+	PageBits(std::min<unsigned>(address_bits, 16)),
+	AddressMask((address_bits >= 32) ? 0xFFFFFFFF : ((1U << address_bits) - 1)),
+	PageMask((1U << PageBits) - 1),
+	PageCount(1U << (address_bits - PageBits))
+{
+ assert(counter_bits == 8 || counter_bits == 16);
+ assert(address_bits <= 32);
+
+ Pages.reset(new std::unique_ptr<uint8[]>[PageCount]);
+}
+
+UsageMap::~UsageMap()
+{
+
+}
+
+uint8* UsageMap::AllocPage(const uint32 page)
+{
+ const size_t size = ((size_t)1 << PageBits) * (CounterBits / 8);
+
+ Pages[page].reset(new uint8[size]);
+ memset(Pages[page].get(), 0, size);
+
+ return Pages[page].get();
+}
+
+uint32 UsageMap::Get(uint32 A) const
+{
+ A &= AddressMask;
+
+ const uint8* p = Pages[A >> PageBits].get();
+
+ if(!p)
+  return 0;
+
+ A &= PageMask;
+
+ if(CounterBits == 16)
+  return ((const uint16*)p)[A];
+
+ return p[A];
+}
+
+void UsageMap::Export(uint32 A, uint32 count, uint16* out) const
+{
+ while(count)
+ {
+  A &= AddressMask;
+
+  const uint8* p = Pages[A >> PageBits].get();
+  const uint32 offs = A & PageMask;
+  const uint32 run = std::min<uint32>(count, PageMask + 1 - offs);
+
+  if(!p)
+   memset(out, 0, run * sizeof(uint16));
+  else if(CounterBits == 16)
+   memcpy(out, (const uint16*)p + offs, run * sizeof(uint16));
+  else
+  {
+   for(uint32 i = 0; i < run; i++)
+    out[i] = p[offs + i];
+  }
+
+  out += run;
+  A += run;
+  count -= run;
+ }
+}
+
+void UsageMap::Clear(void)
+{
+ for(uint32 i = 0; i < PageCount; i++)
+  Pages[i].reset(nullptr);
+}
+
+void UsageMap::Clear(uint32 A, uint32 count)
+{
+ while(count)
+ {
+  A &= AddressMask;
+
+  uint8* p = Pages[A >> PageBits].get();
+  const uint32 offs = A & PageMask;
+  const uint32 run = std::min<uint32>(count, PageMask + 1 - offs);
+
+  if(p)
+   memset(p + offs * (CounterBits / 8), 0, run * (CounterBits / 8));
+
+  A += run;
+  count -= run;
+ }
+}
+
+uint64 UsageMap::MemUsed(void) const
+{
+ uint64 ret = (uint64)PageCount * sizeof(Pages[0]);
+
+ for(uint32 i = 0; i < PageCount; i++)
+ {
+  if(Pages[i])
+   ret += ((uint64)1 << PageBits) * (CounterBits / 8);
+ }
+
+ return ret;
+}
+
+}
@@ -0,0 +1,104 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* UsageMap.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_USAGEMAP_H
+#define __MDFN_USAGEMAP_H
+
+namespace Mednafen
+{
+
+//
+// Per-address access counters for an address space, saturating at 8 or 16 bits.  Counters are stored in a flat
+// table of pages of up to 64Ki addresses each; a page is allocated(zeroed) the first time an address in it is
+// counted, so a sparsely-used large address space doesn't cost memory for the parts never touched.  Inc() is a
+// mask, a table lookup, and an add once its page exists.
+//
+class UsageMap
+{
+ public:
+
+ // 'counter_bits' must be 8 or 16.
+ UsageMap(const unsigned address_bits, const unsigned counter_bits) MDFN_COLD;
+ ~UsageMap() MDFN_COLD;
+
+ UsageMap(const UsageMap&) = delete;
+ UsageMap& operator=(const UsageMap&) = delete;
+
+ INLINE void Inc(uint32 A)
+ {
+  A &= AddressMask;
+
+  uint8* p = Pages[A >> PageBits].get();
+
+  if(MDFN_UNLIKELY(!p))
+   p = AllocPage(A >> PageBits);
+
+  A &= PageMask;
+
+  if(CounterBits == 16)
+  {
+   uint16* c = (uint16*)p + A;
+
+   *c += (*c != 0xFFFF);
+  }
+  else
+   p[A] += (p[A] != 0xFF);
+ }
+
+ INLINE void Inc(const uint32 A, const uint32 count)
+ {
+  for(uint32 i = 0; i < count; i++)
+   Inc(A + i);
+ }
+
+ uint32 Get(uint32 A) const;
+
+ // Copies the counters for addresses A through A + count - 1(wrapping at the end of the address space) to 'out'.
+ void Export(uint32 A, uint32 count, uint16* out) const;
+
+ // Zeroes all counters and frees all pages.
+ void Clear(void);
+
+ // Zeroes the counters for addresses A through A + count - 1(wrapping), keeping their pages.
+ void Clear(uint32 A, uint32 count);
+
+ // Bytes currently allocated for counters.
+ uint64 MemUsed(void) const;
+
+ INLINE unsigned GetAddressBits(void) const { return AddressBits; }
+ INLINE unsigned GetCounterBits(void) const { return CounterBits; }
+
+ private:
+
+ uint8* AllocPage(const uint32 page) MDFN_COLD;
+
+ const unsigned AddressBits;
+ const unsigned CounterBits;
+ const unsigned PageBits;
+ const uint32 AddressMask;
+ const uint32 PageMask;
+ const uint32 PageCount;
+
+ std::unique_ptr<std::unique_ptr<uint8[]>[]> Pages;
+};
+
+}
+#endif
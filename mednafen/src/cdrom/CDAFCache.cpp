@@ -0,0 +1,276 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAFCache.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <mednafen/mednafen.h>
+#include "CDAFCache.h"
+
+namespace Mednafen
+{
+
+static int DecodeThreadStart_C(void* arg)
+{
+ return ((CDAFCache*)arg)->DecodeThreadStart();
+}
+
+CDAFCache::CDAFCache(const std::vector<CDAFReader*>& readers) : DecodeThread(NULL), CacheMutex(NULL), WorkCond(NULL), DoneCond(NULL),
+	Running(true), ChunkCount(0), UseCounter(0), DemandSource(NULL), DemandChunk(0), AheadSource(NULL), AheadChunk(0), AheadCount(0)
+{
+ Sources.resize(readers.size());
+
+ for(size_t i = 0; i < readers.size(); i++)
+ {
+  Source* s = &Sources[i];
+
+  s->ar = readers[i];
+  s->frame_count = s->ar->FrameCount();
+  s->chunks.resize((s->frame_count + ChunkFrames - 1) / ChunkFrames);
+ }
+
+ try
+ {
+  CacheMutex = MThreading::Mutex_Create();
+  WorkCond = MThreading::Cond_Create();
+  DoneCond = MThreading::Cond_Create();
+
+  DecodeThread = MThreading::Thread_Create(DecodeThreadStart_C, this, "MDFN CDDA Decode");
+ }
+ catch(...)
+ {
+  if(DoneCond)
+   MThreading::Cond_Destroy(DoneCond);
+
+  if(WorkCond)
+   MThreading::Cond_Destroy(WorkCond);
+
+  if(CacheMutex)
+   MThreading::Mutex_Destroy(CacheMutex);
+
+  throw;
+ }
+}
+
+CDAFCache::~CDAFCache()
+{
+ MThreading::Mutex_Lock(CacheMutex);
+ Running = false;
+ MThreading::Cond_Signal(WorkCond);
+ MThreading::Mutex_Unlock(CacheMutex);
+
+ MThreading::Thread_Wait(DecodeThread, NULL);
+
+ MThreading::Cond_Destroy(DoneCond);
+ MThreading::Cond_Destroy(WorkCond);
+ MThreading::Mutex_Destroy(CacheMutex);
+}
+
+// Called without CacheMutex held; only the decode thread reads from the CDAFReader objects.
+void CDAFCache::DecodeChunk(Source* s, const uint32 ci, Chunk* c)
+{
+ const uint64 start = (uint64)ci * ChunkFrames;
+
+ c->data.reset(new int16[ChunkFrames * 2]);
+ c->frames = 0;
+
+ try
+ {
+  while(c->frames < ChunkFrames)
+  {
+   const uint64 frames_read = s->ar->Read(start + c->frames, &c->data[c->frames * 2], ChunkFrames - c->frames);
+
+   if(!frames_read || frames_read > (ChunkFrames - c->frames))
+    break;
+
+   c->frames += frames_read;
+  }
+ }
+ catch(std::exception& e)
+ {
+  c->error = e.what();
+ }
+}
+
+// Called with CacheMutex held.
+void CDAFCache::InsertChunk(Source* s, const uint32 ci, std::unique_ptr<Chunk> c)
+{
+ if(ChunkCount >= MaxChunks)
+ {
+  std::unique_ptr<Chunk>* victim = NULL;
+
+  for(auto& so : Sources)
+  {
+   for(auto& ch : so.chunks)
+   {
+    if(ch && (!victim || ch->last_use < (*victim)->last_use))
+     victim = &ch;
+   }
+  }
+
+  victim->reset();
+  ChunkCount--;
+ }
+
+ c->last_use = ++UseCounter;
+ s->chunks[ci] = std::move(c);
+ ChunkCount++;
+}
+
+int CDAFCache::DecodeThreadStart(void)
+{
+ MThreading::Mutex_Lock(CacheMutex);
+
+ while(Running)
+ {
+  Source* s;
+  uint32 ci;
+
+  if(DemandSource)
+  {
+   s = DemandSource;
+   ci = DemandChunk;
+  }
+  else if(AheadCount)
+  {
+   s = AheadSource;
+   ci = AheadChunk;
+
+   if(ci >= s->chunks.size())
+   {
+    AheadCount = 0;
+    continue;
+   }
+  }
+  else
+  {
+   MThreading::Cond_Wait(WorkCond, CacheMutex);
+   continue;
+  }
+
+  if(!s->chunks[ci])
+  {
+   std::unique_ptr<Chunk> c(new Chunk());
+
+   MThreading::Mutex_Unlock(CacheMutex);
+   DecodeChunk(s, ci, c.get());
+   MThreading::Mutex_Lock(CacheMutex);
+
+   InsertChunk(s, ci, std::move(c));
+  }
+
+  if(DemandSource == s && DemandChunk == ci)
+   DemandSource = NULL;
+
+  if(AheadCount && AheadSource == s && AheadChunk == ci)
+  {
+   AheadChunk++;
+   AheadCount--;
+  }
+
+  MThreading::Cond_Signal(DoneCond);
+ }
+
+ MThreading::Mutex_Unlock(CacheMutex);
+
+ return 1;
+}
+
+uint64 CDAFCache::Read(CDAFReader* ar, uint64 frame_offset, int16* buffer, uint64 frames)
+{
+ Source* s = NULL;
+ std::string error;
+ uint64 ret = 0;
+
+ for(auto& so : Sources)
+ {
+  if(so.ar == ar)
+  {
+   s = &so;
+   break;
+  }
+ }
+
+ assert(s);
+
+ MThreading::Mutex_Lock(CacheMutex);
+
+ while(ret < frames)
+ {
+  const uint64 pos = frame_offset + ret;
+  const uint64 ci = pos / ChunkFrames;
+
+  if(ci >= s->chunks.size())
+   break;
+
+  while(!s->chunks[ci])
+  {
+   DemandSource = s;
+   DemandChunk = ci;
+   MThreading::Cond_Signal(WorkCond);
+   MThreading::Cond_Wait(DoneCond, CacheMutex);
+  }
+
+  Chunk* c = s->chunks[ci].get();
+
+  if(c->error.size())
+  {
+   // Don't keep the error cached, so the chunk will be decoded again on the next read from it.
+   error = c->error;
+   s->chunks[ci].reset();
+   ChunkCount--;
+   break;
+  }
+
+  const uint32 offs = pos - ci * ChunkFrames;
+
+  if(offs >= c->frames)
+   break;
+
+  const uint32 count = std::min<uint64>(frames - ret, c->frames - offs);
+
+  c->last_use = ++UseCounter;
+  memcpy(buffer + ret * 2, &c->data[offs * 2], count * 2 * sizeof(int16));
+  ret += count;
+ }
+
+ //
+ // Keep decoding ahead of the read position.
+ //
+ if(ret)
+ {
+  const uint32 next_ci = ((frame_offset + ret - 1) / ChunkFrames) + 1;
+
+  if(next_ci < s->chunks.size() && !s->chunks[next_ci] && (!AheadCount || AheadSource != s || next_ci < AheadChunk || next_ci >= (AheadChunk + AheadCount)))
+  {
+   AheadSource = s;
+   AheadChunk = next_ci;
+   AheadCount = DecodeAheadChunks;
+   MThreading::Cond_Signal(WorkCond);
+  }
+ }
+
+ MThreading::Mutex_Unlock(CacheMutex);
+
+ if(error.size())
+  throw MDFN_Error(0, "%s", error.c_str());
+
+ return ret;
+}
+
+}
@@ -0,0 +1,100 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAFCache.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_CDAFCACHE_H
+#define __MDFN_CDAFCACHE_H
+
+#include "CDAFReader.h"
+#include <mednafen/MThreading.h>
+
+namespace Mednafen
+{
+
+//
+// Decodes compressed audio tracks(Vorbis, Musepack, FLAC) on a background thread into a bounded cache of decoded
+// audio, in chunks of 75 sectors, so that reads from chunks that have already been decoded(e.g. when an audio track
+// loops) don't involve seeking or running the decoder.  A read from a chunk that isn't cached waits for the thread to
+// decode it, after which the thread decodes the following few chunks ahead of time.
+//
+// The CDAFReader objects aren't owned by the CDAFCache object, but must remain valid, and must not otherwise be read
+// from, until it's destroyed.
+//
+class CDAFCache
+{
+ public:
+
+ CDAFCache(const std::vector<CDAFReader*>& readers) MDFN_COLD;
+ ~CDAFCache() MDFN_COLD;
+
+ // Same semantics as CDAFReader::Read(); "ar" must be one of the readers passed to the constructor.
+ uint64 Read(CDAFReader* ar, uint64 frame_offset, int16* buffer, uint64 frames);
+
+ // FIXME: Semi-private:
+ int DecodeThreadStart(void);
+
+ private:
+
+ enum : uint32 { ChunkFrames = 588 * 75 };
+ enum : uint32 { MaxChunks = 384 };		// ~64MiB
+ enum : uint32 { DecodeAheadChunks = 8 };
+
+ struct Chunk
+ {
+  std::unique_ptr<int16[]> data;
+  uint32 frames;
+  uint64 last_use;
+  std::string error;
+ };
+
+ struct Source
+ {
+  CDAFReader* ar;
+  uint64 frame_count;
+  std::vector<std::unique_ptr<Chunk>> chunks;
+ };
+
+ void DecodeChunk(Source* s, const uint32 ci, Chunk* c);
+ void InsertChunk(Source* s, const uint32 ci, std::unique_ptr<Chunk> c);
+
+ std::vector<Source> Sources;
+
+ MThreading::Thread* DecodeThread;
+ MThreading::Mutex* CacheMutex;
+ MThreading::Cond* WorkCond;		// Signalled for the decode thread.
+ MThreading::Cond* DoneCond;		// Signalled when a chunk has been decoded.
+
+ //
+ // Protected by CacheMutex:
+ //
+ bool Running;
+ uint32 ChunkCount;
+ uint64 UseCounter;
+
+ Source* DemandSource;	// Chunk waited on by Read(); NULL if none.
+ uint32 DemandChunk;
+
+ Source* AheadSource;	// Chunks to decode ahead of time.
+ uint32 AheadChunk;
+ uint32 AheadCount;
+};
+
+}
+#endif
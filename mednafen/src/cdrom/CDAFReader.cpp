@@ -49,6 +49,11 @@ CDAFReader::~CDAFReader()
 
 }
 
+bool CDAFReader::IsCompressed(void)
+{
+ return false;
+}
+
 CDAFReader* CDAFR_Open(Stream* fp)
 {
  static CDAFReader* (* const OpenFuncs[])(Stream* fp) =
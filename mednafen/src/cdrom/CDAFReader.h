@@ -34,6 +34,9 @@ class CDAFReader
  virtual ~CDAFReader();
 
  virtual uint64 FrameCount(void) = 0;
+
+ // Returns true if reading involves decoding compressed audio(and so the decoded audio is worth caching).
+ virtual bool IsCompressed(void);
  INLINE uint64 Read(uint64 frame_offset, int16 *buffer, uint64 frames)
  {
   uint64 ret;
@@ -50,6 +50,7 @@ class CDAFReader_FLAC final : public CDAFReader
  uint64 Read_(int16 *buffer, uint64 frames) override;
  bool Seek_(uint64 frame_offset) override;
  uint64 FrameCount(void) override;
+ bool IsCompressed(void) override;
 
  FLAC__StreamDecoderReadStatus read_cb(FLAC__byte* data, size_t* count);
  FLAC__StreamDecoderSeekStatus seek_cb(FLAC__uint64 offset);
@@ -370,6 +371,11 @@ uint64 CDAFReader_FLAC::FrameCount(void)
  return num_frames;
 }
 
+bool CDAFReader_FLAC::IsCompressed(void)
+{
+ return true;
+}
+
 CDAFReader* CDAFR_FLAC_Open(Stream* fp)
 {
  return new CDAFReader_FLAC(fp);
@@ -42,6 +42,7 @@ class CDAFReader_MPC final : public CDAFReader
  uint64 Read_(int16 *buffer, uint64 frames) override;
  bool Seek_(uint64 frame_offset) override;
  uint64 FrameCount(void) override;
+ bool IsCompressed(void) override;
 
  private:
  mpc_reader reader;
@@ -232,6 +233,11 @@ uint64 CDAFReader_MPC::FrameCount(void)
  return mpc_streaminfo_get_length_samples(&si);
 }
 
+bool CDAFReader_MPC::IsCompressed(void)
+{
+ return true;
+}
+
 
 CDAFReader* CDAFR_MPC_Open(Stream* fp)
 {
@@ -41,6 +41,7 @@ class CDAFReader_Vorbis final : public CDAFReader
  uint64 Read_(int16 *buffer, uint64 frames) override;
  bool Seek_(uint64 frame_offset) override;
  uint64 FrameCount(void) override;
+ bool IsCompressed(void) override;
 
  private:
  OggVorbis_File ovfile;
@@ -166,6 +167,11 @@ uint64 CDAFReader_Vorbis::FrameCount(void)
  return(ov_pcm_total(&ovfile, -1));
 }
 
+bool CDAFReader_Vorbis::IsCompressed(void)
+{
+ return true;
+}
+
 CDAFReader* CDAFR_Vorbis_Open(Stream* fp)
 {
  return new CDAFReader_Vorbis(fp);
@@ -20,9 +20,11 @@
 */
 
 #include <mednafen/mednafen.h>
+#include <mednafen/MemoryStream.h>
 #include "CDAccess.h"
 #include "CDAccess_Image.h"
 #include "CDAccess_CCD.h"
+#include "CDAccess_CHD.h"
 
 namespace Mednafen
 {
@@ -39,12 +41,36 @@ CDAccess::~CDAccess()
 
 }
 
+bool CDAccess::Read_Raw_Sector_Cooked(uint8 *buf, int32 lba)
+{
+ Read_Raw_Sector(buf, lba);
+
+ return false;
+}
+
+Stream* CDAccess::OpenImageFile(VirtualFS* vfs, const std::string& path, bool image_memcache)
+{
+ std::unique_ptr<Stream> ret(vfs->open(path, VirtualFS::MODE_READ));
+
+ if(image_memcache)
+ {
+  if(!ret->map())
+   ret.reset(new MemoryStream(ret.release()));
+ }
+ else
+  ret->require_fast_seekable();
+
+ return ret.release();
+}
+
 CDAccess* CDAccess_Open(VirtualFS* vfs, const std::string& path, bool image_memcache)
 {
  CDAccess *ret = NULL;
 
  if(vfs->test_ext(path, ".ccd"))
   ret = new CDAccess_CCD(vfs, path, image_memcache);
+ else if(vfs->test_ext(path, ".chd"))
+  ret = new CDAccess_CHD(vfs, path, image_memcache);
  else
   ret = new CDAccess_Image(vfs, path, image_memcache);
 
@@ -36,6 +36,13 @@ class CDAccess
 
  virtual void Read_Raw_Sector(uint8 *buf, int32 lba) = 0;
 
+ // Like Read_Raw_Sector(), but a mode 1 sector that the image stores as only its 2048 bytes of user data may be returned
+ // with its EDC and L-EC fields left zeroed(see encode_mode1_sector_noecc()), in which case 'true' is returned.  The
+ // user data of such a sector didn't come from a raw read, so there's nothing to check or correct.
+ //
+ // The default implementation calls Read_Raw_Sector() and returns false.
+ virtual bool Read_Raw_Sector_Cooked(uint8 *buf, int32 lba);
+
  // Returns false if the read wouldn't be "fast"(i.e. reading from a disk),
  // or if the read can't be done in a thread-safe re-entrant manner.
  //
@@ -44,6 +51,16 @@ class CDAccess
 
  virtual void Read_TOC(CDUtility::TOC *toc) = 0;
 
+ protected:
+
+ // Opens an image file that's read from by sector, for an implementation's use.
+ //
+ // If "image_memcache" is true, the VirtualFS object need not remain valid afterwards, and the returned stream's map() will
+ // return the file's data(unless the file is empty): the file is mmap()'d read-only when possible, so that loading is
+ // nearly instant and the data lives in(and is shared via) the OS page cache, and is otherwise read entirely into a
+ // MemoryStream.
+ static Stream* OpenImageFile(VirtualFS* vfs, const std::string& path, bool image_memcache);
+
  private:
  CDAccess(const CDAccess&);	// No copy constructor.
  CDAccess& operator=(const CDAccess&); // No assignment operator.
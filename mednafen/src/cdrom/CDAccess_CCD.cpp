@@ -22,7 +22,6 @@
 #include <mednafen/mednafen.h>
 #include <mednafen/general.h>
 #include <mednafen/string/string.h>
-#include <mednafen/MemoryStream.h>
 
 #include "CDAccess_CCD.h"
 #include <trio/trio.h>
@@ -82,7 +81,7 @@ static T CCD_ReadInt(CCD_Section &s, const std::string &propname, const bool hav
 }
 
 
-CDAccess_CCD::CDAccess_CCD(VirtualFS* vfs, const std::string& path, bool image_memcache) : img_numsectors(0)
+CDAccess_CCD::CDAccess_CCD(VirtualFS* vfs, const std::string& path, bool image_memcache) : img_map(nullptr), img_numsectors(0)
 {
  Load(vfs, path, image_memcache);
 }
@@ -245,18 +244,16 @@ void CDAccess_CCD::Load(VirtualFS* vfs, const std::string& path, bool image_memc
  {
   std::string image_path = vfs->eval_fip(dir_path, file_base + "." + img_extsd, true);
 
+  img_stream.reset(OpenImageFile(vfs, image_path, image_memcache));
+
+  uint64 ss = img_stream->size();
+
   if(image_memcache)
   {
-   img_stream.reset(new MemoryStream(vfs->open(image_path, VirtualFS::MODE_READ)));
-  }
-  else
-  {
-   img_stream.reset(vfs->open(image_path, VirtualFS::MODE_READ));
-   img_stream->require_fast_seekable();
+   img_map = img_stream->map();
+   ss = img_stream->map_size();
   }
 
-  uint64 ss = img_stream->size();
-
   if(ss % 2352)
    throw MDFN_Error(0, _("CCD image size is not evenly divisible by 2352."));
 
@@ -395,8 +392,13 @@ void CDAccess_CCD::Read_Raw_Sector(uint8 *buf, int32 lba)
   return;
  }
 
- img_stream->seek(lba * 2352, SEEK_SET);
- img_stream->read(buf, 2352);
+ if(img_map)
+  memcpy(buf, img_map + (size_t)lba * 2352, 2352);
+ else
+ {
+  img_stream->seek(lba * 2352, SEEK_SET);
+  img_stream->read(buf, 2352);
+ }
 
  subpw_interleave(&sub_data[lba * 96], buf + 2352);
 }
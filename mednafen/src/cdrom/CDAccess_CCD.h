@@ -45,6 +45,7 @@ class CDAccess_CCD : public CDAccess
  void CheckSubQSanity(void);
 
  std::unique_ptr<Stream> img_stream;
+ const uint8* img_map;	// img_stream's map()'d data, with cd.image_memcache.
  std::unique_ptr<uint8[]> sub_data;
 
  size_t img_numsectors;
@@ -0,0 +1,1609 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAccess_CHD.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/*
+ Notes and TODO:
+
+	Only CHD version 5 is supported; "chdman copy" will convert older versions.
+
+	CD-ROM codecs supported: "cdzl"(zlib), "cdzs"(zstd), "cdlz"(LZMA), and "cdfl"(FLAC, when built with libFLAC).
+
+	Multisession and GD-ROM("CHGD" metadata) images aren't supported.
+*/
+
+#include <mednafen/mednafen.h>
+#include <mednafen/general.h>
+#include <mednafen/string/string.h>
+#include <mednafen/MemoryStream.h>
+
+#include "CDAccess_CHD.h"
+#include <trio/trio.h>
+
+#ifdef HAVE_LIBFLAC
+#ifdef __MINGW32__
+# ifdef PCEDEVEL_FLAC_DLL
+   // MinGW-w64 does not define _MSC_VER, but libFLAC < 1.3.4 requires _MSC_VER
+   // to properly declare DLL imports/exports.
+#  define _MSC_VER 1933
+#  include <FLAC/all.h>
+#  undef _MSC_VER
+# else
+#  define FLAC__NO_DLL
+#  include <FLAC/all.h>
+# endif
+#else
+# include <FLAC/all.h>
+#endif
+#endif
+
+namespace Mednafen
+{
+
+using namespace CDUtility;
+
+static constexpr uint32 CHD_Tag(const char (&s)[5])
+{
+ return ((uint32)(uint8)s[0] << 24) | ((uint32)(uint8)s[1] << 16) | ((uint32)(uint8)s[2] << 8) | (uint32)(uint8)s[3];
+}
+
+enum : uint32
+{
+ CHD_CODEC_CD_ZLIB = CHD_Tag("cdzl"),
+ CHD_CODEC_CD_ZSTD = CHD_Tag("cdzs"),
+ CHD_CODEC_CD_LZMA = CHD_Tag("cdlz"),
+ CHD_CODEC_CD_FLAC = CHD_Tag("cdfl"),
+
+ CHD_META_CDROM_TRACK = CHD_Tag("CHTR"),
+ CHD_META_CDROM_TRACK2 = CHD_Tag("CHT2"),
+ CHD_META_CDROM_OLD = CHD_Tag("CHCD"),
+ CHD_META_GDROM_TRACK = CHD_Tag("CHGD")
+};
+
+// Hunk map entry types
+enum : uint8
+{
+ CHD_MAP_CODEC_0 = 0,	// Through CHD_MAP_CODEC_0 + 3, compressed with compressors[type]
+ CHD_MAP_NONE = 4,
+ CHD_MAP_SELF = 5,
+ CHD_MAP_PARENT = 6,
+ // Pseudo-types only used in the compressed map
+ CHD_MAP_RLE_SMALL = 7,
+ CHD_MAP_RLE_LARGE = 8,
+ CHD_MAP_SELF_0 = 9,
+ CHD_MAP_SELF_1 = 10,
+ CHD_MAP_PARENT_SELF = 11,
+ CHD_MAP_PARENT_0 = 12,
+ CHD_MAP_PARENT_1 = 13,
+ // Entry of an uncompressed map; offset of 0 means the hunk is all zeroes
+ CHD_MAP_RAW = 0xFF
+};
+
+enum
+{
+ CHD_FRAME_SIZE = 2448,
+ CHD_SECTOR_DATA_SIZE = 2352,
+ CHD_SUBCODE_SIZE = 96,
+ CHD_TRACK_PADDING = 4	// Frame count of each track is padded to a multiple of this in the image.
+};
+
+// Track sector formats
+enum
+{
+ CHD_FORMAT_AUDIO = 0,
+ CHD_FORMAT_MODE1,
+ CHD_FORMAT_MODE1_RAW,
+ CHD_FORMAT_MODE2,
+ CHD_FORMAT_MODE2_FORM1,
+ CHD_FORMAT_MODE2_FORM2,
+ CHD_FORMAT_MODE2_FORM_MIX,
+ CHD_FORMAT_MODE2_RAW,
+ _CHD_FORMAT_COUNT
+};
+
+static const char* const CHD_FormatStrings[_CHD_FORMAT_COUNT] =
+{
+ "AUDIO",
+ "MODE1",
+ "MODE1_RAW",
+ "MODE2",
+ "MODE2_FORM1",
+ "MODE2_FORM2",
+ "MODE2_FORM_MIX",
+ "MODE2_RAW"
+};
+
+//
+// MSB-first bit reader for the compressed hunk map; reads past the end return zero bits.
+//
+class CHD_BitReader
+{
+ public:
+
+ CHD_BitReader(const uint8* d, const size_t l) : data(d), len_bits((uint64)l * 8), pos(0) { }
+
+ INLINE uint32 Peek(const unsigned count) const
+ {
+  uint32 ret = 0;
+
+  for(unsigned i = 0; i < count; i++)
+  {
+   const uint64 bp = pos + i;
+
+   ret <<= 1;
+
+   if(bp < len_bits)
+    ret |= (data[bp >> 3] >> (7 - (bp & 7))) & 1;
+  }
+
+  return ret;
+ }
+
+ INLINE void Skip(const unsigned count) { pos += count; }
+
+ INLINE uint32 Read(const unsigned count)
+ {
+  const uint32 ret = Peek(count);
+
+  Skip(count);
+
+  return ret;
+ }
+
+ INLINE bool Overflow(void) const { return pos > len_bits; }
+
+ private:
+ const uint8* data;
+ const uint64 len_bits;
+ uint64 pos;
+};
+
+//
+// Canonical Huffman decoder for the 16 hunk map entry types, with codes up to 8 bits long.
+//
+class CHD_MapHuffman
+{
+ public:
+
+ enum { NumCodes = 16, MaxBits = 8 };
+
+ void ImportTreeRLE(CHD_BitReader* br)
+ {
+  uint8 numbits[NumCodes];
+  unsigned cur = 0;
+
+  while(cur < NumCodes)
+  {
+   unsigned nb = br->Read(4);
+
+   if(nb != 1)
+    numbits[cur++] = nb;
+   else
+   {
+    nb = br->Read(4);
+
+    if(nb == 1)
+     numbits[cur++] = nb;
+    else
+    {
+     unsigned repcount = br->Read(4) + 3;
+
+     if(repcount > (NumCodes - cur))
+      throw MDFN_Error(0, _("CHD hunk map Huffman tree is corrupt."));
+
+     while(repcount--)
+      numbits[cur++] = nb;
+    }
+   }
+  }
+  //
+  // Assign canonical codes, longest first.
+  //
+  uint32 bithisto[33] = { 0 };
+
+  for(unsigned i = 0; i < NumCodes; i++)
+  {
+   if(numbits[i] > MaxBits)
+    throw MDFN_Error(0, _("CHD hunk map Huffman tree is corrupt."));
+
+   bithisto[numbits[i]]++;
+  }
+
+  uint32 curstart = 0;
+
+  for(unsigned codelen = 32; codelen > 0; codelen--)
+  {
+   const uint32 nextstart = (curstart + bithisto[codelen]) >> 1;
+
+   if(codelen != 1 && nextstart * 2 != (curstart + bithisto[codelen]))
+    throw MDFN_Error(0, _("CHD hunk map Huffman tree is corrupt."));
+
+   bithisto[codelen] = curstart;
+   curstart = nextstart;
+  }
+
+  memset(lookup, 0, sizeof(lookup));
+
+  for(unsigned i = 0; i < NumCodes; i++)
+  {
+   if(numbits[i])
+   {
+    const uint32 code = bithisto[numbits[i]]++;
+    const unsigned shift = MaxBits - numbits[i];
+
+    for(uint32 j = code << shift; j < ((code + 1) << shift); j++)
+     lookup[j] = (i << 4) | numbits[i];
+   }
+  }
+ }
+
+ INLINE uint8 Decode(CHD_BitReader* br) const
+ {
+  const uint8 l = lookup[br->Peek(MaxBits)];
+
+  br->Skip(l & 0xF);
+
+  return l >> 4;
+ }
+
+ private:
+ uint8 lookup[1U << MaxBits];	// Code in upper 4 bits, code length in lower 4 bits.
+};
+
+//
+// Decoder for raw LZMA(LZMA1) streams as written by "cdlz": lc=3, lp=0, pb=2, no end marker, and a dictionary no
+// smaller than the hunk, so the output buffer is the dictionary.
+//
+class CHD_LZMADecoder
+{
+ public:
+
+ CHD_LZMADecoder()
+ {
+  InitProbs(IsMatch);
+  InitProbs(IsRep);
+  InitProbs(IsRepG0);
+  InitProbs(IsRepG1);
+  InitProbs(IsRepG2);
+  InitProbs(IsRep0Long);
+  InitProbs(PosSlot);
+  InitProbs(PosSpecial);
+  InitProbs(Align);
+  InitProbs(LenChoice);
+  InitProbs(LenLow);
+  InitProbs(LenMid);
+  InitProbs(LenHigh);
+  InitProbs(RepLenChoice);
+  InitProbs(RepLenLow);
+  InitProbs(RepLenMid);
+  InitProbs(RepLenHigh);
+  InitProbs(Literal);
+ }
+
+ void Decode(const uint8* src, const uint32 src_len, uint8* dest, const uint32 dest_len)
+ {
+  in = src;
+  in_end = src + src_len;
+  in_overrun = false;
+
+  if(NextByte() != 0x00)
+   throw MDFN_Error(0, _("LZMA data is corrupt."));
+
+  range = 0xFFFFFFFF;
+  code = 0;
+  for(unsigned i = 0; i < 4; i++)
+   code = (code << 8) | NextByte();
+
+  if(code == range)
+   throw MDFN_Error(0, _("LZMA data is corrupt."));
+  //
+  //
+  uint32 rep0 = 0, rep1 = 0, rep2 = 0, rep3 = 0;
+  unsigned state = 0;
+  uint32 pos = 0;
+
+  while(pos < dest_len)
+  {
+   const unsigned pos_state = pos & ((1U << pb) - 1);
+
+   if(!Bit(&IsMatch[(state << 4) + pos_state]))
+   {
+    uint16* const probs = &Literal[0x300 * ((pos ? dest[pos - 1] : 0) >> (8 - lc))];
+    unsigned symbol = 1;
+
+    if(state >= 7)
+    {
+     unsigned match_byte = dest[pos - rep0 - 1];
+
+     do
+     {
+      const unsigned match_bit = (match_byte >> 7) & 1;
+      const unsigned bit = Bit(&probs[((1 + match_bit) << 8) + symbol]);
+
+      match_byte <<= 1;
+      symbol = (symbol << 1) | bit;
+
+      if(match_bit != bit)
+       break;
+     } while(symbol < 0x100);
+    }
+
+    while(symbol < 0x100)
+     symbol = (symbol << 1) | Bit(&probs[symbol]);
+
+    dest[pos++] = symbol;
+    state = (state < 4) ? 0 : ((state < 10) ? (state - 3) : (state - 6));
+    continue;
+   }
+
+   uint32 len;
+
+   if(Bit(&IsRep[state]))
+   {
+    if(!pos)
+     throw MDFN_Error(0, _("LZMA data is corrupt."));
+
+    if(!Bit(&IsRepG0[state]))
+    {
+     if(!Bit(&IsRep0Long[(state << 4) + pos_state]))
+     {
+      state = (state < 7) ? 9 : 11;
+      dest[pos] = dest[pos - rep0 - 1];
+      pos++;
+      continue;
+     }
+    }
+    else
+    {
+     uint32 dist;
+
+     if(!Bit(&IsRepG1[state]))
+      dist = rep1;
+     else
+     {
+      if(!Bit(&IsRepG2[state]))
+       dist = rep2;
+      else
+      {
+       dist = rep3;
+       rep3 = rep2;
+      }
+      rep2 = rep1;
+     }
+     rep1 = rep0;
+     rep0 = dist;
+    }
+    len = DecodeLen(RepLenChoice, RepLenLow, RepLenMid, RepLenHigh, pos_state);
+    state = (state < 7) ? 8 : 11;
+   }
+   else
+   {
+    rep3 = rep2;
+    rep2 = rep1;
+    rep1 = rep0;
+    len = DecodeLen(LenChoice, LenLow, LenMid, LenHigh, pos_state);
+    state = (state < 7) ? 7 : 10;
+    rep0 = DecodeDistance(len);
+
+    if(rep0 == 0xFFFFFFFF)	// End marker
+     break;
+   }
+
+   len += 2;
+
+   if(rep0 >= pos || len > (dest_len - pos))
+    throw MDFN_Error(0, _("LZMA data is corrupt."));
+
+   for(uint32 i = 0; i < len; i++, pos++)
+    dest[pos] = dest[pos - rep0 - 1];
+  }
+
+  if(pos != dest_len || in_overrun)
+   throw MDFN_Error(0, _("LZMA data is corrupt."));
+ }
+
+ private:
+
+ enum { lc = 3, lp = 0, pb = 2 };
+
+ template<size_t N>
+ static void InitProbs(uint16 (&p)[N])
+ {
+  for(auto& v : p)
+   v = 1024;
+ }
+
+ template<size_t N, size_t M>
+ static void InitProbs(uint16 (&p)[N][M])
+ {
+  for(auto& v : p)
+   InitProbs(v);
+ }
+
+ INLINE uint8 NextByte(void)
+ {
+  if(MDFN_UNLIKELY(in == in_end))
+  {
+   in_overrun = true;
+   return 0;
+  }
+
+  return *in++;
+ }
+
+ INLINE void Normalize(void)
+ {
+  if(range < (1U << 24))
+  {
+   range <<= 8;
+   code = (code << 8) | NextByte();
+  }
+ }
+
+ INLINE unsigned Bit(uint16* prob)
+ {
+  const uint32 bound = (range >> 11) * *prob;
+  unsigned ret;
+
+  if(code < bound)
+  {
+   *prob += ((1U << 11) - *prob) >> 5;
+   range = bound;
+   ret = 0;
+  }
+  else
+  {
+   *prob -= *prob >> 5;
+   code -= bound;
+   range -= bound;
+   ret = 1;
+  }
+  Normalize();
+
+  return ret;
+ }
+
+ INLINE uint32 DirectBits(unsigned count)
+ {
+  uint32 ret = 0;
+
+  do
+  {
+   range >>= 1;
+   code -= range;
+   const uint32 t = 0 - (code >> 31);
+   code += range & t;
+   ret = (ret << 1) + (t + 1);
+   Normalize();
+  } while(--count);
+
+  return ret;
+ }
+
+ INLINE uint32 BitTree(uint16* probs, const unsigned count)
+ {
+  uint32 m = 1;
+
+  for(unsigned i = 0; i < count; i++)
+   m = (m << 1) + Bit(&probs[m]);
+
+  return m - (1U << count);
+ }
+
+ INLINE uint32 BitTreeReverse(uint16* probs, const unsigned count)
+ {
+  uint32 m = 1;
+  uint32 ret = 0;
+
+  for(unsigned i = 0; i < count; i++)
+  {
+   const unsigned bit = Bit(&probs[m]);
+
+   m = (m << 1) + bit;
+   ret |= bit << i;
+  }
+
+  return ret;
+ }
+
+ INLINE uint32 DecodeLen(uint16* choice, uint16 (*low)[8], uint16 (*mid)[8], uint16* high, const unsigned pos_state)
+ {
+  if(!Bit(&choice[0]))
+   return BitTree(low[pos_state], 3);
+
+  if(!Bit(&choice[1]))
+   return 8 + BitTree(mid[pos_state], 3);
+
+  return 16 + BitTree(high, 8);
+ }
+
+ INLINE uint32 DecodeDistance(const uint32 len)
+ {
+  const unsigned pos_slot = BitTree(PosSlot[std::min<uint32>(len, 3)], 6);
+
+  if(pos_slot < 4)
+   return pos_slot;
+
+  const unsigned num_direct_bits = (pos_slot >> 1) - 1;
+  uint32 dist = (2 | (pos_slot & 1)) << num_direct_bits;
+
+  if(pos_slot < 14)
+   dist += BitTreeReverse(&PosSpecial[dist - pos_slot], num_direct_bits);
+  else
+  {
+   dist += DirectBits(num_direct_bits - 4) << 4;
+   dist += BitTreeReverse(Align, 4);
+  }
+
+  return dist;
+ }
+
+ const uint8* in;
+ const uint8* in_end;
+ bool in_overrun;
+ uint32 range;
+ uint32 code;
+
+ // Probabilities
+ uint16 IsMatch[12 << 4];
+ uint16 IsRep[12];
+ uint16 IsRepG0[12];
+ uint16 IsRepG1[12];
+ uint16 IsRepG2[12];
+ uint16 IsRep0Long[12 << 4];
+ uint16 PosSlot[4][1 << 6];
+ uint16 PosSpecial[1 + 114];
+ uint16 Align[1 << 4];
+ uint16 LenChoice[2];
+ uint16 LenLow[1 << pb][8];
+ uint16 LenMid[1 << pb][8];
+ uint16 LenHigh[256];
+ uint16 RepLenChoice[2];
+ uint16 RepLenLow[1 << pb][8];
+ uint16 RepLenMid[1 << pb][8];
+ uint16 RepLenHigh[256];
+ uint16 Literal[0x300 << (lc + lp)];
+};
+
+#ifdef HAVE_LIBFLAC
+//
+// "cdfl" stores the audio as a headerless FLAC stream(stereo, 16-bit, 44100Hz), so decode it with a synthesized
+// STREAMINFO block in front, as MAME does.
+//
+struct CHD_FLACDecoder
+{
+ uint8 header[0x2A];
+ const uint8* src;
+ uint32 src_len;
+ uint32 read_pos;	// Position in header + src
+
+ uint8* dest;		// Big-endian samples
+ uint32 dest_frames;
+ uint32 dest_pos;
+};
+
+static FLAC__StreamDecoderReadStatus CHD_FLAC_read_cb(const FLAC__StreamDecoder* dec, FLAC__byte* data, size_t* count, void* pdata)
+{
+ CHD_FLACDecoder* fd = (CHD_FLACDecoder*)pdata;
+ size_t did_read = 0;
+
+ while(did_read < *count && fd->read_pos < sizeof(fd->header) + fd->src_len)
+ {
+  if(fd->read_pos < sizeof(fd->header))
+  {
+   const size_t n = std::min<size_t>(*count - did_read, sizeof(fd->header) - fd->read_pos);
+
+   memcpy(data + did_read, fd->header + fd->read_pos, n);
+   did_read += n;
+   fd->read_pos += n;
+  }
+  else
+  {
+   const size_t n = std::min<size_t>(*count - did_read, sizeof(fd->header) + fd->src_len - fd->read_pos);
+
+   memcpy(data + did_read, fd->src + (fd->read_pos - sizeof(fd->header)), n);
+   did_read += n;
+   fd->read_pos += n;
+  }
+ }
+
+ *count = did_read;
+
+ if(!did_read)
+  return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+
+ return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderTellStatus CHD_FLAC_tell_cb(const FLAC__StreamDecoder* dec, FLAC__uint64* offset, void* pdata)
+{
+ *offset = ((CHD_FLACDecoder*)pdata)->read_pos;
+
+ return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+static FLAC__StreamDecoderWriteStatus CHD_FLAC_write_cb(const FLAC__StreamDecoder* dec, const FLAC__Frame* frame, const FLAC__int32* const* buf, void* pdata)
+{
+ CHD_FLACDecoder* fd = (CHD_FLACDecoder*)pdata;
+
+ if(frame->header.channels != 2 || frame->header.bits_per_sample != 16)
+  return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+ for(uint32 i = 0; i < frame->header.blocksize && fd->dest_pos < fd->dest_frames; i++, fd->dest_pos++)
+ {
+  MDFN_en16msb(fd->dest + fd->dest_pos * 4 + 0, buf[0][i]);
+  MDFN_en16msb(fd->dest + fd->dest_pos * 4 + 2, buf[1][i]);
+ }
+
+ return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+}
+
+static void CHD_FLAC_metadata_cb(const FLAC__StreamDecoder* dec, const FLAC__StreamMetadata* meta, void* pdata)
+{
+
+}
+
+static void CHD_FLAC_error_cb(const FLAC__StreamDecoder* dec, FLAC__StreamDecoderErrorStatus status, void* pdata)
+{
+
+}
+
+// Returns the number of bytes of 'src' consumed.
+static uint32 CHD_FLAC_Decode(const uint8* src, const uint32 src_len, uint8* dest, const uint32 dest_frames, const uint32 block_size)
+{
+ static const uint8 header_template[0x2A] =
+ {
+  'f', 'L', 'a', 'C',
+  0x80, 0x00, 0x00, 0x22,			// STREAMINFO, last metadata block, 0x22 bytes
+  0x00, 0x00, 0x00, 0x00,			// Minimum and maximum block size
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,		// Minimum and maximum frame size(unknown)
+  0x0A, 0xC4, 0x42, 0xF0, 0x00, 0x00, 0x00, 0x00,	// 44100Hz, 2 channels, 16 bits per sample, unknown sample count
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00	// MD5
+ };
+ CHD_FLACDecoder fd;
+ FLAC__StreamDecoder* dec;
+ FLAC__uint64 decode_pos = 0;
+
+ memcpy(fd.header, header_template, sizeof(fd.header));
+ MDFN_en16msb(&fd.header[0x08], block_size);
+ MDFN_en16msb(&fd.header[0x0A], block_size);
+ fd.src = src;
+ fd.src_len = src_len;
+ fd.read_pos = 0;
+ fd.dest = dest;
+ fd.dest_frames = dest_frames;
+ fd.dest_pos = 0;
+
+ if(!(dec = FLAC__stream_decoder_new()))
+  throw MDFN_Error(0, _("Error creating FLAC stream decoder."));
+
+ try
+ {
+  const FLAC__StreamDecoderInitStatus init_status = FLAC__stream_decoder_init_stream(dec, CHD_FLAC_read_cb, nullptr, CHD_FLAC_tell_cb, nullptr, nullptr, CHD_FLAC_write_cb, CHD_FLAC_metadata_cb, CHD_FLAC_error_cb, &fd);
+
+  if(init_status != FLAC__STREAM_DECODER_INIT_STATUS_OK)
+   throw MDFN_Error(0, _("Error initializing FLAC stream decoder: %s"), FLAC__StreamDecoderInitStatusString[init_status]);
+
+  if(!FLAC__stream_decoder_process_until_end_of_metadata(dec))
+   throw MDFN_Error(0, _("FLAC data is corrupt."));
+
+  while(fd.dest_pos < fd.dest_frames)
+  {
+   if(!FLAC__stream_decoder_process_single(dec) || FLAC__stream_decoder_get_state(dec) == FLAC__STREAM_DECODER_END_OF_STREAM)
+    throw MDFN_Error(0, _("FLAC data is corrupt."));
+  }
+
+  if(!FLAC__stream_decoder_get_decode_position(dec, &decode_pos) || decode_pos < sizeof(fd.header) || decode_pos > sizeof(fd.header) + src_len)
+   throw MDFN_Error(0, _("FLAC data is corrupt."));
+ }
+ catch(...)
+ {
+  FLAC__stream_decoder_delete(dec);
+  throw;
+ }
+
+ FLAC__stream_decoder_delete(dec);
+
+ return decode_pos - sizeof(fd.header);
+}
+#endif
+
+CDAccess_CHD::CDAccess_CHD(VirtualFS* vfs, const std::string& path, bool image_memcache) : hunk_bytes(0), hunk_count(0), HunkCacheCounter(0), zs_inited(false), zstd_dctx(nullptr),
+											   NumTracks(0), FirstTrack(0), LastTrack(0), total_sectors(0), disc_type(DISC_TYPE_CDDA_OR_M1)
+{
+ memset(compressors, 0, sizeof(compressors));
+ memset(Tracks, 0, sizeof(Tracks));
+
+ try
+ {
+  Load(vfs, path, image_memcache);
+ }
+ catch(...)
+ {
+  Cleanup();
+  throw;
+ }
+}
+
+CDAccess_CHD::~CDAccess_CHD()
+{
+ Cleanup();
+}
+
+void CDAccess_CHD::Cleanup(void)
+{
+ if(zs_inited)
+ {
+  inflateEnd(&zs);
+  zs_inited = false;
+ }
+
+ if(zstd_dctx)
+ {
+  ZSTD_freeDCtx(zstd_dctx);
+  zstd_dctx = nullptr;
+ }
+}
+
+void CDAccess_CHD::Load(VirtualFS* vfs, const std::string& path, bool image_memcache)
+{
+ uint8 header[124];
+
+ if(image_memcache)
+  fp.reset(new MemoryStream(vfs->open(path, VirtualFS::MODE_READ)));
+ else
+ {
+  fp.reset(vfs->open(path, VirtualFS::MODE_READ));
+  fp->require_fast_seekable();
+ }
+
+ const uint64 header_read = fp->read(header, sizeof(header), false);
+
+ if(header_read < 16 || memcmp(header, "MComprHD", 8))
+  throw MDFN_Error(0, _("Not a CHD file."));
+
+ {
+  const uint32 version = MDFN_de32msb(&header[12]);
+
+  if(version != 5)
+   throw MDFN_Error(0, _("CHD version %u is not supported; only version 5 is(\"chdman copy\" can convert the image)."), version);
+ }
+
+ if(header_read != sizeof(header) || MDFN_de32msb(&header[8]) != sizeof(header))
+  throw MDFN_Error(0, _("CHD header is corrupt."));
+
+ for(unsigned i = 0; i < 4; i++)
+  compressors[i] = MDFN_de32msb(&header[16 + i * 4]);
+
+ const uint64 logical_bytes = MDFN_de64msb(&header[32]);
+ const uint64 map_offset = MDFN_de64msb(&header[40]);
+ const uint64 meta_offset = MDFN_de64msb(&header[48]);
+ const uint32 unit_bytes = MDFN_de32msb(&header[60]);
+
+ hunk_bytes = MDFN_de32msb(&header[56]);
+
+ for(unsigned i = 0; i < 20; i++)
+ {
+  if(header[104 + i])
+   throw MDFN_Error(0, _("CHD images that depend on a parent CHD are not supported."));
+ }
+
+ if(unit_bytes != CHD_FRAME_SIZE || !hunk_bytes || (hunk_bytes % CHD_FRAME_SIZE) || hunk_bytes > (16 * 1024 * 1024))
+  throw MDFN_Error(0, _("CHD image is not a CD-ROM image, or has an unsupported hunk size."));
+
+ if(((logical_bytes + hunk_bytes - 1) / hunk_bytes) > 0x7FFFFFFF / (hunk_bytes / CHD_FRAME_SIZE))
+  throw MDFN_Error(0, _("CHD image is too large."));
+
+ hunk_count = (logical_bytes + hunk_bytes - 1) / hunk_bytes;
+
+ for(unsigned i = 0; i < 4; i++)
+ {
+  switch(compressors[i])
+  {
+   case 0:
+   case CHD_CODEC_CD_ZLIB:
+   case CHD_CODEC_CD_ZSTD:
+   case CHD_CODEC_CD_LZMA:
+#ifdef HAVE_LIBFLAC
+   case CHD_CODEC_CD_FLAC:
+#endif
+	break;
+
+   default:
+	throw MDFN_Error(0, _("CHD image uses unsupported codec \"%c%c%c%c\"."), (char)(compressors[i] >> 24), (char)(compressors[i] >> 16), (char)(compressors[i] >> 8), (char)compressors[i]);
+  }
+ }
+
+ LoadMap(map_offset);
+ LoadTracks(meta_offset);
+ //
+ //
+ //
+ comp_buf.reset(new uint8[hunk_bytes]);
+ codec_buf.reset(new uint8[hunk_bytes]);
+
+ for(auto& hce : HunkCache)
+ {
+  hce.hunknum = ~(uint32)0;
+  hce.last_use = 0;
+  hce.data.reset(new uint8[hunk_bytes]);
+ }
+
+ memset(&zs, 0, sizeof(zs));
+ if(inflateInit2(&zs, -15) != Z_OK)
+  throw MDFN_Error(0, _("zlib inflateInit2() failed."));
+ zs_inited = true;
+
+ if(!(zstd_dctx = ZSTD_createDCtx()))
+  throw MDFN_Error(0, _("%s failed."), "ZSTD_createDCtx()");
+
+ GenerateTOC();
+}
+
+void CDAccess_CHD::LoadMap(const uint64 map_offset)
+{
+ hunk_map.reset(new MapEntry[hunk_count]);
+
+ if(!compressors[0])
+ {
+  std::unique_ptr<uint8[]> raw_map(new uint8[(size_t)hunk_count * 4]);
+
+  fp->seek(map_offset, SEEK_SET);
+  fp->read(raw_map.get(), (size_t)hunk_count * 4);
+
+  for(uint32 hunknum = 0; hunknum < hunk_count; hunknum++)
+  {
+   MapEntry* me = &hunk_map[hunknum];
+
+   me->type = CHD_MAP_RAW;
+   me->offset = (uint64)MDFN_de32msb(&raw_map[hunknum * 4]) * hunk_bytes;
+   me->length = hunk_bytes;
+   me->crc = 0;
+  }
+
+  return;
+ }
+ //
+ //
+ //
+ uint8 map_header[16];
+
+ fp->seek(map_offset, SEEK_SET);
+ fp->read(map_header, sizeof(map_header));
+
+ const uint32 map_bytes = MDFN_de32msb(&map_header[0]);
+ const uint64 first_offset = MDFN_de64msb(&map_header[4]) >> 16;
+ const uint16 map_crc = MDFN_de16msb(&map_header[10]);
+ const unsigned length_bits = map_header[12];
+ const unsigned self_bits = map_header[13];
+ const unsigned parent_bits = map_header[14];
+
+ if(map_bytes > fp->size() || length_bits > 32 || self_bits > 32 || parent_bits > 32)
+  throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+ std::unique_ptr<uint8[]> comp_map(new uint8[map_bytes]);
+ fp->read(comp_map.get(), map_bytes);
+
+ CHD_BitReader br(comp_map.get(), map_bytes);
+ CHD_MapHuffman huff;
+
+ huff.ImportTreeRLE(&br);
+ //
+ // Entry types, run-length encoded.
+ //
+ {
+  uint8 last_type = 0;
+  uint32 repcount = 0;
+
+  for(uint32 hunknum = 0; hunknum < hunk_count; hunknum++)
+  {
+   MapEntry* me = &hunk_map[hunknum];
+
+   if(repcount)
+   {
+    me->type = last_type;
+    repcount--;
+   }
+   else
+   {
+    const uint8 v = huff.Decode(&br);
+
+    if(v == CHD_MAP_RLE_SMALL)
+    {
+     me->type = last_type;
+     repcount = 2 + huff.Decode(&br);
+    }
+    else if(v == CHD_MAP_RLE_LARGE)
+    {
+     me->type = last_type;
+     repcount = 2 + 16 + (huff.Decode(&br) << 4);
+     repcount += huff.Decode(&br);
+    }
+    else
+     me->type = last_type = v;
+   }
+  }
+ }
+ //
+ // Entry offsets, lengths, and CRCs; the CRC of the whole map is over its 12-byte uncompressed form.
+ //
+ {
+  std::unique_ptr<uint8[]> raw_map(new uint8[(size_t)hunk_count * 12]);
+  uint64 cur_offset = first_offset;
+  uint32 last_self = 0;
+  uint64 last_parent = 0;
+
+  for(uint32 hunknum = 0; hunknum < hunk_count; hunknum++)
+  {
+   MapEntry* me = &hunk_map[hunknum];
+   uint8* rme = &raw_map[hunknum * 12];
+
+   me->offset = cur_offset;
+   me->length = 0;
+   me->crc = 0;
+
+   switch(me->type)
+   {
+    case CHD_MAP_CODEC_0 + 0:
+    case CHD_MAP_CODEC_0 + 1:
+    case CHD_MAP_CODEC_0 + 2:
+    case CHD_MAP_CODEC_0 + 3:
+	me->length = br.Read(length_bits);
+	me->crc = br.Read(16);
+	cur_offset += me->length;
+	break;
+
+    case CHD_MAP_NONE:
+	me->length = hunk_bytes;
+	me->crc = br.Read(16);
+	cur_offset += me->length;
+	break;
+
+    case CHD_MAP_SELF:
+	me->offset = last_self = br.Read(self_bits);
+	break;
+
+    case CHD_MAP_PARENT:
+	me->offset = last_parent = br.Read(parent_bits);
+	break;
+
+    case CHD_MAP_SELF_1:
+	last_self++;
+    case CHD_MAP_SELF_0:
+	me->type = CHD_MAP_SELF;
+	me->offset = last_self;
+	break;
+
+    case CHD_MAP_PARENT_SELF:
+	me->type = CHD_MAP_PARENT;
+	me->offset = last_parent = (uint64)hunknum * hunk_bytes / CHD_FRAME_SIZE;
+	break;
+
+    case CHD_MAP_PARENT_1:
+	last_parent += hunk_bytes / CHD_FRAME_SIZE;
+    case CHD_MAP_PARENT_0:
+	me->type = CHD_MAP_PARENT;
+	me->offset = last_parent;
+	break;
+
+    default:
+	throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+   }
+
+   rme[0] = me->type;
+   MDFN_en24msb(&rme[1], me->length);
+   MDFN_en16msb(&rme[4], me->offset >> 32);
+   MDFN_en32msb(&rme[6], me->offset);
+   MDFN_en16msb(&rme[10], me->crc);
+  }
+
+  if(br.Overflow() || crc16_ccitt_false(raw_map.get(), (size_t)hunk_count * 12) != map_crc)
+   throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+ }
+}
+
+void CDAccess_CHD::LoadTracks(const uint64 meta_offset)
+{
+ uint64 offset = meta_offset;
+ unsigned meta_count = 0;
+ int32 chd_frames = 0;
+
+ FirstTrack = 1;
+ LastTrack = 0;
+
+ while(offset)
+ {
+  uint8 meta_header[16];
+
+  if(++meta_count > 1024)
+   throw MDFN_Error(0, _("CHD metadata is corrupt."));
+
+  fp->seek(offset, SEEK_SET);
+  fp->read(meta_header, sizeof(meta_header));
+
+  const uint32 tag = MDFN_de32msb(&meta_header[0]);
+  const uint32 length = MDFN_de24msb(&meta_header[5]);
+
+  offset = MDFN_de64msb(&meta_header[8]);
+
+  if(tag == CHD_META_CDROM_OLD || tag == CHD_META_GDROM_TRACK)
+   throw MDFN_Error(0, _("CHD image has an unsupported track metadata format."));
+
+  if(tag != CHD_META_CDROM_TRACK && tag != CHD_META_CDROM_TRACK2)
+   continue;
+  //
+  //
+  //
+  char meta[256];
+  char type[32], subtype[32], pgtype[32], pgsub[32];
+  int track = 0, frames = 0, pregap = 0, postgap = 0;
+  int format = -1;
+
+  if(length >= sizeof(meta))
+   throw MDFN_Error(0, _("CHD metadata is corrupt."));
+
+  fp->read(meta, length);
+  meta[length] = 0;
+
+  pgtype[0] = 0;
+
+  if(tag == CHD_META_CDROM_TRACK2)
+  {
+   if(trio_sscanf(meta, "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d PREGAP:%d PGTYPE:%31s PGSUB:%31s POSTGAP:%d", &track, type, subtype, &frames, &pregap, pgtype, pgsub, &postgap) != 8)
+    throw MDFN_Error(0, _("Malformed CHD track metadata: %s"), MDFN_strhumesc(meta).c_str());
+  }
+  else
+  {
+   if(trio_sscanf(meta, "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d", &track, type, subtype, &frames) != 4)
+    throw MDFN_Error(0, _("Malformed CHD track metadata: %s"), MDFN_strhumesc(meta).c_str());
+  }
+
+  if(track != (LastTrack + 1) || track > 99)
+   throw MDFN_Error(0, _("CHD track metadata is out of order, or has an invalid track number(%d)."), track);
+
+  for(int i = 0; i < _CHD_FORMAT_COUNT; i++)
+  {
+   if(!strcmp(type, CHD_FormatStrings[i]))
+    format = i;
+  }
+
+  if(format < 0)
+   throw MDFN_Error(0, _("Unsupported CHD track type \"%s\"."), MDFN_strhumesc(type).c_str());
+
+  if(frames <= 0 || pregap < 0 || postgap < 0 || (pgtype[0] == 'V' && pregap > frames) || frames > (0x7FFFFFFF - CHD_TRACK_PADDING - chd_frames))
+   throw MDFN_Error(0, _("Malformed CHD track metadata: %s"), MDFN_strhumesc(meta).c_str());
+
+  CHDTrack* t = &Tracks[track];
+
+  t->format = format;
+  //
+  // "RW" is cooked(deinterleaved) R-W data without P and Q, which would clobber the synthesized Q when copied as-is;
+  // only "RW_RAW" is supported, as with cdrdao TOC files.
+  //
+  if(!strcmp(subtype, "RW"))
+   throw MDFN_Error(0, _("\"RW\" format subchannel data in CHD images is not supported, only \"RW_RAW\" is."));
+  else if(strcmp(subtype, "NONE") && strcmp(subtype, "RW_RAW"))
+   throw MDFN_Error(0, _("Unsupported CHD track subchannel type \"%s\"."), MDFN_strhumesc(subtype).c_str());
+
+  t->subcode = !strcmp(subtype, "RW_RAW");
+  t->subq_control = (format == CHD_FORMAT_AUDIO) ? 0 : SUBQ_CTRLF_DATA;
+  t->postgap = postgap;
+  t->chd_frame = chd_frames;
+
+  // A pregap type beginning with 'V' means the pregap sectors are stored in the image, at the start of the track.
+  if(pgtype[0] == 'V')
+  {
+   t->pregap = 0;
+   t->pregap_dv = pregap;
+  }
+  else
+  {
+   t->pregap = pregap;
+   t->pregap_dv = 0;
+  }
+  t->sectors = frames - t->pregap_dv;
+
+  chd_frames += (frames + CHD_TRACK_PADDING - 1) / CHD_TRACK_PADDING * CHD_TRACK_PADDING;
+
+  LastTrack = track;
+
+  if(format == CHD_FORMAT_MODE2 || format == CHD_FORMAT_MODE2_FORM1 || format == CHD_FORMAT_MODE2_FORM2 || format == CHD_FORMAT_MODE2_FORM_MIX || format == CHD_FORMAT_MODE2_RAW)
+   disc_type = DISC_TYPE_CD_XA;
+ }
+
+ if(FirstTrack > LastTrack)
+  throw MDFN_Error(0, _("No tracks found!\n"));
+
+ if((uint64)chd_frames > (uint64)hunk_count * (hunk_bytes / CHD_FRAME_SIZE))
+  throw MDFN_Error(0, _("CHD track metadata doesn't match the image size."));
+
+ NumTracks = 1 + LastTrack - FirstTrack;
+ //
+ //
+ //
+ int32 RunningLBA = -150;
+
+ Tracks[FirstTrack].pregap += 150;
+
+ for(int x = FirstTrack; x < (FirstTrack + NumTracks); x++)
+ {
+  RunningLBA += Tracks[x].pregap;
+  RunningLBA += Tracks[x].pregap_dv;
+
+  Tracks[x].LBA = RunningLBA;
+
+  RunningLBA += Tracks[x].sectors;
+  RunningLBA += Tracks[x].postgap;
+ }
+
+ total_sectors = RunningLBA;
+}
+
+const uint8* CDAccess_CHD::ReadHunk(const uint32 hunknum)
+{
+ HunkCacheEntry* victim = &HunkCache[0];
+
+ for(auto& hce : HunkCache)
+ {
+  if(hce.hunknum == hunknum)
+  {
+   hce.last_use = ++HunkCacheCounter;
+   return hce.data.get();
+  }
+
+  if(hce.last_use < victim->last_use)
+   victim = &hce;
+ }
+
+ victim->hunknum = ~(uint32)0;
+ victim->last_use = 0;
+ DecompressHunk(hunknum, victim->data.get());
+ victim->hunknum = hunknum;
+ victim->last_use = ++HunkCacheCounter;
+
+ return victim->data.get();
+}
+
+void CDAccess_CHD::DecompressHunk(const uint32 hunknum, uint8* dest)
+{
+ const MapEntry* me = &hunk_map[hunknum];
+
+ try
+ {
+  switch(me->type)
+  {
+   default:
+	throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+   case CHD_MAP_CODEC_0 + 0:
+   case CHD_MAP_CODEC_0 + 1:
+   case CHD_MAP_CODEC_0 + 2:
+   case CHD_MAP_CODEC_0 + 3:
+	if(!compressors[me->type] || me->length > hunk_bytes)
+	 throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+	fp->seek(me->offset, SEEK_SET);
+	fp->read(comp_buf.get(), me->length);
+	DecompressCD(compressors[me->type], comp_buf.get(), me->length, dest);
+
+	if(crc16_ccitt_false(dest, hunk_bytes) != me->crc)
+	 throw MDFN_Error(0, _("CRC mismatch."));
+	break;
+
+   case CHD_MAP_NONE:
+	fp->seek(me->offset, SEEK_SET);
+	fp->read(dest, hunk_bytes);
+
+	if(crc16_ccitt_false(dest, hunk_bytes) != me->crc)
+	 throw MDFN_Error(0, _("CRC mismatch."));
+	break;
+
+   case CHD_MAP_RAW:
+	if(!me->offset)
+	 memset(dest, 0, hunk_bytes);
+	else
+	{
+	 fp->seek(me->offset, SEEK_SET);
+	 fp->read(dest, hunk_bytes);
+	}
+	break;
+
+   case CHD_MAP_SELF:
+	// Always a copy of an earlier hunk.
+	if(me->offset >= hunknum)
+	 throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+	DecompressHunk(me->offset, dest);
+	break;
+
+   case CHD_MAP_PARENT:
+	throw MDFN_Error(0, _("CHD images that depend on a parent CHD are not supported."));
+  }
+ }
+ catch(MDFN_Error& e)
+ {
+  throw MDFN_Error(0, _("Error reading CHD hunk %u: %s"), hunknum, e.what());
+ }
+}
+
+void CDAccess_CHD::Inflate(const uint8* src, const uint32 src_len, uint8* dest, const uint32 dest_len)
+{
+ inflateReset(&zs);
+
+ zs.next_in = (Bytef*)src;
+ zs.avail_in = src_len;
+ zs.next_out = dest;
+ zs.avail_out = dest_len;
+
+ if(inflate(&zs, Z_FINISH) != Z_STREAM_END || zs.avail_out)
+  throw MDFN_Error(0, _("zlib data is corrupt."));
+}
+
+void CDAccess_CHD::ZstdDecompress(const uint8* src, const uint32 src_len, uint8* dest, const uint32 dest_len)
+{
+ const size_t res = ZSTD_decompressDCtx(zstd_dctx, dest, dest_len, src, src_len);
+
+ if(ZSTD_isError(res))
+  throw MDFN_Error(0, _("%s failed: %s"), "ZSTD_decompressDCtx()", ZSTD_getErrorName(res));
+
+ if(res != dest_len)
+  throw MDFN_Error(0, _("zstd data is corrupt."));
+}
+
+//
+// All of the CD codecs compress the sector data of the hunk's frames, then their subchannel data, separately.
+//
+void CDAccess_CHD::DecompressCD(const uint32 codec, const uint8* src, const uint32 src_len, uint8* dest)
+{
+ const uint32 frames = hunk_bytes / CHD_FRAME_SIZE;
+ uint8* const sector_data = codec_buf.get();
+ uint8* const subcode_data = codec_buf.get() + frames * CHD_SECTOR_DATA_SIZE;
+
+#ifdef HAVE_LIBFLAC
+ if(codec == CHD_CODEC_CD_FLAC)
+ {
+  uint32 block_size = frames * CHD_SECTOR_DATA_SIZE / 4;
+
+  while(block_size > CHD_SECTOR_DATA_SIZE)
+   block_size /= 2;
+
+  const uint32 flac_len = CHD_FLAC_Decode(src, src_len, sector_data, frames * (CHD_SECTOR_DATA_SIZE / 4), block_size);
+
+  Inflate(src + flac_len, src_len - flac_len, subcode_data, frames * CHD_SUBCODE_SIZE);
+
+  for(uint32 f = 0; f < frames; f++)
+  {
+   memcpy(&dest[f * CHD_FRAME_SIZE], &sector_data[f * CHD_SECTOR_DATA_SIZE], CHD_SECTOR_DATA_SIZE);
+   memcpy(&dest[f * CHD_FRAME_SIZE + CHD_SECTOR_DATA_SIZE], &subcode_data[f * CHD_SUBCODE_SIZE], CHD_SUBCODE_SIZE);
+  }
+  return;
+ }
+#endif
+ //
+ // Header: bitmap of frames whose sync pattern and P/Q parity were stripped, then the compressed size of the sector
+ // data.
+ //
+ const uint32 ecc_bytes = (frames + 7) / 8;
+ const uint32 header_bytes = ecc_bytes + ((hunk_bytes < 65536) ? 2 : 3);
+
+ if(src_len < header_bytes)
+  throw MDFN_Error(0, _("Compressed data is truncated."));
+
+ const uint32 base_len = (hunk_bytes < 65536) ? MDFN_de16msb(&src[ecc_bytes]) : MDFN_de24msb(&src[ecc_bytes]);
+
+ if(base_len > (src_len - header_bytes))
+  throw MDFN_Error(0, _("Compressed data is truncated."));
+
+ const uint8* const base_src = src + header_bytes;
+ const uint8* const subcode_src = base_src + base_len;
+ const uint32 subcode_len = src_len - header_bytes - base_len;
+
+ if(codec == CHD_CODEC_CD_LZMA)
+ {
+  std::unique_ptr<CHD_LZMADecoder> lzd(new CHD_LZMADecoder());
+
+  lzd->Decode(base_src, base_len, sector_data, frames * CHD_SECTOR_DATA_SIZE);
+ }
+ else if(codec == CHD_CODEC_CD_ZSTD)
+  ZstdDecompress(base_src, base_len, sector_data, frames * CHD_SECTOR_DATA_SIZE);
+ else
+  Inflate(base_src, base_len, sector_data, frames * CHD_SECTOR_DATA_SIZE);
+
+ if(codec == CHD_CODEC_CD_ZSTD)
+  ZstdDecompress(subcode_src, subcode_len, subcode_data, frames * CHD_SUBCODE_SIZE);
+ else
+  Inflate(subcode_src, subcode_len, subcode_data, frames * CHD_SUBCODE_SIZE);
+
+ for(uint32 f = 0; f < frames; f++)
+ {
+  uint8* const frame = &dest[f * CHD_FRAME_SIZE];
+
+  memcpy(frame, &sector_data[f * CHD_SECTOR_DATA_SIZE], CHD_SECTOR_DATA_SIZE);
+  memcpy(frame + CHD_SECTOR_DATA_SIZE, &subcode_data[f * CHD_SUBCODE_SIZE], CHD_SUBCODE_SIZE);
+
+  if(src[f >> 3] & (1U << (f & 7)))
+  {
+   static const uint8 sync[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+   memcpy(frame, sync, sizeof(sync));
+   encode_pq_parity(frame);
+  }
+ }
+}
+
+void CDAccess_CHD::Read_Raw_Sector(uint8 *buf, int32 lba)
+{
+ ReadSector(buf, lba, true);
+}
+
+bool CDAccess_CHD::Read_Raw_Sector_Cooked(uint8 *buf, int32 lba)
+{
+ return ReadSector(buf, lba, false);
+}
+
+// Returns true if EDC/L-EC synthesis was skipped for the sector(only when !synth_ecc).
+bool CDAccess_CHD::ReadSector(uint8 *buf, int32 lba, const bool synth_ecc)
+{
+ bool ret = false;
+ int32 track;
+ CHDTrack* ct;
+
+ //
+ // Leadout synthesis
+ //
+ if(lba >= total_sectors)
+ {
+  uint8 data_synth_mode = (disc_type == DISC_TYPE_CD_XA ? 0x02 : 0x01);
+
+  switch(Tracks[LastTrack].format)
+  {
+   case CHD_FORMAT_AUDIO:
+	break;
+
+   case CHD_FORMAT_MODE1:
+   case CHD_FORMAT_MODE1_RAW:
+	data_synth_mode = 0x01;
+	break;
+
+   default:
+	data_synth_mode = 0x02;
+	break;
+  }
+
+  synth_leadout_sector_lba(data_synth_mode, toc, lba, buf);
+  return ret;
+ }
+
+ memset(buf + 2352, 0, 96);
+ track = MakeSubPQ(lba, buf + 2352);
+ ct = &Tracks[track];
+
+ //
+ // Handle pregap and postgap reading
+ //
+ if(lba < (ct->LBA - ct->pregap_dv) || lba >= (ct->LBA + ct->sectors))
+ {
+  CHDTrack* et = ct;
+
+  if((lba - ct->LBA) < -150)
+  {
+   if((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+    et = &Tracks[track - 1];
+  }
+
+  memset(buf, 0, 2352);
+  switch(et->format)
+  {
+   case CHD_FORMAT_AUDIO:
+	break;
+
+   case CHD_FORMAT_MODE1:
+   case CHD_FORMAT_MODE1_RAW:
+	encode_mode1_sector(lba + 150, buf);
+	break;
+
+   default:
+	buf[12 +  6] = 0x20;
+	buf[12 + 10] = 0x20;
+	encode_mode2_form2_sector(lba + 150, buf);
+	break;
+  }
+ }
+ else
+ {
+  const uint64 chd_offset = (uint64)(ct->chd_frame + (lba - (ct->LBA - ct->pregap_dv))) * CHD_FRAME_SIZE;
+  const uint8* frame = ReadHunk(chd_offset / hunk_bytes) + (chd_offset % hunk_bytes);
+
+  switch(ct->format)
+  {
+   case CHD_FORMAT_AUDIO:
+	memcpy(buf, frame, 2352);
+	Endian_A16_Swap(buf, 588 * 2);	// Stored big-endian.
+	break;
+
+   case CHD_FORMAT_MODE1:
+	memcpy(buf + 12 + 3 + 1, frame, 2048);
+
+	if(synth_ecc)
+	 encode_mode1_sector(lba + 150, buf);
+	else
+	{
+	 encode_mode1_sector_noecc(lba + 150, buf);
+	 ret = true;
+	}
+	break;
+
+   case CHD_FORMAT_MODE1_RAW:
+   case CHD_FORMAT_MODE2_RAW:
+	memcpy(buf, frame, 2352);
+	break;
+
+   case CHD_FORMAT_MODE2:
+   case CHD_FORMAT_MODE2_FORM_MIX:
+	memcpy(buf + 16, frame, 2336);
+	encode_mode2_sector(lba + 150, buf);
+	break;
+
+   case CHD_FORMAT_MODE2_FORM1:
+	memset(buf, 0, 24);
+	memcpy(buf + 24, frame, 2048);
+	encode_mode2_form1_sector(lba + 150, buf);
+	break;
+
+   case CHD_FORMAT_MODE2_FORM2:
+	memset(buf, 0, 24);
+	buf[12 +  6] = 0x20;
+	buf[12 + 10] = 0x20;
+	memcpy(buf + 24, frame, 2324);
+	encode_mode2_form2_sector(lba + 150, buf);
+	break;
+  }
+
+  if(ct->subcode)
+   memcpy(buf + 2352, frame + CHD_SECTOR_DATA_SIZE, 96);
+ }
+
+ return ret;
+}
+
+bool CDAccess_CHD::Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba) const noexcept
+{
+ int32 track;
+
+ if(lba >= total_sectors)
+ {
+  subpw_synth_leadout_lba(toc, lba, pwbuf);
+  return true;
+ }
+
+ memset(pwbuf, 0, 96);
+ try
+ {
+  track = MakeSubPQ(lba, pwbuf);
+ }
+ catch(...)
+ {
+  return false;
+ }
+
+ //
+ // Stored subchannel data would need a hunk decompressed, which isn't fast(or thread-safe).
+ //
+ if(Tracks[track].subcode && lba >= (Tracks[track].LBA - Tracks[track].pregap_dv) && (lba < Tracks[track].LBA + Tracks[track].sectors))
+  return false;
+
+ return true;
+}
+
+//
+// Note: this function makes use of the current contents(as in |=) in SubPWBuf.
+//
+int32 CDAccess_CHD::MakeSubPQ(int32 lba, uint8 *SubPWBuf) const
+{
+ uint8 buf[0xC];
+ int32 track;
+ uint32 lba_relative;
+ uint8 pause_or = 0x00;
+ bool track_found = false;
+
+ for(track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+ {
+  if(lba >= (Tracks[track].LBA - Tracks[track].pregap_dv - Tracks[track].pregap) && lba < (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
+  {
+   track_found = true;
+   break;
+  }
+ }
+
+ if(!track_found)
+  throw(MDFN_Error(0, _("Could not find track for sector %u!"), lba));
+
+ if(lba < Tracks[track].LBA)
+  lba_relative = Tracks[track].LBA - 1 - lba;
+ else
+  lba_relative = lba - Tracks[track].LBA;
+
+ uint8 adr = 0x1; // Q channel data encodes position
+ uint8 control = Tracks[track].subq_control;
+
+ // Handle pause(D7 of interleaved subchannel byte) bit, should be set to 1 when in pregap or postgap.
+ if((lba < Tracks[track].LBA) || (lba >= Tracks[track].LBA + Tracks[track].sectors))
+  pause_or = 0x80;
+
+ // Handle pregap between audio->data track; see CDAccess_Image::MakeSubPQ().
+ if(((int32)lba - Tracks[track].LBA) < -150)
+ {
+  if((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+   control = Tracks[track - 1].subq_control;
+ }
+
+ memset(buf, 0, 0xC);
+ buf[0] = (adr << 0) | (control << 4);
+ buf[1] = U8_to_BCD(track);
+ buf[2] = U8_to_BCD(lba >= Tracks[track].LBA);
+
+ //
+ // Track relative MSF address
+ //
+ ABA_to_AMSF_BCD(lba_relative, &buf[3], &buf[4], &buf[5]);
+
+ buf[6] = 0;
+
+ //
+ // Absolute MSF address
+ //
+ ABA_to_AMSF_BCD(LBA_to_ABA(lba), &buf[7], &buf[8], &buf[9]);
+
+ subq_generate_checksum(buf);
+
+ for(int i = 0; i < 96; i++)
+  SubPWBuf[i] |= (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | pause_or;
+
+ return track;
+}
+
+void CDAccess_CHD::Read_TOC(TOC *rtoc)
+{
+ *rtoc = toc;
+}
+
+void CDAccess_CHD::GenerateTOC(void)
+{
+ toc.Clear();
+
+ toc.first_track = FirstTrack;
+ toc.last_track = FirstTrack + NumTracks - 1;
+ toc.disc_type = disc_type;
+
+ for(int i = FirstTrack; i < FirstTrack + NumTracks; i++)
+ {
+  toc.tracks[i].lba = Tracks[i].LBA;
+  toc.tracks[i].adr = ADR_CURPOS;
+  toc.tracks[i].control = Tracks[i].subq_control;
+  toc.tracks[i].valid = true;
+ }
+
+ toc.tracks[100].lba = total_sectors;
+ toc.tracks[100].adr = ADR_CURPOS;
+ toc.tracks[100].control = Tracks[FirstTrack + NumTracks - 1].subq_control;
+ toc.tracks[100].valid = true;
+}
+
+}
@@ -0,0 +1,134 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAccess_CHD.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_CDACCESS_CHD_H
+#define __MDFN_CDACCESS_CHD_H
+
+#include "CDAccess.h"
+
+#include <zlib.h>
+#include <zstd/zstd.h>
+
+namespace Mednafen
+{
+
+//
+// MAME CHD(compressed hunks of data) version 5 CD-ROM images, as made by "chdman createcd".
+//
+// The image is a sequence of fixed-size hunks, each holding a whole number of 2448-byte frames(sector data, then 96
+// bytes of subchannel data), compressed independently with one of the up to four codecs named in the header.  Sectors
+// are read by decompressing the hunk containing them into a small LRU cache of hunks, so sequential reads decompress
+// each hunk once, and nothing is decompressed ahead of time.
+//
+// Q subchannel data is synthesized from the track layout in the metadata, as for CUE sheets, unless the image stores
+// subchannel data.  CHDs that depend on a parent CHD aren't supported.
+//
+class CDAccess_CHD : public CDAccess
+{
+ public:
+
+ CDAccess_CHD(VirtualFS* vfs, const std::string& path, bool image_memcache);
+ virtual ~CDAccess_CHD();
+
+ virtual void Read_Raw_Sector(uint8 *buf, int32 lba);
+ virtual bool Read_Raw_Sector_Cooked(uint8 *buf, int32 lba);
+
+ virtual bool Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba) const noexcept;
+
+ virtual void Read_TOC(CDUtility::TOC *toc);
+
+ private:
+
+ struct CHDTrack
+ {
+  int32 LBA;
+  int32 pregap;		// Synthesized pregap sectors, before the stored pregap sectors(if any).
+  int32 pregap_dv;	// Pregap sectors stored in the image.
+  int32 postgap;
+  int32 sectors;	// Not including pregap sectors!
+  uint32 chd_frame;	// Frame in the image of the first stored sector, including pregap.
+  uint8 format;
+  uint8 subq_control;
+  bool subcode;		// Raw P-W subchannel data stored in the image.
+ };
+
+ struct MapEntry
+ {
+  uint64 offset;
+  uint32 length;
+  uint16 crc;
+  uint8 type;
+ };
+
+ enum { HunkCacheCount = 8 };
+
+ struct HunkCacheEntry
+ {
+  uint32 hunknum;
+  uint64 last_use;
+  std::unique_ptr<uint8[]> data;
+ };
+
+ void Load(VirtualFS* vfs, const std::string& path, bool image_memcache);
+ void LoadMap(const uint64 map_offset);
+ void LoadTracks(const uint64 meta_offset);
+ void GenerateTOC(void);
+ void Cleanup(void);
+
+ const uint8* ReadHunk(const uint32 hunknum);
+ void DecompressHunk(const uint32 hunknum, uint8* dest);
+ void DecompressCD(const uint32 codec, const uint8* src, const uint32 src_len, uint8* dest);
+ void Inflate(const uint8* src, const uint32 src_len, uint8* dest, const uint32 dest_len);
+ void ZstdDecompress(const uint8* src, const uint32 src_len, uint8* dest, const uint32 dest_len);
+
+ // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
+ int32 MakeSubPQ(int32 lba, uint8 *SubPWBuf) const;
+
+ bool ReadSector(uint8 *buf, int32 lba, const bool synth_ecc);
+
+ std::unique_ptr<Stream> fp;
+
+ uint32 compressors[4];
+ uint32 hunk_bytes;
+ uint32 hunk_count;
+ std::unique_ptr<MapEntry[]> hunk_map;
+
+ std::unique_ptr<uint8[]> comp_buf;
+ std::unique_ptr<uint8[]> codec_buf;
+
+ HunkCacheEntry HunkCache[HunkCacheCount];
+ uint64 HunkCacheCounter;
+
+ z_stream zs;
+ bool zs_inited;
+ ZSTD_DCtx* zstd_dctx;
+
+ int32 NumTracks;
+ int32 FirstTrack;
+ int32 LastTrack;
+ int32 total_sectors;
+ uint8 disc_type;
+ CHDTrack Tracks[100];
+ CDUtility::TOC toc;
+};
+
+}
+#endif
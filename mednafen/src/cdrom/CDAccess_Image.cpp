@@ -211,17 +211,17 @@ void CDAccess_Image::ParseTOCFileLineInfo(VirtualFS* vfs, CDRFILE_TRACK_INFO *tr
 
   efn = vfs->eval_fip(base_dir, filename);
 
-  if(image_memcache)
-   track->fp = new MemoryStream(vfs->open(efn, VirtualFS::MODE_READ));
-  else
-  {
-   track->fp = vfs->open(efn, VirtualFS::MODE_READ);
-   track->fp->require_fast_seekable();
-  }
+  track->fp = OpenImageFile(vfs, efn, image_memcache);
 
   toc_streamcache[filename] = track->fp;
  }
 
+ if(image_memcache)
+ {
+  track->MapData = track->fp->map();
+  track->MapSize = track->fp->map_size();
+ }
+
  if(filename.length() >= 4 && !MDFN_strazicmp(filename.c_str() + filename.length() - 4, ".wav"))
  {
   try
@@ -646,13 +646,14 @@ void CDAccess_Image::ImageOpen(VirtualFS* vfs, const std::string& path, bool ima
      }
 
      std::string efn = vfs->eval_fip(base_dir, args[0]);
-     TmpTrack.fp = vfs->open(efn, VirtualFS::MODE_READ);
+     TmpTrack.fp = OpenImageFile(vfs, efn, image_memcache);
      TmpTrack.FirstFileInstance = 1;
 
      if(image_memcache)
-      TmpTrack.fp = new MemoryStream(TmpTrack.fp);
-     else
-      TmpTrack.fp->require_fast_seekable();
+     {
+      TmpTrack.MapData = TmpTrack.fp->map();
+      TmpTrack.MapSize = TmpTrack.fp->map_size();
+     }
 
      if(!MDFN_strazicmp(args[1].c_str(), "BINARY"))
      {
@@ -942,10 +943,30 @@ void CDAccess_Image::ImageOpen(VirtualFS* vfs, const std::string& path, bool ima
  }
 
  GenerateTOC();
+
+ //
+ // Read compressed audio tracks through a cache of decoded audio, decoded on a separate thread.
+ //
+ {
+  std::vector<CDAFReader*> readers;
+
+  for(int32 x = FirstTrack; x < (FirstTrack + NumTracks); x++)
+  {
+   CDAFReader* ar = Tracks[x].AReader;
+
+   if(ar && ar->IsCompressed() && std::find(readers.begin(), readers.end(), ar) == readers.end())
+    readers.push_back(ar);
+  }
+
+  if(readers.size())
+   AudioCache.reset(new CDAFCache(readers));
+ }
 }
 
 void CDAccess_Image::Cleanup(void)
 {
+ AudioCache.reset();
+
  for(int32 track = 0; track < 100; track++)
  {
   CDRFILE_TRACK_INFO *this_track = &Tracks[track];
@@ -989,6 +1010,34 @@ CDAccess_Image::~CDAccess_Image()
 
 void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 {
+ ReadSector(buf, lba, true);
+}
+
+bool CDAccess_Image::Read_Raw_Sector_Cooked(uint8 *buf, int32 lba)
+{
+ return ReadSector(buf, lba, false);
+}
+
+void CDAccess_Image::ReadTrackData(const CDRFILE_TRACK_INFO* ct, uint64 pos, uint8* dest, uint32 count)
+{
+ if(ct->MapData)
+ {
+  if(pos > ct->MapSize || count > ct->MapSize - pos)
+   throw MDFN_Error(0, _("Unexpected EOF"));
+
+  memcpy(dest, ct->MapData + pos, count);
+ }
+ else
+ {
+  ct->fp->seek(pos, SEEK_SET);
+  ct->fp->read(dest, count);
+ }
+}
+
+// Returns true if EDC/L-EC synthesis was skipped for the sector(only when !synth_ecc).
+bool CDAccess_Image::ReadSector(uint8 *buf, int32 lba, const bool synth_ecc)
+{
+  bool ret = false;
   uint8 SimuQ[0xC];
   int32 track;
   CDRFILE_TRACK_INFO *ct;
@@ -1020,7 +1069,7 @@ void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
    }
 
    synth_leadout_sector_lba(data_synth_mode, toc, lba, buf);
-   return;
+   return ret;
   }
   //
   //
@@ -1075,7 +1124,13 @@ void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
    if(ct->AReader)
    {
     int16 AudioBuf[588 * 2];
-    uint64 frames_read = ct->AReader->Read((ct->FileOffset / 4) + (lba - ct->LBA) * 588, AudioBuf, 588);
+    const uint64 frame_offset = (ct->FileOffset / 4) + (lba - ct->LBA) * 588;
+    uint64 frames_read;
+
+    if(AudioCache && ct->AReader->IsCompressed())
+     frames_read = AudioCache->Read(ct->AReader, frame_offset, AudioBuf, 588);
+    else
+     frames_read = ct->AReader->Read(frame_offset, AudioBuf, 588);
 
     ct->LastSamplePos += frames_read;
 
@@ -1101,30 +1156,35 @@ void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
     if(ct->SubchannelMode)
      SeekPos += 96 * (lba - ct->LBA);
 
-    ct->fp->seek(SeekPos, SEEK_SET);
-
     switch(ct->DIFormat)
     {
 	case DI_FORMAT_AUDIO:
-		ct->fp->read(buf, 2352);
+		ReadTrackData(ct, SeekPos, buf, 2352);
 
 		if(ct->RawAudioMSBFirst)
 		 Endian_A16_Swap(buf, 588 * 2);
 		break;
 
 	case DI_FORMAT_MODE1:
-		ct->fp->read(buf + 12 + 3 + 1, 2048);
-		encode_mode1_sector(lba + 150, buf);
+		ReadTrackData(ct, SeekPos, buf + 12 + 3 + 1, 2048);
+
+		if(synth_ecc)
+		 encode_mode1_sector(lba + 150, buf);
+		else
+		{
+		 encode_mode1_sector_noecc(lba + 150, buf);
+		 ret = true;
+		}
 		break;
 
 	case DI_FORMAT_MODE1_RAW:
 	case DI_FORMAT_MODE2_RAW:
 	case DI_FORMAT_CDI_RAW:
-		ct->fp->read(buf, 2352);
+		ReadTrackData(ct, SeekPos, buf, 2352);
 		break;
 
 	case DI_FORMAT_MODE2:
-		ct->fp->read(buf + 16, 2336);
+		ReadTrackData(ct, SeekPos, buf + 16, 2336);
 		encode_mode2_sector(lba + 150, buf);
 		break;
 
@@ -1132,21 +1192,23 @@ void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 	// FIXME: M2F1, M2F2, does sub-header come before or after user data(standards say before, but I wonder
 	// about cdrdao...).
 	case DI_FORMAT_MODE2_FORM1:
-		ct->fp->read(buf + 24, 2048);
+		ReadTrackData(ct, SeekPos, buf + 24, 2048);
 		//encode_mode2_form1_sector(lba + 150, buf);
 		break;
 
 	case DI_FORMAT_MODE2_FORM2:
-		ct->fp->read(buf + 24, 2324);
+		ReadTrackData(ct, SeekPos, buf + 24, 2324);
 		//encode_mode2_form2_sector(lba + 150, buf);
 		break;
 
     }
 
     if(ct->SubchannelMode)
-     ct->fp->read(buf + 2352, 96);
+     ReadTrackData(ct, SeekPos + DI_Size_Table[ct->DIFormat], buf + 2352, 96);
    }
   } // end if audible part of audio track read.
+
+  return ret;
 }
 
 bool CDAccess_Image::Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba) const noexcept
@@ -3,6 +3,8 @@
 
 #include <map>
 
+#include "CDAFCache.h"
+
 namespace Mednafen
 {
 
@@ -25,6 +27,8 @@ struct CDRFILE_TRACK_INFO
 
 	int32 sectors;	// Not including pregap sectors!
         Stream *fp;
+	const uint8* MapData;	// Non-NULL when "fp" is to be read from via its map()'d data(with cd.image_memcache).
+	uint64 MapSize;
 	bool FirstFileInstance;
 	bool RawAudioMSBFirst;
 	long FileOffset;
@@ -70,6 +74,7 @@ class CDAccess_Image : public CDAccess
  virtual ~CDAccess_Image();
 
  virtual void Read_Raw_Sector(uint8 *buf, int32 lba);
+ virtual bool Read_Raw_Sector_Cooked(uint8 *buf, int32 lba);
 
  virtual bool Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba) const noexcept;
 
@@ -87,6 +92,8 @@ class CDAccess_Image : public CDAccess
 
  std::map<uint32, std::array<uint8, 12>> SubQReplaceMap;
 
+ std::unique_ptr<CDAFCache> AudioCache;	// For compressed audio tracks.
+
  std::string base_dir;
 
  void ImageOpen(VirtualFS* vfs, const std::string& path, bool image_memcache);
@@ -97,6 +104,9 @@ class CDAccess_Image : public CDAccess
  // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
  int32 MakeSubPQ(int32 lba, uint8 *SubPWBuf) const;
 
+ bool ReadSector(uint8 *buf, int32 lba, const bool synth_ecc);
+ void ReadTrackData(const CDRFILE_TRACK_INFO* ct, uint64 pos, uint8* dest, uint32 count);
+
  void ParseTOCFileLineInfo(VirtualFS* vfs, CDRFILE_TRACK_INFO *track, const int tracknum, const std::string &filename, const char *binoffset, const char *msfoffset, const char *length, bool image_memcache, std::map<std::string, Stream*> &toc_streamcache);
  uint32 GetSectorCount(CDRFILE_TRACK_INFO *track);
 };
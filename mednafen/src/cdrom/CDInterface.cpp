@@ -47,6 +47,17 @@ bool CDInterface::NonDeterministic_CheckSectorReady(int32 lba)
  return true;
 }
 
+bool CDInterface::ReadRawSector(uint8* buf, int32 lba)
+{
+ bool cooked;
+ const bool ret = ReadRawSectorCooked(buf, lba, &cooked);
+
+ if(cooked)
+  encode_mode1_sector(LBA_to_ABA(lba), buf);
+
+ return ret;
+}
+
 uint8 CDInterface::ReadSectors(uint8* buf, int32 lba, uint32 sector_count)
 {
  uint8 ret = 0;
@@ -58,10 +69,11 @@ uint8 CDInterface::ReadSectors(uint8* buf, int32 lba, uint32 sector_count)
  {
   uint8 rawbuf[2352 + 96];
   uint8 mode;
+  bool cooked;
 
-  if(!ReadRawSector(rawbuf, lba))
+  if(!ReadRawSectorCooked(rawbuf, lba, &cooked))
   {
-   printf("ReadRawSector() failed in CDInterface::ReadSectors() for LBA=%d.\n", lba);
+   printf("ReadRawSectorCooked() failed in CDInterface::ReadSectors() for LBA=%d.\n", lba);
    return 0;
   }
 
@@ -73,7 +85,7 @@ uint8 CDInterface::ReadSectors(uint8* buf, int32 lba, uint32 sector_count)
   if(mode == 0x2 && (rawbuf[12 + 6] & 0x20))
    return 0;
 
-  if(!edc_lec_check_and_correct(rawbuf, mode == 2))
+  if(!cooked && !edc_lec_check_and_correct(rawbuf, mode == 2))
    return false;
 
   memcpy(buf, rawbuf + ((mode == 2) ? 24 : 16), 2048);
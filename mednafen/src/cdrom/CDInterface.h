@@ -66,7 +66,19 @@ class CDInterface
  // appropriate call was made to HintReadSector() early enough, it shouldn't
  // be too bad.
  //
- virtual bool ReadRawSector(uint8* buf, int32 lba) = 0;
+ bool ReadRawSector(uint8* buf, int32 lba);
+
+ //
+ // Like ReadRawSector(), but if the sector is a mode 1 sector that the
+ // image stores as cooked 2048-byte user data(ISO, or a MODE1/2048 BIN
+ // track), its EDC and L-EC fields are left zeroed instead of being
+ // synthesized, and *cooked is set to true.  Such user data is known good,
+ // so the caller should skip the EDC/L-EC check; a caller that needs the
+ // whole raw sector can fill in the rest with encode_mode1_sector().
+ //
+ // *cooked is set to false for every other sector.
+ //
+ virtual bool ReadRawSectorCooked(uint8* buf, int32 lba, bool* cooked) = 0;
 
  //
  // Reads 96 bytes of raw subchannel PW data into pwbuf.  Will be relatively
@@ -127,14 +127,134 @@ static int ReadThreadStart_C(void* arg)
  return ((CDInterface_MT*)arg)->ReadThreadStart();
 }
 
+//
+// Read-ahead tuning.
+//
+enum : int32 { ra_initial = 4 };	// Initial read-ahead depth, in sectors.
+enum : int32 { ra_max = 64 };		// Maximum read-ahead depth.
+enum : int32 { ra_shrink_hits = 64 };	// Sequential reads in a row found cached before the read-ahead depth is halved.
+enum : int32 { revisit_sectors = 16 };	// Sectors to keep cached at the start of each revisited region.
+enum : int32 { revisit_scan_interval = 64 };	// Sectors read between checks that revisited regions are still cached.
+
+// Called with SBMutex held.
+void CDInterface_MT::SBRemove(const int32 sbi)
+{
+ int32* link = &SBHash[(uint32)SectorBuffers[sbi].lba & (SBHashSize - 1)];
+
+ while(*link != sbi)
+  link = &SectorBuffers[*link].hash_next;
+
+ *link = SectorBuffers[sbi].hash_next;
+ SectorBuffers[sbi].hash_next = -1;
+ SectorBuffers[sbi].valid = false;
+}
+
+// Called with SBMutex held.
+void CDInterface_MT::SBInsert(const int32 lba, const uint8* data, const bool error, const bool cooked)
+{
+ int32 victim = 0;
+
+ for(int32 i = 0; i < SBSize; i++)
+ {
+  if(!SectorBuffers[i].valid)
+  {
+   victim = i;
+   break;
+  }
+
+  if(SectorBuffers[i].last_use < SectorBuffers[victim].last_use)
+   victim = i;
+ }
+
+ CDInterface_Sector_Buffer* sb = &SectorBuffers[victim];
+
+ if(sb->valid)
+  SBRemove(victim);
+
+ sb->valid = true;
+ sb->error = error;
+ sb->cooked = cooked;
+ sb->lba = lba;
+ sb->last_use = ++SBUseCounter;
+ memcpy(sb->data, data, 2352 + 96);
+
+ sb->hash_next = SBHash[(uint32)lba & (SBHashSize - 1)];
+ SBHash[(uint32)lba & (SBHashSize - 1)] = victim;
+}
+
+void CDInterface_MT::NoteSeek(const int32 lba)
+{
+ unsigned victim = 0;
+
+ SeekCounter++;
+
+ for(unsigned i = 0; i < SeekHistoryCount; i++)
+ {
+  auto* sh = &SeekHistory[i];
+
+  if(sh->visits && lba >= sh->lba && lba < (sh->lba + revisit_sectors))
+  {
+   sh->visits++;
+   sh->last_visit = SeekCounter;
+   return;
+  }
+
+  if(sh->last_visit < SeekHistory[victim].last_visit)
+   victim = i;
+ }
+
+ SeekHistory[victim].lba = lba;
+ SeekHistory[victim].visits = 1;
+ SeekHistory[victim].last_visit = SeekCounter;
+}
+
+//
+// Called when there's nothing else to read; keeps the start of each revisited region cached, marking the sectors as
+// recently used so they aren't evicted, and schedules reading them back in if they were.
+//
+void CDInterface_MT::PrefetchRevisited(void)
+{
+ if(revisit_scan_countdown > 0)
+  return;
+
+ revisit_scan_countdown = revisit_scan_interval;
+
+ MThreading::Mutex_Lock(SBMutex);
+
+ for(unsigned i = 0; i < SeekHistoryCount; i++)
+ {
+  const auto* sh = &SeekHistory[i];
+
+  if(sh->visits < 2)
+   continue;
+
+  for(int32 lba = sh->lba; lba < (sh->lba + revisit_sectors) && lba <= LBA_Read_Maximum; lba++)
+  {
+   const int32 sbi = SBFind(lba);
+
+   if(sbi >= 0)
+    SectorBuffers[sbi].last_use = ++SBUseCounter;
+   else if(!ra_count)
+   {
+    ra_lba = lba;
+    ra_count = (sh->lba + revisit_sectors) - lba;
+   }
+  }
+ }
+
+ MThreading::Mutex_Unlock(SBMutex);
+}
+
 int CDInterface_MT::ReadThreadStart()
 {
  bool Running = true;
 
- SBWritePos = 0;
  ra_lba = 0;
  ra_count = 0;
+ ra_window = ra_initial;
+ ra_hits = 0;
  last_read_lba = LBA_Read_Maximum + 1;
+ revisit_scan_countdown = 0;
 
  try
  {
@@ -145,11 +265,20 @@ int CDInterface_MT::ReadThreadStart()
    throw(MDFN_Error(0, _("TOC first(%d)/last(%d) track numbers bad."), disc_toc.first_track, disc_toc.last_track));
   }
 
-  SBWritePos = 0;
-  ra_lba = 0;
-  ra_count = 0;
-  last_read_lba = LBA_Read_Maximum + 1;
-  memset(SectorBuffers, 0, SBSize * sizeof(CDInterface_Sector_Buffer));
+  for(int32 i = 0; i < SBSize; i++)
+  {
+   SectorBuffers[i].valid = false;
+   SectorBuffers[i].hash_next = -1;
+   SectorBuffers[i].last_use = 0;
+  }
+
+  for(int32 i = 0; i < SBHashSize; i++)
+   SBHash[i] = -1;
+
+  SBUseCounter = 0;
+
+  memset(SeekHistory, 0, sizeof(SeekHistory));
+  SeekCounter = 0;
  }
  catch(std::exception &e)
  {
@@ -163,7 +292,10 @@ int CDInterface_MT::ReadThreadStart()
  {
   CDInterface_Message msg;
 
-  //printf("%d %d %d\n", last_read_lba, ra_lba, ra_count);
+  //printf("%d %d %d %d\n", last_read_lba, ra_lba, ra_count, ra_window);
+
+  if(!ra_count)
+   PrefetchRevisited();
 
   // Only do a blocking-wait for a message if we don't have any sectors to read-ahead.
   if(ReadThreadQueue.Read(&msg, ra_count ? false : true))
@@ -172,30 +304,53 @@ int CDInterface_MT::ReadThreadStart()
     Running = false;
    else if(msg.message == CDInterface_MSG_READ_SECTOR)
    {
-    static const int max_ra = 16;
-    static const int initial_ra = 1;
-    static const int speedmult_ra = 2;
-    //
     const int32 new_lba = msg.args[0];
+    bool seek = false;
 
-    static_assert((unsigned int)max_ra < (SBSize / 4), "Max readahead too large.");
+    static_assert(ra_max + revisit_sectors * SeekHistoryCount <= (SBSize / 2), "Max readahead too large.");
 
-    if(new_lba == (last_read_lba + 1))
-    {
-     int how_far_ahead = ra_lba - new_lba;
+    MThreading::Mutex_Lock(SBMutex);
+    const int32 sbi = SBFind(new_lba);
+    MThreading::Mutex_Unlock(SBMutex);
 
-     if(how_far_ahead <= max_ra)
-      ra_count = std::min(speedmult_ra, 1 + max_ra - how_far_ahead);
+    if(new_lba != last_read_lba)
+    {
+     if(new_lba == (last_read_lba + 1))
+     {
+      //
+      // If a sequentially-read sector hasn't been read yet, the emulation thread caught up with the read-ahead, so
+      // deepen it; if a long enough run of them were already cached, the read-ahead is deeper than it needs to be,
+      // so make it shallower.
+      //
+      if(sbi < 0)
+      {
+       ra_window = std::min<int32>(ra_max, ra_window * 2);
+       ra_hits = 0;
+      }
+      else if(++ra_hits >= ra_shrink_hits)
+      {
+       ra_window = std::max<int32>(ra_initial, ra_window / 2);
+       ra_hits = 0;
+      }
+     }
      else
-      ra_count++;
+     {
+      NoteSeek(new_lba);
+      seek = true;
+      ra_window = ra_initial;
+      ra_hits = 0;
+     }
+
+     last_read_lba = new_lba;
     }
-    else if(new_lba != last_read_lba)
+
+    if(seek || (sbi < 0 && (new_lba < ra_lba || new_lba >= (ra_lba + ra_count))))
     {
      ra_lba = new_lba;
-     ra_count = initial_ra;
+     ra_count = 0;
     }
 
-    last_read_lba = new_lba;
+    ra_count = std::max<int32>(ra_count, new_lba + 1 + ra_window - ra_lba);
    }
   }
 
@@ -208,14 +363,24 @@ int CDInterface_MT::ReadThreadStart()
    //printf("Ephemeral scarabs: %d!\n", ra_lba);
   }
 
+  bool ra_cached = false;
+
   if(ra_count)
+  {
+   MThreading::Mutex_Lock(SBMutex);
+   ra_cached = (SBFind(ra_lba) >= 0);
+   MThreading::Mutex_Unlock(SBMutex);
+  }
+
+  if(ra_count && !ra_cached)
   {
    uint8 tmpbuf[2352 + 96];
    bool error_condition = false;
+   bool cooked = false;
 
    try
    {
-    disc_cdaccess->Read_Raw_Sector(tmpbuf, ra_lba);
+    cooked = disc_cdaccess->Read_Raw_Sector_Cooked(tmpbuf, ra_lba);
    }
    catch(std::exception &e)
    {
@@ -228,11 +393,7 @@ int CDInterface_MT::ReadThreadStart()
    //
    MThreading::Mutex_Lock(SBMutex);
 
-   SectorBuffers[SBWritePos].lba = ra_lba;
-   memcpy(SectorBuffers[SBWritePos].data, tmpbuf, 2352 + 96);
-   SectorBuffers[SBWritePos].valid = true;
-   SectorBuffers[SBWritePos].error = error_condition;
-   SBWritePos = (SBWritePos + 1) % SBSize;
+   SBInsert(ra_lba, tmpbuf, error_condition, cooked);
 
    MThreading::Cond_Signal(SBCond);
 
@@ -240,6 +401,11 @@ int CDInterface_MT::ReadThreadStart()
    //
    //
 
+   revisit_scan_countdown--;
+  }
+
+  if(ra_count)
+  {
    ra_lba++;
    ra_count--;
   }
@@ -319,11 +485,13 @@ CDInterface_MT::~CDInterface_MT()
  Cleanup();
 }
 
-bool CDInterface_MT::ReadRawSector(uint8 *buf, int32 lba)
+bool CDInterface_MT::ReadRawSectorCooked(uint8 *buf, int32 lba, bool* cooked)
 {
  bool found = false;
  bool error_condition = false;
 
+ *cooked = false;
+
  if(UnrecoverableError)
  {
   memset(buf, 0, 2352 + 96);
@@ -338,23 +506,32 @@ bool CDInterface_MT::ReadRawSector(uint8 *buf, int32 lba)
  }
  //fprintf(stderr, "%d\n", ra_lba - lba);
 
- ReadThreadQueue.Write(CDInterface_Message(CDInterface_MSG_READ_SECTOR, lba));
-
- //
  //
+ // Evict a cached read error for the sector before asking for it, so that the wait below returns the result of reading
+ // it again.
  //
  MThreading::Mutex_Lock(SBMutex);
 
+ {
+  const int32 sbi = SBFind(lba);
+
+  if(sbi >= 0 && SectorBuffers[sbi].error)
+   SBRemove(sbi);
+ }
+
+ ReadThreadQueue.Write(CDInterface_Message(CDInterface_MSG_READ_SECTOR, lba));
+
  do
  {
-  for(int i = 0; i < SBSize; i++)
+  const int32 sbi = SBFind(lba);
+
+  if(sbi >= 0)
   {
-   if(SectorBuffers[i].valid && SectorBuffers[i].lba == lba)
-   {
-    error_condition = SectorBuffers[i].error;
-    memcpy(buf, SectorBuffers[i].data, 2352 + 96);
-    found = true;
-   }
+   SectorBuffers[sbi].last_use = ++SBUseCounter;
+   error_condition = SectorBuffers[sbi].error;
+   *cooked = SectorBuffers[sbi].cooked;
+   memcpy(buf, SectorBuffers[sbi].data, 2352 + 96);
+   found = true;
   }
 
   if(!found)
@@ -397,9 +574,10 @@ bool CDInterface_MT::ReadRawSectorPWOnly(uint8* pwbuf, int32 lba, bool hint_full
  else
  {
   uint8 tmpbuf[2352 + 96];
+  bool cooked;
   bool ret;
 
-  ret = ReadRawSector(tmpbuf, lba);
+  ret = ReadRawSectorCooked(tmpbuf, lba, &cooked);
   memcpy(pwbuf, tmpbuf + 2352, 96);
 
   return ret;
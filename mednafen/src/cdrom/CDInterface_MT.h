@@ -39,7 +39,7 @@ class CDInterface_MT : public CDInterface
  virtual ~CDInterface_MT() MDFN_COLD;
 
  virtual void HintReadSector(int32 lba) override;
- virtual bool ReadRawSector(uint8 *buf, int32 lba) override;
+ virtual bool ReadRawSectorCooked(uint8* buf, int32 lba, bool* cooked) override;
  virtual bool ReadRawSectorPWOnly(uint8* pwbuf, int32 lba, bool hint_fullread) override;
 
  // FIXME: Semi-private:
@@ -108,26 +108,67 @@ class CDInterface_MT : public CDInterface
  // Queue for messages to the emu thread.
  CDInterface_Queue EmuThreadQueue;
 
- enum { SBSize = 256 };
+ //
+ // Sector cache, indexed by LBA via SBHash, with least-recently-used replacement.  The read thread adds sectors, and
+ // the emulation thread evicts cached read errors so they're read again, so the cache is only accessed with SBMutex
+ // held.
+ //
+ enum { SBSize = 1024 };
+ enum { SBHashSize = 2048 };	// Must be a power of 2.
  struct CDInterface_Sector_Buffer
  {
   bool valid;
   bool error;
+  bool cooked;
   int32 lba;
+  int32 hash_next;	// Next buffer in the same hash chain, or -1.
+  uint64 last_use;
   uint8 data[2352 + 96];
  } SectorBuffers[SBSize];
 
- uint32 SBWritePos;
+ int32 SBHash[SBHashSize];	// First buffer in each hash chain, or -1.
+ uint64 SBUseCounter;
  
  MThreading::Mutex* SBMutex;
  MThreading::Cond* SBCond;
 
+ INLINE int32 SBFind(const int32 lba) const
+ {
+  for(int32 i = SBHash[(uint32)lba & (SBHashSize - 1)]; i >= 0; i = SectorBuffers[i].hash_next)
+  {
+   if(SectorBuffers[i].lba == lba)
+    return i;
+  }
+
+  return -1;
+ }
+
+ void SBRemove(const int32 sbi);
+ void SBInsert(const int32 lba, const uint8* data, const bool error, const bool cooked);
+
  //
  // Read-thread-only:
  //
+ void NoteSeek(const int32 lba);
+ void PrefetchRevisited(void);
+
  int32 ra_lba;
  int32 ra_count;
+ int32 ra_window;	// Read-ahead depth; grows when sequential reads catch up with the read-ahead, shrinks after a run
+			// of sequential reads that were already cached, and is reset on seek.
+ int32 ra_hits;		// Sequential reads in a row that were already cached.
  int32 last_read_lba;
+ int32 revisit_scan_countdown;
+
+ // Recent seek targets, to find regions that are revisited(e.g. looped CD-DA and FMV).
+ enum { SeekHistoryCount = 16 };
+ struct
+ {
+  int32 lba;
+  uint32 visits;
+  uint64 last_visit;
+ } SeekHistory[SeekHistoryCount];
+ uint64 SeekCounter;
 };
 
 }
@@ -53,8 +53,10 @@ void CDInterface_ST::HintReadSector(int32 lba)
  // TODO: disc_cdaccess seek hint? (probably not, would require asynchronousitycamel)
 }
 
-bool CDInterface_ST::ReadRawSector(uint8 *buf, int32 lba)
+bool CDInterface_ST::ReadRawSectorCooked(uint8 *buf, int32 lba, bool* cooked)
 {
+ *cooked = false;
+
  if(UnrecoverableError)
  {
   memset(buf, 0, 2352 + 96);
@@ -70,7 +72,7 @@ bool CDInterface_ST::ReadRawSector(uint8 *buf, int32 lba)
 
  try
  {
-  disc_cdaccess->Read_Raw_Sector(buf, lba);
+  *cooked = disc_cdaccess->Read_Raw_Sector_Cooked(buf, lba);
  }
  catch(std::exception &e)
  {
@@ -102,9 +104,10 @@ bool CDInterface_ST::ReadRawSectorPWOnly(uint8* pwbuf, int32 lba, bool hint_full
  else
  {
   uint8 tmpbuf[2352 + 96];
+  bool cooked;
   bool ret;
 
-  ret = ReadRawSector(tmpbuf, lba);
+  ret = ReadRawSectorCooked(tmpbuf, lba, &cooked);
   memcpy(pwbuf, tmpbuf + 2352, 96);
 
   return ret;
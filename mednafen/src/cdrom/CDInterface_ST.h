@@ -37,7 +37,7 @@ class CDInterface_ST : public CDInterface
  virtual ~CDInterface_ST();
 
  virtual void HintReadSector(int32 lba) override;
- virtual bool ReadRawSector(uint8* buf, int32 lba) override;
+ virtual bool ReadRawSectorCooked(uint8* buf, int32 lba, bool* cooked) override;
  virtual bool ReadRawSectorPWOnly(uint8* pwbuf, int32 lba, bool hint_fullread) override;
 
  private:
@@ -101,6 +101,24 @@ void encode_mode2_form2_sector(uint32 aba, uint8 *sector_data)
  lec_encode_mode2_form2_sector(aba, sector_data);
 }
 
+void encode_mode1_sector_noecc(uint32 aba, uint8 *sector_data)
+{
+ static const uint8 sync[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+ memcpy(sector_data, sync, sizeof(sync));
+ ABA_to_AMSF_BCD(aba, &sector_data[12 + 0], &sector_data[12 + 1], &sector_data[12 + 2]);
+ sector_data[12 + 3] = 0x01;
+
+ memset(sector_data + 16 + 2048, 0, 2352 - (16 + 2048));
+}
+
+void encode_pq_parity(uint8 *sector_data)
+{
+ CDUtility_Init();
+
+ lec_calc_pq_parity(sector_data);
+}
+
 bool edc_check(const uint8 *sector_data, bool xa)
 {
  CDUtility_Init();
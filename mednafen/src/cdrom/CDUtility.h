@@ -202,6 +202,14 @@ namespace CDUtility
  void encode_mode2_form1_sector(uint32 aba, uint8 *sector_data);	// 2048+8 bytes of user data at offset 16
  void encode_mode2_form2_sector(uint32 aba, uint8 *sector_data);	// 2324+8 bytes of user data at offset 16
 
+ // Like encode_mode1_sector(), but only writes the sync pattern and header, and zeroes the EDC, intermediate, and P/Q
+ // parity fields instead of calculating them; for sectors whose user data is known good and won't be checked.
+ void encode_mode1_sector_noecc(uint32 aba, uint8 *sector_data);
+
+ // Only calculates the P and Q parity fields, over the header and data(mode 1 layout) as they are in sector_data; for
+ // restoring the L-EC of raw sectors stored without it.
+ void encode_pq_parity(uint8 *sector_data);
+
 
  // User data area pre-pause(MSF 00:00:00 through 00:01:74), lba -150 through -1
  // out_buf must be able to contain 2352+96 bytes.
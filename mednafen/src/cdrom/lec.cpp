@@ -570,6 +570,16 @@ void lec_encode_mode2_form2_sector(u_int32_t adr, u_int8_t *sector)
   set_sector_header(2, adr, sector);
 }
 
+/* Calculates only the P and Q parities of a sector, over the header and
+ * data as they stand(mode 1 layout).
+ * 'sector' must be 2352 byte wide
+ */
+void lec_calc_pq_parity(u_int8_t *sector)
+{
+  calc_P_parity(sector);
+  calc_Q_parity(sector);
+}
+
 /* Scrambles and byte swaps an encoded sector.
  * 'sector' must be 2352 byte wide.
  */
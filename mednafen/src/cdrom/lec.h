@@ -69,6 +69,13 @@ void lec_encode_mode2_form1_sector(u_int32_t adr, u_int8_t *sector);
  */
 void lec_encode_mode2_form2_sector(u_int32_t adr, u_int8_t *sector);
 
+/* Calculates only the P and Q parities of a sector, over the header and
+ * data as they stand(mode 1 layout); the sync pattern, header, EDC and
+ * intermediate field are left untouched.
+ * 'sector' must be 2352 byte wide
+ */
+void lec_calc_pq_parity(u_int8_t *sector);
+
 /* Scrambles and byte swaps an encoded sector.
  * 'sector' must be 2352 byte wide.
  */
@@ -579,7 +579,8 @@ static void CommandCCError(int key, int asc = 0, int ascq = 0)
  SendStatusAndMessage(STATUS_CHECK_CONDITION, 0x00);
 }
 
-static bool ValidateRawDataSector(uint8 *data, const uint32 lba)
+// 'cooked' is from ReadRawSectorCooked(); the EDC/L-EC check is skipped for such sectors.
+static bool ValidateRawDataSector(uint8 *data, const uint32 lba, const bool cooked)
 {
  bool ok = true;
  const uint8 mode = data[12 + 3];
@@ -589,7 +590,7 @@ static bool ValidateRawDataSector(uint8 *data, const uint32 lba)
   ok = false;
  else if(mode == 0x2 && (data[12 + 6] & 0x20)) // Error if mode 2 form 2.
   ok = false;
- else if(!edc_lec_check_and_correct(data, mode == 2))
+ else if(!cooked && !edc_lec_check_and_correct(data, mode == 2))
   ok = false;
 
  if(!ok)
@@ -1491,6 +1492,7 @@ static void DoREADHEADER10(const uint8 *cdb)
  uint32 HeaderLBA = MDFN_de32msb(cdb + 0x2);
  int AllocSize = MDFN_de16msb(cdb + 0x7);
  uint8 raw_buf[2352 + 96];
+ bool cooked;
  uint8 mode;
  int m, s, f;
  uint32 lba;
@@ -1515,8 +1517,8 @@ static void DoREADHEADER10(const uint8 *cdb)
   return;
  }
 
- Cur_CDIF->ReadRawSector(raw_buf, HeaderLBA);	//, HeaderLBA + 1);
- if(!ValidateRawDataSector(raw_buf, HeaderLBA))
+ Cur_CDIF->ReadRawSectorCooked(raw_buf, HeaderLBA, &cooked);	//, HeaderLBA + 1);
+ if(!ValidateRawDataSector(raw_buf, HeaderLBA, cooked))
   return;
 
  m = BCD_to_U8(raw_buf[12 + 0]);
@@ -2942,6 +2944,7 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
    else
    {
     uint8 tmp_read_buf[2352 + 96];
+    bool tmp_read_cooked;
 
     if(TrayOpen)
     {
@@ -2958,13 +2961,13 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
     {
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST, NSE_END_OF_VOLUME);
     }
-    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr))	//, SectorAddr + SectorCount))
+    else if(!Cur_CDIF->ReadRawSectorCooked(tmp_read_buf, SectorAddr, &tmp_read_cooked))	//, SectorAddr + SectorCount))
     {
      cd.data_transfer_done = false;
 
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST);
     }
-    else if(ValidateRawDataSector(tmp_read_buf, SectorAddr))
+    else if(ValidateRawDataSector(tmp_read_buf, SectorAddr, tmp_read_cooked))
     {
      head_pos = SectorAddr;
 
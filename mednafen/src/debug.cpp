@@ -26,6 +26,8 @@ namespace Mednafen
 static std::vector<AddressSpaceType> AddressSpaces;
 static std::vector<const RegGroupType*> RegGroups;
 
+static void FreeAllUsageMaps(void);
+
 // Currently only called on emulator startup, not game load...
 void MDFNDBG_Init(void)
 {
@@ -45,16 +47,17 @@ void MDFNDBG_PostGameLoad(void)
 // Called on game close.
 void MDFNDBG_Kill(void)
 {
+ FreeAllUsageMaps();
  AddressSpaces.clear();
  RegGroups.clear();
 }
 
 
 
-AddressSpaceType::AddressSpaceType() : TotalBits(0), NP2Size(0), IsWave(false), WaveFormat(ASPACE_WFMT_UNSIGNED), WaveBits(0),
+AddressSpaceType::AddressSpaceType() : TotalBits(0), NP2Size(0), Wordbytes(1), Endianness(ENDIAN_LITTLE), PossibleSATB(false),
+				IsPalette(false), PaletteType(PALETTE_NONE), IsWave(false), WaveFormat(ASPACE_WFMT_UNSIGNED), WaveBits(0),
 				GetAddressSpaceBytes(NULL), PutAddressSpaceBytes(NULL), private_data(NULL), EnableUsageMap(NULL),
-				UsageMapRead(NULL), UsageMapWrite(NULL), UsageReadMemUsed(0), UsageWriteMemUsed(0), PossibleSATB(false),
-			       	Wordbytes(1), Endianness(ENDIAN_LITTLE), IsPalette(false), PaletteType(PALETTE_NONE)
+				UsageMapRead(NULL), UsageMapWrite(NULL), UsageMapExec(NULL)
 {
 
 }
@@ -157,137 +160,125 @@ int ASpace_Add(const AddressSpaceType &newt)
  return(AddressSpaces.size() - 1);
 }
 
-#if 0
-// Returns number of new bytes allocated.
-static INLINE uint64 IncUsageMap(uint64 *****UsageMap, const uint32 address)
+static AddressSpaceType* GetASpace(const int id)
 {
- uint64 ret = 0;
+ assert(id >= 0 && (unsigned int)id < AddressSpaces.size());
 
- if(!(*UsageMap))
- {
-  (*UsageMap) = (uint64 ****)MDFN_calloc(sizeof(uint64 ***), 256, "Usage map");
-  ret += sizeof(uint64 ***) * 256;
- }
+ return &AddressSpaces[id];
+}
 
- if(!(*UsageMap)[address >> 24])
- {
-  (*UsageMap)[address >> 24] = (uint64 ***)MDFN_calloc(sizeof(uint64 **), 256, "Usage map");
-  ret += sizeof(uint64 **) * 256;
- }
+static void FreeUsageMaps(AddressSpaceType* as)
+{
+ if(as->EnableUsageMap && as->UsageMapRead)
+  as->EnableUsageMap(NULL, NULL, NULL);
 
- if(!(*UsageMap)[address >> 24][(address >> 16) & 0xFF])
- {
-  (*UsageMap)[address >> 24][(address >> 16) & 0xFF] = (uint64 **)MDFN_calloc(sizeof(uint64 *), 256, "Usage map");
-  ret += sizeof(uint64 *) * 256;
- }
+ delete as->UsageMapRead;
+ as->UsageMapRead = NULL;
+
+ delete as->UsageMapWrite;
+ as->UsageMapWrite = NULL;
+
+ delete as->UsageMapExec;
+ as->UsageMapExec = NULL;
+}
 
- if(!(*UsageMap)[address >> 24][(address >> 16) & 0xFF][(address >> 8) & 0xFF])
+static void FreeAllUsageMaps(void)
+{
+ for(auto& as : AddressSpaces)
+  FreeUsageMaps(&as);
+}
+
+void ASpace_EnableUsageMap(const int id, const unsigned counter_bits)
+{
+ AddressSpaceType* as = GetASpace(id);
+
+ FreeUsageMaps(as);
+
+ if(counter_bits)
  {
-  (*UsageMap)[address >> 24][(address >> 16) & 0xFF][(address >> 8) & 0xFF] = (uint64 *)MDFN_calloc(sizeof(uint64), 256, "Usage map");
-  ret += sizeof(uint64) * 256;
+  try
+  {
+   as->UsageMapRead = new UsageMap(as->TotalBits, counter_bits);
+   as->UsageMapWrite = new UsageMap(as->TotalBits, counter_bits);
+   as->UsageMapExec = new UsageMap(as->TotalBits, counter_bits);
+  }
+  catch(...)
+  {
+   FreeUsageMaps(as);
+   throw;
+  }
+
+  if(as->EnableUsageMap)
+   as->EnableUsageMap(as->UsageMapRead, as->UsageMapWrite, as->UsageMapExec);
  }
+}
 
- (*UsageMap)[address >> 24][(address >> 16) & 0xFF][(address >> 8) & 0xFF][address & 0xFF]++;
+const UsageMap* ASpace_GetReadMap(const int id)
+{
+ return GetASpace(id)->UsageMapRead;
+}
 
- return(ret);
+const UsageMap* ASpace_GetWriteMap(const int id)
+{
+ return GetASpace(id)->UsageMapWrite;
 }
 
-bool ASpace_Read(const int id, const uint32 address, const unsigned int size, const bool pre_bpoint)
+const UsageMap* ASpace_GetExecMap(const int id)
 {
- AddressSpaceType *as;
+ return GetASpace(id)->UsageMapExec;
+}
 
- assert(id > 0 && (const unsigned int)id < AddressSpaces.size());
+bool ASpace_Read(const int id, const uint32 address, const unsigned int size, const bool pre_bpoint)
+{
+ AddressSpaceType* as = GetASpace(id);
 
- as = &AddressSpaces[id];
+ if(!pre_bpoint && as->UsageMapRead)
+  as->UsageMapRead->Inc(address, size);
 
- if(pre_bpoint)
-  return(false);
- else
- {
-  as->UsageReadMemUsed += IncUsageMap(&as->UsageMapRead, address);
- }
  return(false);
 }
 
 bool ASpace_Write(const int id, const uint32 address, const uint32 value, const unsigned int size, const bool pre_bpoint)
 {
- AddressSpaceType *as;
+ AddressSpaceType* as = GetASpace(id);
 
- assert(id > 0 && (const unsigned int)id < AddressSpaces.size());
+ if(!pre_bpoint && as->UsageMapWrite)
+  as->UsageMapWrite->Inc(address, size);
 
- as = &AddressSpaces[id];
-
- if(pre_bpoint)
-  return(false);
- else
- {
-  as->UsageWriteMemUsed += IncUsageMap(&as->UsageMapWrite, address);
-  return(false);
- }
+ return(false);
 }
 
-static INLINE void ClearUsageMap(uint64 *****UsageMap)
+void ASpace_Exec(const int id, const uint32 address, const unsigned int size)
 {
- // Maybe we should use an alloced memory vector to speed this up...
- if((*UsageMap))
- {
-  for(int a = 0; a < 256; a++)
-  {
-   if((*UsageMap)[a])
-   {   
-    for(int b = 0; b < 256; b++)
-    {
-     if((*UsageMap)[a][b])
-     {
-      for(int c = 0; c < 256; c++)
-      {
-       if((*UsageMap)[a][b][c])
-       {
-        MDFN_free((*UsageMap)[a][b][c]);
-        (*UsageMap)[a][b][c] = NULL;
-       }
-      }
-      MDFN_free((*UsageMap)[a][b]);
-      (*UsageMap)[a][b] = NULL;
-     }
-    }
-
-    MDFN_free((*UsageMap)[a]);
-    (*UsageMap)[a] = NULL;
-   }
-  }
+ AddressSpaceType* as = GetASpace(id);
 
-  MDFN_free((*UsageMap));
-  (*UsageMap) = NULL;
- }
+ if(as->UsageMapExec)
+  as->UsageMapExec->Inc(address, size);
 }
 
 void ASpace_ClearReadMap(const int id)
 {
- AddressSpaceType *as;
-
- assert(id > 0 && (const unsigned int)id < AddressSpaces.size());
+ AddressSpaceType* as = GetASpace(id);
 
- as = &AddressSpaces[id];
-
- ClearUsageMap(&as->UsageMapRead);
-
- as->UsageReadMemUsed = 0;
+ if(as->UsageMapRead)
+  as->UsageMapRead->Clear();
 }
 
 void ASpace_ClearWriteMap(const int id)
 {
- AddressSpaceType *as;
-
- assert(id > 0 && (const unsigned int)id < AddressSpaces.size());
+ AddressSpaceType* as = GetASpace(id);
 
- as = &AddressSpaces[id];
+ if(as->UsageMapWrite)
+  as->UsageMapWrite->Clear();
+}
 
- ClearUsageMap(&as->UsageMapWrite);
+void ASpace_ClearExecMap(const int id)
+{
+ AddressSpaceType* as = GetASpace(id);
 
- as->UsageWriteMemUsed = 0;
+ if(as->UsageMapExec)
+  as->UsageMapExec->Clear();
 }
-#endif
 
 void MDFNDBG_ResetRegGroupsInfo(void)
 {
@@ -301,6 +292,7 @@ void MDFNDBG_AddRegGroup(const RegGroupType* groupie)
 
 void ASpace_Reset(void)
 {
+ FreeAllUsageMaps();
  AddressSpaces.clear();
 }
 
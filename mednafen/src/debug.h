@@ -3,6 +3,8 @@
 
 #ifdef WANT_DEBUGGER
 
+#include "UsageMap.h"
+
 namespace Mednafen
 {
 
@@ -98,14 +100,15 @@ struct AddressSpaceType
 
 	void *private_data;
 
-	// Internal use...
-	void (*EnableUsageMap)(bool);
-
-	uint64 ****UsageMapRead;	// [a.24:31][a.16:23][a.8:15][a.0:7], pointer tables allocated as needed.
-	uint64 ****UsageMapWrite;	// (same)
+	// Called with the address space's read, write, and execute usage maps when they're enabled, and with NULL for all
+	// three when they're disabled, so that emulation code can count accesses directly instead of via ASpace_Read()
+	// and friends.  Optional.
+	void (*EnableUsageMap)(UsageMap* read_map, UsageMap* write_map, UsageMap* exec_map);
 
-	uint64 UsageReadMemUsed;	// Keep track of how much memory we've allocated for UsageMap, so we don't go kaka-kookoo and use up an 					// excessive amount of RAM.
-	uint64 UsageWriteMemUsed;
+	// Internal use...
+	UsageMap* UsageMapRead;
+	UsageMap* UsageMapWrite;
+	UsageMap* UsageMapExec;
 };
 
 // TODO: newer branch trace interface not implemented yet.
@@ -237,10 +240,22 @@ void ASpace_Reset(void);
 // true if the "estimated" read/write matches a registered breakpoint.
 bool ASpace_Read(const int id, const uint32 address, const unsigned int size = 1, const bool pre_bpoint = false);
 bool ASpace_Write(const int id, const uint32 address, const uint32 value, const unsigned int size = 1, const bool pre_bpoint = false);
+void ASpace_Exec(const int id, const uint32 address, const unsigned int size = 1);
+
+// Enables counting of reads, writes, and instruction fetches with saturating counters of 'counter_bits'(8 or 16)
+// bits per address, or disables it and frees the usage maps if 'counter_bits' is 0.  Any existing counts are
+// discarded either way.
+void ASpace_EnableUsageMap(const int id, const unsigned counter_bits);
+
+// Returns NULL if usage maps aren't enabled for the address space.
+const UsageMap* ASpace_GetReadMap(const int id);
+const UsageMap* ASpace_GetWriteMap(const int id);
+const UsageMap* ASpace_GetExecMap(const int id);
 
-// Clears read/write usage maps.
+// Clears read/write/execute usage maps.
 void ASpace_ClearReadMap(const int id);
 void ASpace_ClearWriteMap(const int id);
+void ASpace_ClearExecMap(const int id);
 
 
 void ASpace_AddBreakPoint(const int id, const int type, const uint32 A1, const uint32 A2, const bool logical);
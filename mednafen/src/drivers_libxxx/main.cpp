@@ -1,4 +1,855 @@
-int main(int argc, char* argv[])
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* main.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// Headless batch-run front end.  Loads a game, runs a fixed number of frames as fast as the emulation core
+// allows(no video output, no sound device, no throttling), and writes per-frame video/audio hashes, screenshots
+// and run statistics to disk.  Intended for automated regression runs, where many instances run in parallel.
+//
+// Usage:
+//	mednafen [-option value]... [-setting value]... <game path>
+//
+//	-frames N		Number of frames to emulate(default 600).
+//	-hashlog path		Write "frame video_md5 audio_md5" lines, one per frame.
+//	-golden path		Compare each frame's hashes against a hash log from an earlier run, and stop at the first
+//				frame that differs(exit status 2; see "diverged_*" in the run statistics).  Unless -frames is
+//				specified, runs as many frames as the hash log has.
+//	-rawsnap path		Write the last frame emulated as raw 8-bit RGB, after 32-bit little-endian width and height.
+//	-snapdir path		Directory to write PNG screenshots to; the last frame is always saved when set.
+//	-snapinterval N		Also save a screenshot every N frames(default 0, disabled).
+//	-stats path		Write run statistics, as "key value" lines.
+//	-movie path		Play back input from a movie file.
+//	-soundrate N		Sound output rate to emulate and hash at; 0 disables sound(default 48000).
+//	-force_module name	Force the use of the specified emulation module.
+//	-throttle 0/1		Run no faster than the emulated system would in real time(default 0).
+//	-rollback_host port	Start a rollback netplay session, waiting for the remote peer on the specified port.
+//	-rollback_connect host:port	Start a rollback netplay session with the remote peer at host:port.
+//	-benchmark path		Profile emulation, and write a JSON report of frame times and time spent per subsystem to the
+//				specified path("-" for stdout).  If no game path is specified, a bundled synthetic PC Engine
+//				program is run.
+//
+// Any other "-name value" pair is passed through to MDFNI_SetSetting().  Settings are loaded from the base
+// directory, but never saved, and no lock file is taken, so concurrent instances may share a base directory.
+//
+//	mednafen -pcetracedump <trace path>
+//
+// Writes a PC Engine CPU trace(see the "pce.cputrace" setting) to stdout as text, one line per instruction.
+//
+//	mednafen -pcecoveragemerge <output path> <coverage path>...
+//
+// Merges PC Engine ROM coverage files(see the "pce.coverage" setting) from separate runs into one, and writes totals
+// to stdout.  The output path may also be one of the inputs.
+//
+//	mednafen -pcecoveragedump <coverage path>
+//
+// Writes a per-bank summary of a PC Engine ROM coverage file, and the ROM offset ranges executed, to stdout as text.
+//
+//	mednafen -regress <manifest path> [-jobs N] [-outdir path] [-reference path] [-update 0/1]
+//
+// Runs a regression test suite in parallel worker processes; see regress.h.
+
+#include <mednafen/mednafen.h>
+#include <mednafen/driver.h>
+#include <mednafen/state-driver.h>
+#include <mednafen/movie-driver.h>
+#include <mednafen/netplay-driver.h>
+#include <mednafen/NativeVFS.h>
+#include <mednafen/FileStream.h>
+#include <mednafen/Time.h>
+#include <mednafen/string/string.h>
+#include <mednafen/hash/md5.h>
+#include <mednafen/video/png.h>
+#include <mednafen/profile.h>
+#ifdef WANT_PCE_EMU
+#include <mednafen/pce/cputrace.h>
+#include <mednafen/pce/coverage.h>
+#endif
+
+#include <trio/trio.h>
+#include <signal.h>
+
+#include "synthetic.h"
+#include "regress.h"
+
+using namespace Mednafen;
+
+static volatile bool NeedExitNow = false;
+
+void Mednafen::MDFND_OutputNotice(MDFN_NoticeType t, const char* s) noexcept
+{
+ if(t == MDFN_NOTICE_STATUS)
+  return;
+
+ fputs(s, stderr);
+ fputc('\n', stderr);
+ fflush(stderr);
+}
+
+void Mednafen::MDFND_OutputInfo(const char* s) noexcept
+{
+ fputs(s, stdout);
+}
+
+//
+// Nothing to synchronize to, and input only ever changes between frames(via movie playback), so there's
+// nothing to do here.
+//
+void Mednafen::MDFND_MidSync(EmulateSpecStruct* espec, const unsigned flags)
+{
+
+}
+
+bool Mednafen::MDFND_CheckNeedExit(void)
+{
+ return NeedExitNow;
+}
+
+void Mednafen::MDFND_MediaSetNotification(uint32 drive_idx, uint32 state_idx, uint32 media_idx, uint32 orientation_idx)
+{
+
+}
+
+void Mednafen::MDFND_NetplayText(const char* text, bool NetEcho)
+{
+ fputs(text, stderr);
+ fputc('\n', stderr);
+ fflush(stderr);
+}
+
+void Mednafen::MDFND_NetplaySetHints(bool active, bool behind, uint32 local_players_mask)
+{
+
+}
+
+void Mednafen::MDFND_SetStateStatus(StateStatusStruct* status) noexcept
+{
+ delete status;
+}
+
+void Mednafen::MDFND_SetMovieStatus(StateStatusStruct* status) noexcept
+{
+ delete status;
+}
+
+//
+// Driver-side hooks that the PCE and PC-FX debuggers call directly.  There's only one surface here, reused every
+// frame, so it always already holds the previous frame's lines, and there's no interactive debugger to break into.
+//
+bool DebugHSyncFlag = false;
+bool DebugVSyncFlag = false;
+
+void InitScanLine(uint32 y)
+{
+
+}
+
+bool IsVSYNCBreakPoint(void)
+{
+ DebugVSyncFlag = false;
+
+ return false;
+}
+
+bool IsHSYNCBreakPoint(void)
+{
+ DebugHSyncFlag = false;
+
+ return false;
+}
+
+static std::string GetBaseDirectory(void)
+{
+ const char* ol;
+
+ ol = getenv("MEDNAFEN_HOME");
+ if(ol != NULL && ol[0] != 0)
+  return std::string(ol);
+
+ ol = getenv("HOME");
+ if(ol)
+  return std::string(ol) + PSS + ".mednafen";
+
+ return ".";
+}
+
+struct RunOptions
+{
+ std::string game_path;
+ std::string force_module;
+ std::string hashlog_path;
+ std::string golden_path;
+ std::string rawsnap_path;
+ std::string snap_dir;
+ std::string stats_path;
+ std::string movie_path;
+ std::string rollback_connect;
+ std::string benchmark_path;
+ unsigned rollback_host = 0;
+ bool throttle = false;
+ uint64 frames = 600;
+ bool frames_set = false;
+ uint64 snap_interval = 0;
+ uint32 sound_rate = 48000;
+ bool synthetic = false;	// Running the bundled synthetic benchmark program.
+};
+
+static uint64 ParseUInt(const char* name, const char* value)
+{
+ char* endptr = nullptr;
+ const unsigned long long ret = strtoull(value, &endptr, 10);
+
+ if(!value[0] || *endptr)
+  throw MDFN_Error(0, _("Invalid value \"%s\" for option \"%s\"."), value, name);
+
+ return ret;
+}
+
+static bool ParseArgs(int argc, char* argv[], RunOptions* ro)
 {
+ for(int i = 1; i < argc; i++)
+ {
+  const char* arg = argv[i];
+
+  if(arg[0] == '-' && arg[1] != 0)
+  {
+   const char* name = arg + 1 + (arg[1] == '-');
+
+   if((i + 1) >= argc)
+   {
+    MDFN_Notify(MDFN_NOTICE_ERROR, _("Option \"%s\" requires an argument."), arg);
+    return false;
+   }
+
+   const char* value = argv[++i];
+
+   if(!strcmp(name, "frames"))
+   {
+    ro->frames = ParseUInt(name, value);
+    ro->frames_set = true;
+   }
+   else if(!strcmp(name, "hashlog"))
+    ro->hashlog_path = value;
+   else if(!strcmp(name, "golden"))
+    ro->golden_path = value;
+   else if(!strcmp(name, "rawsnap"))
+    ro->rawsnap_path = value;
+   else if(!strcmp(name, "snapdir"))
+    ro->snap_dir = value;
+   else if(!strcmp(name, "snapinterval"))
+    ro->snap_interval = ParseUInt(name, value);
+   else if(!strcmp(name, "stats"))
+    ro->stats_path = value;
+   else if(!strcmp(name, "movie"))
+    ro->movie_path = value;
+   else if(!strcmp(name, "soundrate"))
+    ro->sound_rate = ParseUInt(name, value);
+   else if(!strcmp(name, "force_module"))
+    ro->force_module = value;
+   else if(!strcmp(name, "throttle"))
+    ro->throttle = ParseUInt(name, value);
+   else if(!strcmp(name, "rollback_host"))
+    ro->rollback_host = ParseUInt(name, value);
+   else if(!strcmp(name, "rollback_connect"))
+    ro->rollback_connect = value;
+   else if(!strcmp(name, "benchmark"))
+    ro->benchmark_path = value;
+   else if(!MDFNI_SetSetting(name, value))
+    return false;
+  }
+  else if(ro->game_path.size())
+  {
+   MDFN_Notify(MDFN_NOTICE_ERROR, _("Unexpected argument \"%s\"; only one game path may be specified."), arg);
+   return false;
+  }
+  else
+   ro->game_path = arg;
+ }
+
+ if(!ro->game_path.size() && !ro->benchmark_path.size())
+ {
+  MDFN_Notify(MDFN_NOTICE_ERROR, _("No game path specified."));
+  return false;
+ }
+
+ return true;
+}
+
+static void HashVideo(md5_hasher* h, const EmulateSpecStruct& espec)
+{
+ const MDFN_Surface* surf = espec.surface;
+ const MDFN_Rect& dr = espec.DisplayRect;
+
+ h->process_scalar<int32>(dr.w);
+ h->process_scalar<int32>(dr.h);
+
+ for(int32 y = 0; y < dr.h; y++)
+ {
+  const int32 w = (espec.LineWidths[0] == ~0) ? dr.w : espec.LineWidths[dr.y + y];
+
+  h->process(surf->pix<uint32>() + (dr.y + y) * surf->pitchinpix + dr.x, w * sizeof(uint32));
+ }
+}
+
+// Returns true if every displayed pixel is the same color.
+static bool IsBlankFrame(const EmulateSpecStruct& espec)
+{
+ const MDFN_Surface* surf = espec.surface;
+ const MDFN_Rect& dr = espec.DisplayRect;
+ const uint32 first = surf->pix<uint32>()[dr.y * surf->pitchinpix + dr.x];
+
+ for(int32 y = 0; y < dr.h; y++)
+ {
+  const int32 w = (espec.LineWidths[0] == ~0) ? dr.w : espec.LineWidths[dr.y + y];
+  const uint32* row = surf->pix<uint32>() + (dr.y + y) * surf->pitchinpix + dr.x;
+
+  for(int32 x = 0; x < w; x++)
+  {
+   if(row[x] != first)
+    return false;
+  }
+ }
+
+ return true;
+}
+
+static void SaveSnapshot(const RunOptions& ro, const uint64 frame, const EmulateSpecStruct& espec)
+{
+ char fn[64];
+
+ trio_snprintf(fn, sizeof(fn), "%08llu.png", (unsigned long long)frame);
+
+ PNGWrite(ro.snap_dir + PSS + fn, espec.surface, espec.DisplayRect, espec.LineWidths);
+}
+
+static void SaveRawSnapshot(const std::string& path, const EmulateSpecStruct& espec)
+{
+ const MDFN_Surface* surf = espec.surface;
+ const MDFN_Rect& dr = espec.DisplayRect;
+ int32 w = dr.w;
+ FileStream fp(path, FileStream::MODE_WRITE);
+ uint8 header[8];
+ std::vector<uint8> line;
+
+ if(espec.LineWidths[0] != ~0)
+ {
+  for(int32 y = 0; y < dr.h; y++)
+   w = std::max<int32>(w, espec.LineWidths[dr.y + y]);
+ }
+
+ MDFN_en32lsb(&header[0], w);
+ MDFN_en32lsb(&header[4], dr.h);
+ fp.write(header, sizeof(header));
+
+ line.resize(w * 3);
+
+ for(int32 y = 0; y < dr.h; y++)
+ {
+  const int32 lw = (espec.LineWidths[0] == ~0) ? dr.w : espec.LineWidths[dr.y + y];
+  const uint32* row = surf->pix<uint32>() + (dr.y + y) * surf->pitchinpix + dr.x;
+
+  memset(line.data(), 0, line.size());
+
+  for(int32 x = 0; x < lw; x++)
+  {
+   int r, g, b;
+
+   surf->format.DecodeColor(row[x], r, g, b);
+   line[x * 3 + 0] = r;
+   line[x * 3 + 1] = g;
+   line[x * 3 + 2] = b;
+  }
+
+  fp.write(line.data(), line.size());
+ }
+
+ fp.close();
+}
+
+// Loads the "video_md5 audio_md5" part of each hash log line, indexed by frame.
+static std::vector<std::string> LoadHashLog(const std::string& path)
+{
+ FileStream fp(path, FileStream::MODE_READ);
+ std::vector<std::string> ret;
+ std::string line;
+
+ while(fp.get_line(line) >= 0)
+ {
+  unsigned long long frame;
+  char vh[33], ah[33];
+
+  if(!line.size())
+   continue;
+
+  if(trio_sscanf(line.c_str(), "%llu %32s %32s", &frame, vh, ah) != 3 || frame != ret.size())
+   throw MDFN_Error(0, _("Malformed hash log \"%s\" at frame %llu."), path.c_str(), (unsigned long long)ret.size());
+
+  ret.push_back(std::string(vh) + " " + ah);
+ }
+
+ return ret;
+}
+
+static std::string JSONEscape(const std::string& str)
+{
+ std::string ret;
+
+ for(const char c : str)
+ {
+  if(c == '"' || c == '\\')
+  {
+   ret.push_back('\\');
+   ret.push_back(c);
+  }
+  else if((unsigned char)c < 0x20)
+  {
+   char tmp[8];
+
+   trio_snprintf(tmp, sizeof(tmp), "\\u%04x", (unsigned char)c);
+   ret += tmp;
+  }
+  else
+   ret.push_back(c);
+ }
+
+ return ret;
+}
+
+// Nearest-rank percentile of sorted 'v'.
+static int64 Percentile(const std::vector<int64>& v, const unsigned pct)
+{
+ if(!v.size())
+  return 0;
+
+ return v[std::min<size_t>(v.size() - 1, ((uint64)v.size() * pct + 99) / 100 - (pct != 0))];
+}
+
+static void WriteBenchmarkReport(const RunOptions& ro, const MDFNGI* gi, std::vector<int64> frame_ns, const double emu_seconds)
+{
+ int64 zone_ns[PROFZONE__COUNT];
+ int64 total_ns = 0;
+ int64 other_ns;
+
+ MDFNPROF_GetZoneTimes(zone_ns);
+
+ for(const int64 ns : frame_ns)
+  total_ns += ns;
+
+ total_ns = std::max<int64>(1, total_ns);
+ std::sort(frame_ns.begin(), frame_ns.end());
+ //
+ // Time outside of all zones is partly driver-side(hashing, screenshots, etc.), so what's reported as "other" is
+ // instead the time spent in MDFNI_Emulate() not accounted to any subsystem.
+ //
+ other_ns = total_ns;
+ for(unsigned z = PROFZONE_NONE + 1; z < PROFZONE__COUNT; z++)
+  other_ns -= zone_ns[z];
+ zone_ns[PROFZONE_NONE] = std::max<int64>(0, other_ns);
+
+ std::string json;
+ char buf[256];
+
+ json += "{\n";
+ json += " \"module\": \"" + JSONEscape(gi->shortname) + "\",\n";
+ json += " \"game\": \"" + JSONEscape(ro.game_path) + "\",\n";
+ json += " \"movie\": \"" + JSONEscape(ro.movie_path) + "\",\n";
+ trio_snprintf(buf, sizeof(buf), " \"frames\": %llu,\n", (unsigned long long)frame_ns.size());
+ json += buf;
+ trio_snprintf(buf, sizeof(buf), " \"emulated_seconds\": %.6f,\n", emu_seconds);
+ json += buf;
+ trio_snprintf(buf, sizeof(buf), " \"elapsed_seconds\": %.6f,\n", total_ns / 1000000000.0);
+ json += buf;
+ trio_snprintf(buf, sizeof(buf), " \"fps\": %.3f,\n", frame_ns.size() * 1000000000.0 / total_ns);
+ json += buf;
+ trio_snprintf(buf, sizeof(buf), " \"realtime_ratio\": %.3f,\n", emu_seconds * 1000000000.0 / total_ns);
+ json += buf;
+ trio_snprintf(buf, sizeof(buf), " \"frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+	total_ns / 1000000.0 / std::max<size_t>(1, frame_ns.size()), Percentile(frame_ns, 50) / 1000000.0, Percentile(frame_ns, 99) / 1000000.0, Percentile(frame_ns, 100) / 1000000.0);
+ json += buf;
+ json += " \"subsystems\":\n {\n";
+ for(unsigned z = 0; z < PROFZONE__COUNT; z++)
+ {
+  const unsigned zz = (z + 1) % PROFZONE__COUNT;	// "other" last.
+
+  trio_snprintf(buf, sizeof(buf), "  \"%s\": { \"ms\": %.3f, \"percent\": %.2f }%s\n", (zz == PROFZONE_NONE) ? "other" : MDFNPROF_GetZoneName(zz), zone_ns[zz] / 1000000.0, zone_ns[zz] * 100.0 / total_ns, (zz == PROFZONE_NONE) ? "" : ",");
+  json += buf;
+ }
+ json += " }\n";
+ json += "}\n";
+
+ if(ro.benchmark_path == "-")
+ {
+  fputs(json.c_str(), stdout);
+  fflush(stdout);
+ }
+ else
+ {
+  FileStream bf(ro.benchmark_path, FileStream::MODE_WRITE);
+
+  bf.write(json.data(), json.size());
+  bf.close();
+ }
+}
+
+static int Run(const RunOptions& ro)
+{
+ MDFNGI* gi;
+
+ if(!(gi = MDFNI_LoadGame(ro.force_module.size() ? ro.force_module.c_str() : nullptr, &NVFS, ro.game_path.c_str())))
+  return -1;
+
+ for(unsigned port = 0; port < gi->PortInfo.size(); port++)
+ {
+  const InputPortInfoStruct& ipi = gi->PortInfo[port];
+  unsigned device = 0;
+
+  for(unsigned d = 0; d < ipi.DeviceInfo.size(); d++)
+  {
+   if(ipi.DefaultDevice && !strcmp(ipi.DeviceInfo[d].ShortName, ipi.DefaultDevice))
+    device = d;
+  }
+
+  MDFNI_SetInput(port, device);
+ }
+
+ // Put the default medium(e.g. the first disc of a CD game) in each drive, like the full frontend does.
+ for(unsigned d = 0; d < gi->RMD->Drives.size(); d++)
+ {
+  const RMD_DriveDefaults& dd = gi->RMD->DrivesDefaults[d];
+
+  MDFNI_SetMedia(d, dd.State, dd.Media, dd.Orientation);
+ }
+
+ if(ro.movie_path.size())
+ {
+  std::string mp = ro.movie_path;
+
+  MDFNI_LoadMovie(&mp[0]);
+ }
+
+ if(ro.rollback_host)
+  MDFNI_RollbackHost(ro.rollback_host);
+ else if(ro.rollback_connect.size())
+ {
+  const size_t colon = ro.rollback_connect.rfind(':');
+
+  if(colon == std::string::npos)
+   throw MDFN_Error(0, _("Rollback netplay peer address \"%s\" is missing a port number."), ro.rollback_connect.c_str());
+
+  MDFNI_RollbackConnect(ro.rollback_connect.substr(0, colon).c_str(), ParseUInt("rollback_connect", ro.rollback_connect.c_str() + colon + 1));
+ }
+
+ std::unique_ptr<MDFN_Surface> surface(new MDFN_Surface(NULL, gi->fb_width, gi->fb_height, gi->fb_width, MDFN_PixelFormat::ABGR32_8888));
+ std::unique_ptr<int32[]> lw(new int32[gi->fb_height]);
+ std::unique_ptr<int16[]> sbuf;
+ const int32 sbuf_max = ro.sound_rate / 2;
+ std::unique_ptr<FileStream> hashlog;
+ uint64 emu_cycles = 0;
+ uint64 audio_frames = 0;
+ uint64 frame_us_max = 0;
+ uint64 frame;
+ std::vector<int64> frame_ns;
+ std::vector<std::string> golden;
+ uint64 frames = ro.frames;
+ int64 diverged_frame = -1;
+ const char* diverged_what = nullptr;
+
+ if(ro.golden_path.size())
+ {
+  golden = LoadHashLog(ro.golden_path);
+
+  if(!ro.frames_set)
+   frames = golden.size();
+ }
+
+ if(ro.sound_rate)
+  sbuf.reset(new int16[sbuf_max * gi->soundchan]);
+
+ if(ro.hashlog_path.size())
+  hashlog.reset(new FileStream(ro.hashlog_path, FileStream::MODE_WRITE));
+
+ if(ro.snap_dir.size())
+  NVFS.create_missing_dirs(ro.snap_dir + PSS);
+
+ // Modules that don't use per-line widths(e.g. cdplay) never write them, so start out with "no per-line widths", like the
+ // full frontend does.
+ memset(lw.get(), 0, sizeof(int32) * gi->fb_height);
+ lw[0] = ~0;
+
+ if(ro.benchmark_path.size())
+ {
+  frame_ns.reserve(ro.frames);
+  MDFNPROF_Start();
+ }
+
+ const int64 start_time = Time::MonoUS();
+
+ for(frame = 0; frame < frames && !NeedExitNow; frame++)
+ {
+  const bool need_snap = ro.snap_dir.size() && ((frame + 1) == frames || (ro.snap_interval && !((frame + 1) % ro.snap_interval)));
+  const bool need_hash = hashlog || ro.golden_path.size();
+  EmulateSpecStruct espec;
+
+  espec.surface = surface.get();
+  espec.LineWidths = lw.get();
+  espec.skip = !(need_hash || need_snap || ((ro.rawsnap_path.size() || ro.synthetic) && (frame + 1) == frames));
+  espec.SoundRate = ro.sound_rate;
+  espec.SoundBuf = sbuf.get();
+  espec.SoundBufMaxSize = sbuf ? sbuf_max : 0;
+
+  const int64 frame_start_time = Time::MonoNS();
+
+  MDFNI_Emulate(&espec);
+
+  const int64 frame_time = Time::MonoNS() - frame_start_time;
+
+  frame_us_max = std::max<uint64>(frame_us_max, frame_time / 1000);
+
+  if(ro.benchmark_path.size())
+   frame_ns.push_back(frame_time);
+  emu_cycles += espec.MasterCycles;
+  audio_frames += espec.SoundBufSize;
+
+  if(need_hash)
+  {
+   md5_hasher vh, ah;
+   md5_digest vd, ad;
+   std::string vs, as;
+
+   HashVideo(&vh, espec);
+   ah.process(espec.SoundBuf, espec.SoundBufSize * gi->soundchan * sizeof(int16));
+   vd = vh.digest();
+   ad = ah.digest();
+   vs = md5_context::asciistr(&vd[0], false);
+   as = md5_context::asciistr(&ad[0], false);
+
+   if(hashlog)
+    hashlog->print_format("%llu %s %s\n", (unsigned long long)frame, vs.c_str(), as.c_str());
+
+   if(ro.golden_path.size())
+   {
+    if(frame >= golden.size())
+     diverged_what = "missing";
+    else if(golden[frame].compare(0, 32, vs))
+     diverged_what = "video";
+    else if(golden[frame].compare(33, 32, as))
+     diverged_what = "audio";
+   }
+  }
+
+  if(need_snap || (diverged_what && ro.snap_dir.size()))
+   SaveSnapshot(ro, frame, espec);
+
+  if(diverged_what)
+  {
+   diverged_frame = frame;
+
+   if(ro.rawsnap_path.size())
+    SaveRawSnapshot(ro.rawsnap_path, espec);
+
+   frame++;
+   break;
+  }
+
+  if(ro.rawsnap_path.size() && (frame + 1) == frames)
+   SaveRawSnapshot(ro.rawsnap_path, espec);
+
+  //
+  // The synthetic program draws noise over the whole screen, so a blank last frame means it isn't running as
+  // intended(e.g. no VDC interrupts), and the results would be meaningless.
+  //
+  if(ro.synthetic && (frame + 1) == frames && IsBlankFrame(espec))
+   throw MDFN_Error(0, _("The synthetic benchmark program displayed a blank screen on its last frame."));
+
+  if(ro.throttle)
+  {
+   const int64 ahead_us = (int64)((double)emu_cycles * MDFN_MASTERCLOCK_FIXED(1) / gi->MasterClock * 1000000) - (Time::MonoUS() - start_time);
+
+   if(ahead_us >= 1000)
+    Time::SleepMS(ahead_us / 1000);
+  }
+ }
+
+ const int64 elapsed_us = std::max<int64>(1, Time::MonoUS() - start_time);
+ const double emu_seconds = (double)emu_cycles * MDFN_MASTERCLOCK_FIXED(1) / gi->MasterClock;
+
+ if(hashlog)
+  hashlog->close();
+
+ if(ro.benchmark_path.size())
+ {
+  WriteBenchmarkReport(ro, gi, std::move(frame_ns), emu_seconds);
+  MDFNPROF_Stop();
+ }
+
+ MDFN_printf(_("Emulated %llu frames(%.3f seconds) in %.3f seconds; %.2f frames per second, %.2fx real time.\n"), (unsigned long long)frame, emu_seconds, elapsed_us / 1000000.0, frame * 1000000.0 / elapsed_us, emu_seconds * 1000000.0 / elapsed_us);
+
+ if(ro.stats_path.size())
+ {
+  FileStream sf(ro.stats_path, FileStream::MODE_WRITE);
+
+  sf.print_format("module %s\n", gi->shortname);
+  sf.print_format("frames %llu\n", (unsigned long long)frame);
+  sf.print_format("elapsed_us %lld\n", (long long)elapsed_us);
+  sf.print_format("frame_us_max %llu\n", (unsigned long long)frame_us_max);
+  sf.print_format("fps %.3f\n", frame * 1000000.0 / elapsed_us);
+  sf.print_format("emulated_seconds %.6f\n", emu_seconds);
+  sf.print_format("audio_frames %llu\n", (unsigned long long)audio_frames);
+
+  if(diverged_what)
+  {
+   sf.print_format("diverged_frame %lld\n", (long long)diverged_frame);
+   sf.print_format("diverged %s\n", diverged_what);
+  }
+  sf.close();
+ }
+
+ MDFNI_NetplayDisconnect();
+ MDFNI_CloseGame();
+
+ if(diverged_what)
+ {
+  MDFN_Notify(MDFN_NOTICE_ERROR, _("Frame %lld differs from \"%s\"(%s)."), (long long)diverged_frame, ro.golden_path.c_str(), diverged_what);
+  return 2;
+ }
+
  return 0;
 }
+
+static void CloseHandler(int signum)
+{
+ NeedExitNow = true;
+}
+
+// Handled before initialization, so nothing else ends up in the output.
+static int DumpPCETrace(const char* path)
+{
+ try
+ {
+#ifdef WANT_PCE_EMU
+  MDFN_IEN_PCE::CPUTrace_Dump(path, stdout);
+  return 0;
+#else
+  throw MDFN_Error(0, _("PC Engine emulation is not enabled in this build."));
+#endif
+ }
+ catch(std::exception& e)
+ {
+  MDFND_OutputNotice(MDFN_NOTICE_ERROR, e.what());
+  return -1;
+ }
+}
+
+static int MergePCECoverage(const char* out_path, int count, char* in_paths[])
+{
+ try
+ {
+#ifdef WANT_PCE_EMU
+  MDFN_IEN_PCE::PCECoverage_Merge(out_path, std::vector<std::string>(in_paths, in_paths + count), stdout);
+  return 0;
+#else
+  throw MDFN_Error(0, _("PC Engine emulation is not enabled in this build."));
+#endif
+ }
+ catch(std::exception& e)
+ {
+  MDFND_OutputNotice(MDFN_NOTICE_ERROR, e.what());
+  return -1;
+ }
+}
+
+static int DumpPCECoverage(const char* path)
+{
+ try
+ {
+#ifdef WANT_PCE_EMU
+  MDFN_IEN_PCE::PCECoverage_Dump(path, stdout);
+  return 0;
+#else
+  throw MDFN_Error(0, _("PC Engine emulation is not enabled in this build."));
+#endif
+ }
+ catch(std::exception& e)
+ {
+  MDFND_OutputNotice(MDFN_NOTICE_ERROR, e.what());
+  return -1;
+ }
+}
+
+int main(int argc, char* argv[])
+{
+ RunOptions ro;
+ int ret = -1;
+
+ if(argc == 3 && !strcmp(argv[1], "-pcetracedump"))
+  return DumpPCETrace(argv[2]);
+
+ if(argc >= 4 && !strcmp(argv[1], "-pcecoveragemerge"))
+  return MergePCECoverage(argv[2], argc - 3, argv + 3);
+
+ if(argc == 3 && !strcmp(argv[1], "-pcecoveragedump"))
+  return DumpPCECoverage(argv[2]);
+
+ if(argc >= 3 && !strcmp(argv[1], "-regress"))
+  return RunRegression(argv[0], argv[2], argc - 3, argv + 3);
+
+ if(!MDFNI_Init())
+  return -1;
+
+ const std::string basedir = GetBaseDirectory();
+
+ if(!MDFNI_InitFinalize(basedir.c_str()))
+  return -1;
+
+ try
+ {
+  NVFS.create_missing_dirs(basedir + PSS);
+
+  if(!MDFNI_LoadSettings((basedir + PSS + "mednafen.cfg").c_str()))
+   throw MDFN_Error(0, _("Error loading settings."));
+
+  if(ParseArgs(argc, argv, &ro))
+  {
+   if(!ro.game_path.size())
+   {
+    ro.game_path = basedir + PSS + "benchmark-synthetic.pce";
+    WriteSyntheticPCE(ro.game_path);
+    ro.synthetic = true;
+
+    if(!ro.force_module.size())
+     ro.force_module = "pce";
+   }
+
+   signal(SIGINT, CloseHandler);
+   signal(SIGTERM, CloseHandler);
+
+   ret = Run(ro);
+  }
+ }
+ catch(std::exception& e)
+ {
+  MDFND_OutputNotice(MDFN_NOTICE_ERROR, e.what());
+  ret = -1;
+ }
+
+ MDFNI_Kill();
+
+ return ret;
+}
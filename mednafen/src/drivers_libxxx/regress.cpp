@@ -0,0 +1,558 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* regress.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <mednafen/mednafen.h>
+#include <mednafen/NativeVFS.h>
+#include <mednafen/FileStream.h>
+#include <mednafen/string/string.h>
+#include <mednafen/video/png.h>
+
+#include <trio/trio.h>
+
+#include <deque>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#ifdef HAVE_FORK
+#include <sys/wait.h>
+#endif
+
+#include "regress.h"
+
+using namespace Mednafen;
+
+namespace
+{
+
+struct RegressTest
+{
+ std::string name;
+ std::string game_path;
+ std::string golden_path;
+ std::vector<std::string> args;
+
+ enum { PENDING, PASS, FAIL, ERROR };
+ int result = PENDING;
+ int64 diverged_frame = -1;
+ std::string diverged;
+ std::string error;
+};
+
+struct RegressJob
+{
+ size_t test;
+ bool reference;
+};
+
+struct RegressOptions
+{
+ std::string manifest_dir;
+ std::string out_dir;
+ std::string self_path;
+ std::string reference_path;
+ unsigned jobs = 0;
+ bool update = false;
+};
+
+}
+
+static std::string GetCWD(void)
+{
+ std::vector<char> buf(4096);
+
+ while(!getcwd(buf.data(), buf.size()))
+ {
+  ErrnoHolder ene(errno);
+
+  if(ene.Errno() != ERANGE)
+   throw MDFN_Error(ene.Errno(), _("Error getting current working directory: %s"), ene.StrError());
+
+  buf.resize(buf.size() * 2);
+ }
+
+ return buf.data();
+}
+
+// The worker processes run in the manifest's directory, so paths given on the command line are made absolute first.
+static std::string MakeAbsolute(const std::string& path)
+{
+ if(NVFS.is_absolute_path(path))
+  return path;
+
+ return NVFS.eval_fip(GetCWD(), path, true);
+}
+
+static std::string GetSelfPath(const char* argv0)
+{
+ char buf[4096];
+ const ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+
+ if(len > 0)
+  return std::string(buf, len);
+
+ if(!strchr(argv0, '/'))
+  throw MDFN_Error(0, _("Unable to determine the path to this executable; run it with a path(e.g. \"./mednafen\")."));
+
+ return MakeAbsolute(argv0);
+}
+
+static std::vector<RegressTest> LoadManifest(const std::string& path)
+{
+ FileStream fp(path, FileStream::MODE_READ);
+ std::vector<RegressTest> ret;
+ std::string line;
+ unsigned line_num = 0;
+
+ while(fp.get_line(line) >= 0)
+ {
+  std::vector<std::string> fields;
+
+  line_num++;
+  MDFN_trim(&line);
+
+  if(!line.size() || line[0] == '#')
+   continue;
+
+  fields = MDFN_strargssplit(line);
+
+  if(fields.size() < 3 || ((fields.size() - 3) & 1))
+   throw MDFN_Error(0, _("Malformed regression manifest \"%s\" line %u."), path.c_str(), line_num);
+
+  for(auto const& t : ret)
+  {
+   if(t.name == fields[0])
+    throw MDFN_Error(0, _("Duplicate test name \"%s\" in regression manifest \"%s\" line %u."), fields[0].c_str(), path.c_str(), line_num);
+  }
+
+  ret.emplace_back();
+  ret.back().name = fields[0];
+  ret.back().game_path = fields[1];
+  ret.back().golden_path = fields[2];
+  ret.back().args.assign(fields.begin() + 3, fields.end());
+ }
+
+ return ret;
+}
+
+// Returns the "key value" pairs of a worker's run statistics file.
+static std::map<std::string, std::string> LoadStats(const std::string& path)
+{
+ std::map<std::string, std::string> ret;
+ FileStream fp(path, FileStream::MODE_READ);
+ std::string line;
+
+ while(fp.get_line(line) >= 0)
+ {
+  const size_t sp = line.find(' ');
+
+  if(sp != std::string::npos)
+   ret[line.substr(0, sp)] = line.substr(sp + 1);
+ }
+
+ return ret;
+}
+
+#ifdef HAVE_FORK
+static pid_t SpawnWorker(const std::vector<std::string>& args, const std::string& cwd, const std::string& log_path)
+{
+ std::vector<char*> argv;
+ int log_fd;
+ pid_t pid;
+
+ for(auto const& a : args)
+  argv.push_back(const_cast<char*>(a.c_str()));
+
+ argv.push_back(nullptr);
+
+ if((log_fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666)) == -1)
+ {
+  ErrnoHolder ene(errno);
+
+  throw MDFN_Error(ene.Errno(), _("Error opening \"%s\": %s"), log_path.c_str(), ene.StrError());
+ }
+
+ if((pid = fork()) == -1)
+ {
+  ErrnoHolder ene(errno);
+
+  close(log_fd);
+  throw MDFN_Error(ene.Errno(), _("fork() failed: %s"), ene.StrError());
+ }
+
+ if(!pid)
+ {
+  dup2(log_fd, STDOUT_FILENO);
+  dup2(log_fd, STDERR_FILENO);
+  close(log_fd);
+
+  if(chdir(cwd.c_str()) == -1)
+   _exit(127);
+
+  execv(argv[0], argv.data());
+  _exit(127);
+ }
+
+ close(log_fd);
+
+ return pid;
+}
+#endif
+
+static std::vector<std::string> BuildWorkerArgs(const RegressOptions& ro, const RegressTest& t, const RegressJob& job)
+{
+ const std::string out_base = ro.out_dir + PSS + t.name;
+ std::vector<std::string> ret;
+
+ ret.push_back(job.reference ? ro.reference_path : ro.self_path);
+ ret.insert(ret.end(), t.args.begin(), t.args.end());
+
+ if(job.reference)
+ {
+  ret.push_back("-frames");
+  ret.push_back(std::to_string(t.diverged_frame + 1));
+  ret.push_back("-rawsnap");
+  ret.push_back(out_base + ".expected.raw");
+ }
+ else
+ {
+  ret.push_back("-stats");
+  ret.push_back(out_base + ".stats");
+
+  if(ro.update)
+  {
+   ret.push_back("-hashlog");
+   ret.push_back(t.golden_path);
+  }
+  else
+  {
+   ret.push_back("-golden");
+   ret.push_back(t.golden_path);
+   ret.push_back("-rawsnap");
+   ret.push_back(out_base + ".actual.raw");
+  }
+ }
+
+ ret.push_back(t.game_path);
+
+ return ret;
+}
+
+//
+// Frame images from "-rawsnap".
+//
+static std::unique_ptr<MDFN_Surface> LoadRawSnapshot(const std::string& path)
+{
+ FileStream fp(path, FileStream::MODE_READ);
+ uint8 header[8];
+ uint32 w, h;
+ std::unique_ptr<MDFN_Surface> ret;
+ std::vector<uint8> line;
+
+ fp.read(header, sizeof(header));
+ w = MDFN_de32lsb(&header[0]);
+ h = MDFN_de32lsb(&header[4]);
+
+ if(!w || !h || w > 4096 || h > 4096)
+  throw MDFN_Error(0, _("Raw snapshot \"%s\" has bad dimensions(%ux%u)."), path.c_str(), w, h);
+
+ ret.reset(new MDFN_Surface(NULL, w, h, w, MDFN_PixelFormat::ABGR32_8888));
+ line.resize(w * 3);
+
+ for(uint32 y = 0; y < h; y++)
+ {
+  uint32* row = ret->pix<uint32>() + y * ret->pitchinpix;
+
+  fp.read(line.data(), line.size());
+
+  for(uint32 x = 0; x < w; x++)
+   row[x] = ret->format.MakeColor(line[x * 3 + 0], line[x * 3 + 1], line[x * 3 + 2]);
+ }
+
+ return ret;
+}
+
+static void WritePNG(const std::string& path, const MDFN_Surface* surf)
+{
+ const MDFN_Rect rect = { 0, 0, surf->w, surf->h };
+ const int32 lw = ~0;
+
+ NVFS.unlink(path);
+ PNGWrite(path, surf, rect, &lw);
+}
+
+static void WriteActualImage(const std::string& out_base)
+{
+ WritePNG(out_base + ".actual.png", LoadRawSnapshot(out_base + ".actual.raw").get());
+ NVFS.unlink(out_base + ".actual.raw");
+}
+
+static void WriteDiffImages(const std::string& out_base)
+{
+ std::unique_ptr<MDFN_Surface> actual = LoadRawSnapshot(out_base + ".actual.raw");
+ std::unique_ptr<MDFN_Surface> expected = LoadRawSnapshot(out_base + ".expected.raw");
+ const uint32 w = std::max<uint32>(actual->w, expected->w);
+ const uint32 h = std::max<uint32>(actual->h, expected->h);
+ MDFN_Surface diff(NULL, w, h, w, MDFN_PixelFormat::ABGR32_8888);
+
+ for(uint32 y = 0; y < h; y++)
+ {
+  uint32* row = diff.pix<uint32>() + y * diff.pitchinpix;
+
+  for(uint32 x = 0; x < w; x++)
+  {
+   const bool in_a = x < (uint32)actual->w && y < (uint32)actual->h;
+   const bool in_e = x < (uint32)expected->w && y < (uint32)expected->h;
+   const uint32 a = in_a ? actual->pix<uint32>()[y * actual->pitchinpix + x] : 0;
+   const uint32 e = in_e ? expected->pix<uint32>()[y * expected->pitchinpix + x] : 0;
+
+   if(in_a != in_e || a != e)
+    row[x] = diff.format.MakeColor(0xFF, 0x00, 0x00);
+   else
+   {
+    int r, g, b;
+
+    expected->format.DecodeColor(e, r, g, b);
+    row[x] = diff.format.MakeColor(r >> 2, g >> 2, b >> 2);
+   }
+  }
+ }
+
+ WritePNG(out_base + ".actual.png", actual.get());
+ WritePNG(out_base + ".expected.png", expected.get());
+ WritePNG(out_base + ".diff.png", &diff);
+
+ NVFS.unlink(out_base + ".actual.raw");
+ NVFS.unlink(out_base + ".expected.raw");
+}
+
+//
+//
+//
+static void FinishJob(const RegressOptions& ro, RegressTest* t, const RegressJob& job, const int status, std::deque<RegressJob>* queue)
+{
+ const std::string out_base = ro.out_dir + PSS + t->name;
+
+ if(job.reference)
+ {
+  try
+  {
+   if(status != 0)
+   {
+    WriteActualImage(out_base);
+    throw MDFN_Error(0, _("Reference run failed(exit status %d); see \"%s\"."), status, (out_base + ".reference.log").c_str());
+   }
+
+   WriteDiffImages(out_base);
+  }
+  catch(std::exception& e)
+  {
+   t->error = e.what();
+  }
+  return;
+ }
+
+ if(status == 0)
+ {
+  t->result = RegressTest::PASS;
+  NVFS.unlink(out_base + ".actual.raw");
+ }
+ else if(status == 2 && !ro.update)
+ {
+  try
+  {
+   std::map<std::string, std::string> stats = LoadStats(out_base + ".stats");
+
+   t->result = RegressTest::FAIL;
+   t->diverged_frame = atoll(stats["diverged_frame"].c_str());
+   t->diverged = stats["diverged"];
+
+   if(ro.reference_path.size())
+    queue->push_back({ job.test, true });
+   else
+    WriteActualImage(out_base);
+  }
+  catch(std::exception& e)
+  {
+   t->result = RegressTest::ERROR;
+   t->error = e.what();
+  }
+ }
+ else
+ {
+  t->result = RegressTest::ERROR;
+  t->error = MDFN_sprintf(_("Exit status %d; see \"%s\"."), status, (out_base + ".log").c_str());
+ }
+}
+
+static void RunTests(const RegressOptions& ro, std::vector<RegressTest>* tests)
+{
+#ifdef HAVE_FORK
+ std::deque<RegressJob> queue;
+ std::map<pid_t, RegressJob> running;
+
+ for(size_t i = 0; i < tests->size(); i++)
+  queue.push_back({ i, false });
+
+ while(queue.size() || running.size())
+ {
+  while(queue.size() && running.size() < ro.jobs)
+  {
+   const RegressJob job = queue.front();
+   RegressTest* t = &(*tests)[job.test];
+   const std::string log_path = ro.out_dir + PSS + t->name + (job.reference ? ".reference.log" : ".log");
+
+   queue.pop_front();
+   running[SpawnWorker(BuildWorkerArgs(ro, *t, job), ro.manifest_dir, log_path)] = job;
+  }
+
+  int wstatus;
+  const pid_t pid = waitpid(-1, &wstatus, 0);
+
+  if(pid == -1)
+  {
+   ErrnoHolder ene(errno);
+
+   if(ene.Errno() == EINTR)
+    continue;
+
+   throw MDFN_Error(ene.Errno(), _("waitpid() failed: %s"), ene.StrError());
+  }
+
+  auto it = running.find(pid);
+
+  if(it == running.end())
+   continue;
+
+  const RegressJob job = it->second;
+  const int status = WIFEXITED(wstatus) ? (int8)WEXITSTATUS(wstatus) : -128 - (WIFSIGNALED(wstatus) ? WTERMSIG(wstatus) : 0);
+  RegressTest* t = &(*tests)[job.test];
+
+  running.erase(it);
+  FinishJob(ro, t, job, status, &queue);
+
+  if(!job.reference)
+  {
+   const char* res_str = (t->result == RegressTest::PASS) ? "PASS" : ((t->result == RegressTest::FAIL) ? "FAIL" : "ERROR");
+
+   printf("%-5s %s\n", res_str, t->name.c_str());
+   fflush(stdout);
+  }
+ }
+#else
+ throw MDFN_Error(0, _("Running regression tests is not supported on this platform."));
+#endif
+}
+
+static void WriteReport(const RegressOptions& ro, const std::vector<RegressTest>& tests, FILE* out)
+{
+ FileStream fp(ro.out_dir + PSS + "report.txt", FileStream::MODE_WRITE);
+ unsigned counts[4] = { 0 };
+ std::string s;
+
+ for(auto const& t : tests)
+ {
+  counts[t.result]++;
+
+  if(t.result == RegressTest::PASS)
+   s += MDFN_sprintf("PASS  %s\n", t.name.c_str());
+  else if(t.result == RegressTest::FAIL)
+  {
+   s += MDFN_sprintf("FAIL  %s: frame %lld differs(%s)\n", t.name.c_str(), (long long)t.diverged_frame, t.diverged.c_str());
+
+   if(t.error.size())
+    s += MDFN_sprintf("      %s\n", t.error.c_str());
+   else
+    s += MDFN_sprintf("      See \"%s.%s.png\".\n", (ro.out_dir + PSS + t.name).c_str(), ro.reference_path.size() ? "diff" : "actual");
+  }
+  else
+   s += MDFN_sprintf("ERROR %s: %s\n", t.name.c_str(), t.error.c_str());
+ }
+
+ s += MDFN_sprintf("\n%u tests: %u passed, %u failed, %u errors\n", (unsigned)tests.size(), counts[RegressTest::PASS], counts[RegressTest::FAIL], counts[RegressTest::ERROR]);
+
+ fp.print_format("%s", s.c_str());
+ fp.close();
+
+ fprintf(out, "\n%s", s.c_str());
+}
+
+int RunRegression(const char* argv0, const char* manifest_path, int argc, char* argv[])
+{
+ try
+ {
+  RegressOptions ro;
+  std::vector<RegressTest> tests;
+  std::string out_dir = "regress";
+
+  for(int i = 0; i < argc; i += 2)
+  {
+   if(argv[i][0] != '-' || (i + 1) >= argc)
+    throw MDFN_Error(0, _("Malformed regression test option \"%s\"."), argv[i]);
+
+   const char* name = argv[i] + 1;
+   const char* value = argv[i + 1];
+
+   if(!strcmp(name, "jobs"))
+    ro.jobs = atoi(value);
+   else if(!strcmp(name, "outdir"))
+    out_dir = value;
+   else if(!strcmp(name, "reference"))
+    ro.reference_path = MakeAbsolute(value);
+   else if(!strcmp(name, "update"))
+    ro.update = atoi(value);
+   else
+    throw MDFN_Error(0, _("Unknown regression test option \"%s\"."), argv[i]);
+  }
+
+  if(!ro.jobs)
+   ro.jobs = std::max<long>(1, sysconf(_SC_NPROCESSORS_ONLN));
+
+  ro.self_path = GetSelfPath(argv0);
+  ro.out_dir = MakeAbsolute(out_dir);
+  NVFS.get_file_path_components(MakeAbsolute(manifest_path), &ro.manifest_dir);
+  NVFS.create_missing_dirs(ro.out_dir + PSS);
+
+  tests = LoadManifest(manifest_path);
+
+  for(auto const& t : tests)
+  {
+   if(t.name.find_first_of("/\\") != std::string::npos)
+    throw MDFN_Error(0, _("Test name \"%s\" contains a path separator."), t.name.c_str());
+  }
+
+  RunTests(ro, &tests);
+  WriteReport(ro, tests, stdout);
+
+  for(auto const& t : tests)
+  {
+   if(t.result != RegressTest::PASS)
+    return 1;
+  }
+
+  return 0;
+ }
+ catch(std::exception& e)
+ {
+  MDFND_OutputNotice(MDFN_NOTICE_ERROR, e.what());
+  return -1;
+ }
+}
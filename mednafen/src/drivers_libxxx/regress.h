@@ -0,0 +1,48 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* regress.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_DRIVERS_LIBXXX_REGRESS_H
+#define __MDFN_DRIVERS_LIBXXX_REGRESS_H
+
+//
+// Runs each test listed in a manifest in its own emulator process, up to "-jobs"(default: the number of online CPUs) at
+// a time, comparing every frame's video and audio hashes against the test's golden hash log(as written by "-hashlog").
+//
+// Each non-empty manifest line that doesn't start with '#' is:
+//
+//	<test name> <game path> <golden hash log path> [-option value]...
+//
+// split like a shell command line.  Relative paths are relative to the manifest's directory, and the options are passed
+// to the test's worker process as-is("-frames", "-movie", settings, etc.).
+//
+// For each test, "<outdir>/<test name>.log" receives the worker's output, and "<outdir>/<test name>.stats" its run
+// statistics.  A test fails at the first frame whose hashes differ from the golden hash log, and that frame is written
+// to "<test name>.actual.png".  When "-reference" names another mednafen binary(e.g. a build of the last known-good
+// revision), it's also run up to that frame, and its frame is written to "<test name>.expected.png", along with
+// "<test name>.diff.png" showing differing pixels in red over a darkened copy of the expected frame.  The results are
+// written to stdout and to "<outdir>/report.txt".
+//
+// With "-update 1", the golden hash logs are(re)written from this binary's output instead.
+//
+// Returns 0 if every test passed, 1 if any failed, and -1 on error.
+int RunRegression(const char* argv0, const char* manifest_path, int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,305 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* synthetic.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// Synthetic PC Engine HuCard used for benchmarking when no game is specified.  It keeps every part of the system busy
+// the whole time: VRAM and the palette are filled with noise, so every background pixel is opaque and nearly every tile
+// different, 64 32x32 sprites are rewritten each frame(well past the per-line limit), the horizontal scroll is changed
+// every 8 lines from a raster interrupt, and all six PSG channels(one in noise mode) play with their frequencies swept.
+// The main loop does byte arithmetic and block moves over RAM.
+//
+
+#include <mednafen/mednafen.h>
+#include <mednafen/FileStream.h>
+
+#include "synthetic.h"
+
+using namespace Mednafen;
+
+//
+// Assembled for $E000 in bank 0; the pieces are laid out one after another, in this order.
+//
+static const uint8 SyntheticPCE_Reset[] =
+{
+ // reset:
+ 0x78,                                   // SEI
+ 0xD4,                                   // CSH
+ 0xD8,                                   // CLD
+ 0xA2, 0xFF,                             // LDX #$FF
+ 0x9A,                                   // TXS
+ 0xA9, 0xFF,                             // LDA #$FF
+ 0x53, 0x01,                             // TAM #$01  -- I/O at $0000
+ 0xA9, 0xF8,                             // LDA #$F8
+ 0x53, 0x02,                             // TAM #$02  -- RAM at $2000
+ 0xA9, 0x05,                             // LDA #$05
+ 0x8D, 0x02, 0x14,                       // STA $1402  -- Mask IRQ2 and timer
+ 0xA9, 0x5A,                             // LDA #$5A
+ 0x85, 0x00,                             // STA <$00  -- LFSR seed
+ 0x64, 0x01,                             // STZ <$01  -- Frame counter
+ 0xA2, 0x00,                             // LDX #$00
+ // vinit:
+ 0xBD, 0x68, 0xE1,                       // LDA vdc_regs,X
+ 0x8D, 0x00, 0x00,                       // STA $0000
+ 0xBD, 0x69, 0xE1,                       // LDA vdc_regs+1,X
+ 0x8D, 0x02, 0x00,                       // STA $0002
+ 0xBD, 0x6A, 0xE1,                       // LDA vdc_regs+2,X
+ 0x8D, 0x03, 0x00,                       // STA $0003
+ 0xE8,                                   // INX
+ 0xE8,                                   // INX
+ 0xE8,                                   // INX
+ 0xE0, 0x27,                             // CPX #39
+ 0xD0, 0xE7,                             // BNE vinit
+ 0x03, 0x02,                             // ST0 #$02  -- Fill all of VRAM with noise
+ 0xA0, 0x80,                             // LDY #$80
+ // vfill_y:
+ 0xA2, 0x00,                             // LDX #$00
+ // vfill_x:
+ 0x20, 0xBF, 0xE0,                       // JSR rnd
+ 0x8D, 0x02, 0x00,                       // STA $0002
+ 0x20, 0xBF, 0xE0,                       // JSR rnd
+ 0x8D, 0x03, 0x00,                       // STA $0003
+ 0xCA,                                   // DEX
+ 0xD0, 0xF1,                             // BNE vfill_x
+ 0x88,                                   // DEY
+ 0xD0, 0xEC,                             // BNE vfill_y
+ 0x9C, 0x00, 0x04,                       // STZ $0400  -- VCE: 5.37MHz dot clock
+ 0x9C, 0x02, 0x04,                       // STZ $0402
+ 0x9C, 0x03, 0x04,                       // STZ $0403
+ 0xA0, 0x02,                             // LDY #$02  -- Fill the palette with noise
+ // pfill_y:
+ 0xA2, 0x00,                             // LDX #$00
+ // pfill_x:
+ 0x20, 0xBF, 0xE0,                       // JSR rnd
+ 0x8D, 0x04, 0x04,                       // STA $0404
+ 0x20, 0xBF, 0xE0,                       // JSR rnd
+ 0x8D, 0x05, 0x04,                       // STA $0405
+ 0xCA,                                   // DEX
+ 0xD0, 0xF1,                             // BNE pfill_x
+ 0x88,                                   // DEY
+ 0xD0, 0xEC,                             // BNE pfill_y
+ 0xA9, 0xFF,                             // LDA #$FF
+ 0x8D, 0x01, 0x08,                       // STA $0801  -- PSG main volume
+ 0xA2, 0x05,                             // LDX #$05
+ // psg_init:
+ 0x8E, 0x00, 0x08,                       // STX $0800  -- Channel select
+ 0x9C, 0x04, 0x08,                       // STZ $0804
+ 0xA0, 0x20,                             // LDY #$20
+ // wave_fill:
+ 0x20, 0xBF, 0xE0,                       // JSR rnd
+ 0x8D, 0x06, 0x08,                       // STA $0806  -- Waveform data
+ 0x88,                                   // DEY
+ 0xD0, 0xF7,                             // BNE wave_fill
+ 0xA9, 0xFF,                             // LDA #$FF
+ 0x8D, 0x05, 0x08,                       // STA $0805  -- Balance
+ 0x8E, 0x02, 0x08,                       // STX $0802  -- Frequency
+ 0xA9, 0x01,                             // LDA #$01
+ 0x8D, 0x03, 0x08,                       // STA $0803
+ 0xA9, 0x9C,                             // LDA #$9C
+ 0x8D, 0x04, 0x08,                       // STA $0804  -- Channel on
+ 0xCA,                                   // DEX
+ 0x10, 0xDA,                             // BPL psg_init
+ 0xA9, 0x98,                             // LDA #$98
+ 0x8D, 0x07, 0x08,                       // STA $0807  -- Noise on channel 5
+ 0x03, 0x05,                             // ST0 #$05
+ 0x13, 0xCC,                             // ST1 #$CC  -- CR: BG and sprites on, raster and vblank IRQs
+ 0x23, 0x00,                             // ST2 #$00
+ 0x58,                                   // CLI
+ // main:
+ 0x82,                                   // CLX   -- Busy work: byte arithmetic and block moves over RAM
+ // main_add:
+ 0xBD, 0x00, 0x22,                       // LDA $2200,X
+ 0x7D, 0x00, 0x23,                       // ADC $2300,X
+ 0x45, 0x00,                             // EOR <$00
+ 0x9D, 0x00, 0x24,                       // STA $2400,X
+ 0xE8,                                   // INX
+ 0xD0, 0xF2,                             // BNE main_add
+ 0x20, 0xBF, 0xE0,                       // JSR rnd
+ 0x73, 0x00, 0x24, 0x00, 0x22, 0x00, 0x02, // TII $2400,$2200,$0200
+ 0x80, 0xE5,                             // BRA main
+};
+
+static const uint8 SyntheticPCE_Rnd[] =
+{
+ // rnd:
+ 0xA5, 0x00,                             // LDA <$00
+ 0x0A,                                   // ASL A
+ 0x90, 0x02,                             // BCC rnd_skip
+ 0x49, 0x1D,                             // EOR #$1D
+ // rnd_skip:
+ 0x85, 0x00,                             // STA <$00
+ 0x60,                                   // RTS
+};
+
+static const uint8 SyntheticPCE_IRQ1[] =
+{
+ // irq1:
+ 0x48,                                   // PHA
+ 0xDA,                                   // PHX
+ 0x5A,                                   // PHY
+ 0xAD, 0x00, 0x00,                       // LDA $0000  -- Read and acknowledge VDC status
+ 0x89, 0x20,                             // BIT #$20
+ 0xD0, 0x25,                             // BNE vblank
+ 0x89, 0x04,                             // BIT #$04
+ 0xF0, 0x1D,                             // BEQ irq1_done
+ 0x03, 0x07,                             // ST0 #$07  -- Raster: wavy horizontal scroll
+ 0xA5, 0x02,                             // LDA <$02
+ 0x65, 0x01,                             // ADC <$01
+ 0x29, 0x1F,                             // AND #$1F
+ 0x8D, 0x02, 0x00,                       // STA $0002
+ 0x23, 0x00,                             // ST2 #$00
+ 0xA5, 0x02,                             // LDA <$02
+ 0x18,                                   // CLC
+ 0x69, 0x08,                             // ADC #$08
+ 0xB0, 0x09,                             // BCS irq1_done
+ 0x85, 0x02,                             // STA <$02
+ 0x03, 0x06,                             // ST0 #$06
+ 0x8D, 0x02, 0x00,                       // STA $0002
+ 0x23, 0x00,                             // ST2 #$00
+ // irq1_done:
+ 0x7A,                                   // PLY
+ 0xFA,                                   // PLX
+ 0x68,                                   // PLA
+ 0x40,                                   // RTI
+ // vblank:
+ 0xE6, 0x01,                             // INC <$01
+ 0xA9, 0x40,                             // LDA #$40
+ 0x85, 0x02,                             // STA <$02
+ 0x03, 0x06,                             // ST0 #$06
+ 0x8D, 0x02, 0x00,                       // STA $0002
+ 0x23, 0x00,                             // ST2 #$00
+ 0x03, 0x08,                             // ST0 #$08  -- Vertical scroll
+ 0xA5, 0x01,                             // LDA <$01
+ 0x8D, 0x02, 0x00,                       // STA $0002
+ 0x23, 0x00,                             // ST2 #$00
+ 0x03, 0x00,                             // ST0 #$00  -- Rewrite the SAT: 64 32x32 sprites
+ 0x13, 0x00,                             // ST1 #$00
+ 0x23, 0x7F,                             // ST2 #$7F
+ 0x03, 0x02,                             // ST0 #$02
+ 0x82,                                   // CLX
+ // sat:
+ 0x8A,                                   // TXA
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x65, 0x01,                             // ADC <$01
+ 0x8D, 0x02, 0x00,                       // STA $0002  -- Y
+ 0x23, 0x00,                             // ST2 #$00
+ 0x8A,                                   // TXA
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x65, 0x01,                             // ADC <$01
+ 0x65, 0x01,                             // ADC <$01
+ 0x8D, 0x02, 0x00,                       // STA $0002  -- X
+ 0x23, 0x00,                             // ST2 #$00
+ 0x8A,                                   // TXA
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x8D, 0x02, 0x00,                       // STA $0002  -- Pattern
+ 0x23, 0x01,                             // ST2 #$01
+ 0x8A,                                   // TXA
+ 0x29, 0x0F,                             // AND #$0F
+ 0x09, 0x80,                             // ORA #$80
+ 0x8D, 0x02, 0x00,                       // STA $0002  -- Attributes
+ 0x23, 0x11,                             // ST2 #$11
+ 0xE8,                                   // INX
+ 0xE0, 0x40,                             // CPX #$40
+ 0xD0, 0xD2,                             // BNE sat
+ 0xA2, 0x05,                             // LDX #$05  -- Sweep PSG channel frequencies
+ // sweep:
+ 0x8E, 0x00, 0x08,                       // STX $0800
+ 0x8A,                                   // TXA
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x0A,                                   // ASL A
+ 0x65, 0x01,                             // ADC <$01
+ 0x8D, 0x02, 0x08,                       // STA $0802
+ 0xCA,                                   // DEX
+ 0x10, 0xF0,                             // BPL sweep
+ 0x9C, 0x02, 0x04,                       // STZ $0402  -- Cycle the background color
+ 0x9C, 0x03, 0x04,                       // STZ $0403
+ 0xA5, 0x01,                             // LDA <$01
+ 0x8D, 0x04, 0x04,                       // STA $0404
+ 0x9C, 0x05, 0x04,                       // STZ $0405
+ 0x80, 0x8D,                             // BRA irq1_done
+};
+
+static const uint8 SyntheticPCE_RTI[] =
+{
+ // rti:
+ 0x40,                                   // RTI
+};
+
+static const uint8 SyntheticPCE_VDCRegs[] =
+{
+ // vdc_regs:
+ 0x05, 0x00, 0x00,                       // .db $05, $00, $00 -- CR: display off
+ 0x09, 0x10, 0x00,                       // .db $09, $10, $00 -- MWR: 64x32 BAT
+ 0x0A, 0x02, 0x02,                       // .db $0A, $02, $02 -- HSR
+ 0x0B, 0x1F, 0x03,                       // .db $0B, $1F, $03 -- HDR: 256 pixels
+ 0x0C, 0x02, 0x0F,                       // .db $0C, $02, $0F -- VSR
+ 0x0D, 0xEF, 0x00,                       // .db $0D, $EF, $00 -- VDR: 240 lines
+ 0x0E, 0x03, 0x00,                       // .db $0E, $03, $00 -- VCR
+ 0x0F, 0x10, 0x00,                       // .db $0F, $10, $00 -- DCR: SATB DMA every frame
+ 0x13, 0x00, 0x7F,                       // .db $13, $00, $7F -- SATB: $7F00
+ 0x07, 0x00, 0x00,                       // .db $07, $00, $00 -- BXR
+ 0x08, 0x00, 0x00,                       // .db $08, $00, $00 -- BYR
+ 0x06, 0x40, 0x00,                       // .db $06, $40, $00 -- RCR
+ 0x00, 0x00, 0x00,                       // .db $00, $00, $00 -- MAWR: $0000
+};
+
+enum : uint32
+{
+ SyntheticPCE_Reset_Addr = 0xE000,
+ SyntheticPCE_Rnd_Addr = SyntheticPCE_Reset_Addr + sizeof(SyntheticPCE_Reset),
+ SyntheticPCE_IRQ1_Addr = SyntheticPCE_Rnd_Addr + sizeof(SyntheticPCE_Rnd),
+ SyntheticPCE_RTI_Addr = SyntheticPCE_IRQ1_Addr + sizeof(SyntheticPCE_IRQ1),
+ SyntheticPCE_VDCRegs_Addr = SyntheticPCE_RTI_Addr + sizeof(SyntheticPCE_RTI),
+ SyntheticPCE_End_Addr = SyntheticPCE_VDCRegs_Addr + sizeof(SyntheticPCE_VDCRegs)
+};
+
+// The "JSR rnd" and "LDA vdc_regs,X" operands above are absolute addresses.
+static_assert(SyntheticPCE_Rnd_Addr == 0xE0BF, "SyntheticPCE_Rnd moved; update the JSR rnd operands.");
+static_assert(SyntheticPCE_VDCRegs_Addr == 0xE168, "SyntheticPCE_VDCRegs moved; update the LDA vdc_regs,X operands.");
+static_assert(SyntheticPCE_End_Addr <= 0xFFF6, "Synthetic program overlaps the vectors.");
+
+void WriteSyntheticPCE(const std::string& path)
+{
+ std::unique_ptr<uint8[]> rom(new uint8[8192]);
+
+ memset(rom.get(), 0xFF, 8192);
+ memcpy(&rom[SyntheticPCE_Reset_Addr & 0x1FFF], SyntheticPCE_Reset, sizeof(SyntheticPCE_Reset));
+ memcpy(&rom[SyntheticPCE_Rnd_Addr & 0x1FFF], SyntheticPCE_Rnd, sizeof(SyntheticPCE_Rnd));
+ memcpy(&rom[SyntheticPCE_IRQ1_Addr & 0x1FFF], SyntheticPCE_IRQ1, sizeof(SyntheticPCE_IRQ1));
+ memcpy(&rom[SyntheticPCE_RTI_Addr & 0x1FFF], SyntheticPCE_RTI, sizeof(SyntheticPCE_RTI));
+ memcpy(&rom[SyntheticPCE_VDCRegs_Addr & 0x1FFF], SyntheticPCE_VDCRegs, sizeof(SyntheticPCE_VDCRegs));
+
+ MDFN_en16lsb(&rom[0x1FF6], SyntheticPCE_RTI_Addr);	// IRQ2/BRK
+ MDFN_en16lsb(&rom[0x1FF8], SyntheticPCE_IRQ1_Addr);	// IRQ1(VDC)
+ MDFN_en16lsb(&rom[0x1FFA], SyntheticPCE_RTI_Addr);	// Timer
+ MDFN_en16lsb(&rom[0x1FFC], SyntheticPCE_RTI_Addr);	// NMI
+ MDFN_en16lsb(&rom[0x1FFE], SyntheticPCE_Reset_Addr);	// Reset
+
+ FileStream fp(path, FileStream::MODE_WRITE);
+
+ fp.write(rom.get(), 8192);
+ fp.close();
+}
@@ -164,6 +164,11 @@ uint16 crc16_ccitt(const void* data, const size_t len)
  return crcN<uint16, 16, 0x1021, false>(0, data, len);
 }
 
+uint16 crc16_ccitt_false(const void* data, const size_t len)
+{
+ return crcN<uint16, 16, 0x1021, false>(0xFFFF, data, len);
+}
+
 uint32 crc32_cdrom_edc(const void* data, const size_t len)
 {
  return crcN<uint32, 32, 0x8001801B, true>(0, data, len);
@@ -180,6 +185,10 @@ void crc_test(void)
  assert(crc16_ccitt(tv,   1) == 0xE54F);
  assert(crc16_ccitt(tv, 256) == 0x9C87);
 
+ assert(crc16_ccitt_false(tv,   0) == 0xFFFF);
+ assert(crc16_ccitt_false(tv,   1) == 0x04BF);
+ assert(crc16_ccitt_false(tv, 256) == 0xDD6F);
+
  assert(crc32_cdrom_edc(tv,   0) == 0x00000000);
  assert(crc32_cdrom_edc(tv,   1) == 0x58D0A500);
  assert(crc32_cdrom_edc(tv, 256) == 0xA194A58B);
@@ -26,6 +26,7 @@ namespace Mednafen
 {
 
 NO_CLONE NO_INLINE uint16 crc16_ccitt(const void* data, const size_t len);
+NO_CLONE NO_INLINE uint16 crc16_ccitt_false(const void* data, const size_t len);	// Initial value of 0xFFFF
 NO_CLONE NO_INLINE uint32 crc32_cdrom_edc(const void* data, const size_t len);
 
 void crc_test(void);
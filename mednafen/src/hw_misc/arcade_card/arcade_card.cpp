@@ -158,6 +158,7 @@ void ArcadeCard::Write(uint32 A, uint8 V)
 
               ACRAMUsed = true;
               ACRAM[aci] = V;
+              ACRAMDirty.Mark(aci);
               ACAutoIncrement(port);
 	     }
              break;
@@ -278,6 +279,7 @@ ArcadeCard::ArcadeCard(void)
  memset(&AC, 0, sizeof(AC));
 
  memset(ACRAM, 0, sizeof(ACRAM));
+ ACRAMDirty.Init(ACRAM, sizeof(ACRAM));
 }
 
 ArcadeCard::~ArcadeCard()
@@ -288,6 +290,7 @@ ArcadeCard::~ArcadeCard()
 void ArcadeCard::Power(void)
 {
  memset(ACRAM, 0, 0x200000);
+ ACRAMDirty.MarkAll();
  ACRAMUsed = false;
 }
 
@@ -353,6 +356,7 @@ void ArcadeCard::PokeRAM(uint32 Address, uint32 Length, const uint8 *Buffer)
   Address &= (1 << 21) - 1;
 
   ACRAM[Address] = *Buffer;
+  ACRAMDirty.Mark(Address);
   used |= ACRAM[Address];
 
   Address++;
@@ -22,6 +22,11 @@
 #include <trio/trio.h>
 #include "pce_psg.h"
 
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
 namespace Mednafen
 {
 // Frequency cache cutoff optimization threshold (<= FREQC7M_COT)
@@ -72,31 +77,63 @@ static const int16 Phase_Filter[2][7] =
  /*   1 */ {     6,   112,   425,   641,   579,   250,    35 }, //  2048
 };
 
-INLINE void PCE_PSG::UpdateOutputSub(const int32 timestamp, psg_channel *ch, const int32 samp0, const int32 samp1)
+#if defined(__SSE2__)
+// Phase_Filter as 32-bit lanes(coefficient in the low 16 bits) for _mm_madd_epi16(), padded to 8 taps.
+alignas(16) static const int32 Phase_Filter_Madd[2][8] =
+{
+ {    35,   250,   579,   641,   425,   112,     6,     0 },
+ {     6,   112,   425,   641,   579,   250,    35,     0 },
+};
+#endif
+
+// Adds the filtered step for a change in output of delta0/delta1 at 'timestamp' to the HR buffers.
+// The 8th tap the SSE2 path writes(with a coefficient of 0) lands in the HR buffers' overflow padding at worst.
+INLINE void PCE_PSG::EmitDelta(const int32 timestamp, const int32 delta0, const int32 delta1)
 {
- int32 delta[2];
+ const int32 l = (timestamp >> 2) & 0xFFFF;
 
- delta[0] = samp0 - ch->blip_prev_samp[0];
- delta[1] = samp1 - ch->blip_prev_samp[1];
+#if defined(__SSE2__)
+ // _mm_madd_epi16() multiplies 16-bit values; deltas are well within that at any sane volume, but check anyway.
+ if(MDFN_LIKELY(((uint32)delta0 + 0x8000) <= 0xFFFF && ((uint32)delta1 + 0x8000) <= 0xFFFF))
+ {
+  const int32* c = Phase_Filter_Madd[(timestamp >> 1) & 1];
+  const __m128i c0 = _mm_load_si128((__m128i *)&c[0]);
+  const __m128i c1 = _mm_load_si128((__m128i *)&c[4]);
+  const __m128i d0 = _mm_set1_epi32((uint16)delta0);
+  const __m128i d1 = _mm_set1_epi32((uint16)delta1);
+  __m128i* b0 = (__m128i *)&HRBufs[0][l];
+  __m128i* b1 = (__m128i *)&HRBufs[1][l];
+
+  _mm_storeu_si128(&b0[0], _mm_add_epi32(_mm_loadu_si128(&b0[0]), _mm_madd_epi16(d0, c0)));
+  _mm_storeu_si128(&b0[1], _mm_add_epi32(_mm_loadu_si128(&b0[1]), _mm_madd_epi16(d0, c1)));
+  _mm_storeu_si128(&b1[0], _mm_add_epi32(_mm_loadu_si128(&b1[0]), _mm_madd_epi16(d1, c0)));
+  _mm_storeu_si128(&b1[1], _mm_add_epi32(_mm_loadu_si128(&b1[1]), _mm_madd_epi16(d1, c1)));
+  return;
+ }
+#endif
 
  const int16* c = Phase_Filter[(timestamp >> 1) & 1];
- const int32 l = (timestamp >> 2) & 0xFFFF;
 
- HRBufs[0][l + 0] += delta[0] * c[0];
- HRBufs[0][l + 1] += delta[0] * c[1];
- HRBufs[0][l + 2] += delta[0] * c[2];
- HRBufs[0][l + 3] += delta[0] * c[3];
- HRBufs[0][l + 4] += delta[0] * c[4];
- HRBufs[0][l + 5] += delta[0] * c[5];
- HRBufs[0][l + 6] += delta[0] * c[6];
-
- HRBufs[1][l + 0] += delta[1] * c[0];
- HRBufs[1][l + 1] += delta[1] * c[1];
- HRBufs[1][l + 2] += delta[1] * c[2];
- HRBufs[1][l + 3] += delta[1] * c[3];
- HRBufs[1][l + 4] += delta[1] * c[4];
- HRBufs[1][l + 5] += delta[1] * c[5];
- HRBufs[1][l + 6] += delta[1] * c[6];
+ HRBufs[0][l + 0] += delta0 * c[0];
+ HRBufs[0][l + 1] += delta0 * c[1];
+ HRBufs[0][l + 2] += delta0 * c[2];
+ HRBufs[0][l + 3] += delta0 * c[3];
+ HRBufs[0][l + 4] += delta0 * c[4];
+ HRBufs[0][l + 5] += delta0 * c[5];
+ HRBufs[0][l + 6] += delta0 * c[6];
+
+ HRBufs[1][l + 0] += delta1 * c[0];
+ HRBufs[1][l + 1] += delta1 * c[1];
+ HRBufs[1][l + 2] += delta1 * c[2];
+ HRBufs[1][l + 3] += delta1 * c[3];
+ HRBufs[1][l + 4] += delta1 * c[4];
+ HRBufs[1][l + 5] += delta1 * c[5];
+ HRBufs[1][l + 6] += delta1 * c[6];
+}
+
+INLINE void PCE_PSG::UpdateOutputSub(const int32 timestamp, psg_channel *ch, const int32 samp0, const int32 samp1)
+{
+ EmitDelta(timestamp, samp0 - ch->blip_prev_samp[0], samp1 - ch->blip_prev_samp[1]);
 
  ch->blip_prev_samp[0] = samp0;
  ch->blip_prev_samp[1] = samp1;
@@ -661,23 +698,72 @@ void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
   }
  }
 
- while(ch->counter <= 0)
+ if(LFO_On)
  {
-  ch->waveform_index = (ch->waveform_index + 1) & 0x1F;
-  ch->dda = ch->waveform[ch->waveform_index];
+  while(ch->counter <= 0)
+  {
+   ch->waveform_index = (ch->waveform_index + 1) & 0x1F;
+   ch->dda = ch->waveform[ch->waveform_index];
 
-  (this->*ch->UpdateOutput)(timestamp + ch->counter, ch);
+   (this->*ch->UpdateOutput)(timestamp + ch->counter, ch);
 
-  if(LFO_On)
-  {
    RunChannel(1, timestamp + ch->counter, false);
    RecalcFreqCache(0);
    RecalcUOFunc(0);
 
    ch->counter += (ch->freq_cache <= FREQC7M_COT) ? FREQC7M_COT : ch->freq_cache;	// Not particularly accurate, but faster.
   }
-  else
-   ch->counter += ch->freq_cache;
+ }
+ else if(ch->UpdateOutput == &PCE_PSG::UpdateOutput_Norm)
+ {
+  //
+  // Frequency, volume, and waveform can't change within a call, so step through the waveform with everything in locals,
+  // and only emit the steps where the output actually changes(a zero delta adds nothing to the HR buffers).
+  //
+  const int32* const t0 = dbtable[ch->vl[0]];
+  const int32* const t1 = dbtable[ch->vl[1]];
+  const uint32 freq = ch->freq_cache;
+  int32 counter = ch->counter;
+  unsigned wi = ch->waveform_index;
+  int32 prev0 = ch->blip_prev_samp[0];
+  int32 prev1 = ch->blip_prev_samp[1];
+
+  while(counter <= 0)
+  {
+   wi = (wi + 1) & 0x1F;
+
+   const int32 samp0 = t0[ch->waveform[wi]];
+   const int32 samp1 = t1[ch->waveform[wi]];
+
+   if((samp0 != prev0) | (samp1 != prev1))
+   {
+    EmitDelta(timestamp + counter, samp0 - prev0, samp1 - prev1);
+    prev0 = samp0;
+    prev1 = samp1;
+   }
+   counter += freq;
+  }
+
+  ch->counter = counter;
+  ch->waveform_index = wi;
+  ch->dda = ch->waveform[wi];
+  ch->blip_prev_samp[0] = prev0;
+  ch->blip_prev_samp[1] = prev1;
+ }
+ else if(ch->counter <= 0)
+ {
+  //
+  // Off, noise, and accumulator output don't depend on the waveform position, so at most the first step can change
+  // the output; emit it, and then skip over the rest.
+  //
+  const int32 inc_count = ((0 - ch->counter) / ch->freq_cache) + 1;
+
+  (this->*ch->UpdateOutput)(timestamp + ch->counter, ch);
+
+  ch->counter += inc_count * ch->freq_cache;
+
+  ch->waveform_index = (ch->waveform_index + inc_count) & 0x1F;
+  ch->dda = ch->waveform[ch->waveform_index];
  }
 }
 
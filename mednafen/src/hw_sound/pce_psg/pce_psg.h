@@ -157,6 +157,7 @@ class PCE_PSG
 	void UpdateSubNonLFO(int32 timestamp);
 
 	void RecalcUOFunc(int chnum);
+	void EmitDelta(const int32 timestamp, const int32 delta0, const int32 delta1);
         void UpdateOutputSub(const int32 timestamp, psg_channel *ch, const int32 samp0, const int32 samp1);
 	void UpdateOutput_Off(const int32 timestamp, psg_channel *ch);
 	void UpdateOutput_Accum_HuC6280(const int32 timestamp, psg_channel *ch);
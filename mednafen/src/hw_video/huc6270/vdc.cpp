@@ -25,6 +25,15 @@
 #include <math.h>
 #include "vdc.h"
 
+#ifdef HAVE_NEON_INTRINSICS
+ #include <arm_neon.h>
+#endif
+
+#if defined(HAVE_SSE2_INTRINSICS)
+ #include <xmmintrin.h>
+ #include <emmintrin.h>
+#endif
+
 namespace Mednafen
 {
 
@@ -44,6 +53,27 @@ static const unsigned int bat_width_tab[4] = { 32, 64, 128, 128 };
 static const unsigned int bat_width_shift_tab[4] = { 5, 6, 7, 7 };
 static const unsigned int bat_height_tab[2] = { 32, 64 };
 
+#include "vdc_generic.inc"
+
+#if defined(HAVE_SSE2_INTRINSICS)
+ #include "vdc_sse2.inc"
+#endif
+
+#ifdef HAVE_NEON_INTRINSICS
+ #include "vdc_neon.inc"
+#endif
+
+static INLINE void ComposeBGTile(uint16* target, const uint8* pix_lut, const uint8 pix_mask, const uint16 pal_or)
+{
+#if defined(HAVE_SSE2_INTRINSICS)
+ ComposeBGTile_SSE2(target, pix_lut, pix_mask, pal_or);
+#elif defined(HAVE_NEON_INTRINSICS)
+ ComposeBGTile_NEON(target, pix_lut, pix_mask, pal_or);
+#else
+ ComposeBGTile_Generic(target, pix_lut, pix_mask, pal_or);
+#endif
+}
+
 void VDC::FixTileCache(uint16 A)
 {
  uint32 charname = (A >> 4);
@@ -53,14 +83,17 @@ void VDC::FixTileCache(uint16 A)
  uint32 bitplane01 = VRAM[y + charname * 16];
  uint32 bitplane23 = VRAM[y+ 8 + charname * 16];
 
- for(int x = 0; x < 8; x++)
+ DecodePlanar8(tc, bitplane01, bitplane01 >> 8, bitplane23, bitplane23 >> 8);
+
+ if(rstream)
  {
-  uint32 raw_pixel = ((bitplane01 >> x) & 1);
-  raw_pixel |= ((bitplane01 >> (x + 8)) & 1) << 1;
-  raw_pixel |= ((bitplane23 >> x) & 1) << 2;
-  raw_pixel |= ((bitplane23 >> (x + 8)) & 1) << 3;
-  tc[7 - x] = raw_pixel;
+  uint32* p = rstream->Append(2);
+
+  p[0] = VDC_RenderStream::EVENT_VRAM;
+  p[1] = A | (VRAM[A] << 16);
  }
+ else
+  VRAMChangedUnstreamed = true;
 }
 
 // Some virtual vdc macros to make code simpler to read
@@ -358,6 +391,7 @@ void VDC::RunDMA(int32 cycles, bool force_completion)
    if(DESR < VRAM_Size)
    {
     VRAM[DESR] = DMAReadBuffer;
+    VRAMDirty.Mark(DESR << 1);
     FixTileCache(DESR);
    }
 
@@ -701,7 +735,9 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
 
   if(pixel_copy_count > 0)
   {
-   if(!skip)
+   if(rstream)
+    rstream->AddRun(VDC_RenderStream::EVENT_COPY, chunk_clocks, pixel_desu | ((M_vdc_TE == 0x1) ? (VDC_DISP_OUT_MASK << 16) : 0));
+   else if(!skip)
    {
     for(int i = 0; i < chunk_clocks; i++)
      pixels[i] = linebuf[pixel_desu + i];
@@ -739,7 +775,9 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
    if(!(userle & ULE_BG))
     pix |= VDC_BGDISABLE_OUT_MASK;
 
-   if(!skip)
+   if(rstream)
+    rstream->AddRun(VDC_RenderStream::EVENT_FILL, chunk_clocks, pix);
+   else if(!skip)
    {
     for(int i = 0; i < chunk_clocks; i++)
      pixels[i] = pix;
@@ -833,31 +871,12 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
 		       pixel_desu = 0;
 		       pixel_copy_count = (HDW_cache + 1) * 8;
 
-		       // BG off, sprite on: fill = 0x000.  bg off, sprite off: fill = 0x100
-		       if(!(CR_cache & 0x80))
-		       {
-		        uint16 fill_val;
-
-		        if(!(CR_cache & 0xC0))	// Sprites and BG off
-			 fill_val = 0x100;			
-		        else	// Only BG off
-			 fill_val = 0x000;
-
-			if(!(userle & ULE_BG))
-			 fill_val |= VDC_BGDISABLE_OUT_MASK;
-
-			for(int i = 0; i < pixel_copy_count; i++)
-			 linebuf[i] = fill_val;
-		       }
-
-		       if(!skip)
- 		        if(CR_cache & 0x80)
-			{
-		         DrawBG(linebuf, userle & ULE_BG);
-			}
-			//printf("%d %02x %02x\n", RCRCount, CR, CR_cache);
-		       if(CR_cache & 0x40)
-		        DrawSprites(linebuf, (userle & ULE_SPR) && !skip, boundbox_enable);
+		       if(rstream)
+		        RecordLine();
+		       else if(skip)
+		        SkipLine();
+		       else
+		        DrawLine();
 		      }
 		     }
 		     break;
@@ -900,6 +919,34 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
 }
 
 
+void VDC::DrawLine(void)
+{
+ // BG off, sprite on: fill = 0x000.  bg off, sprite off: fill = 0x100
+ if(!(CR_cache & 0x80))
+ {
+  uint16 fill_val;
+
+  if(!(CR_cache & 0xC0))	// Sprites and BG off
+   fill_val = 0x100;			
+  else	// Only BG off
+   fill_val = 0x000;
+
+  if(!(userle & ULE_BG))
+   fill_val |= VDC_BGDISABLE_OUT_MASK;
+
+  for(int i = 0; i < pixel_copy_count; i++)
+   linebuf[i] = fill_val;
+ }
+
+ if(CR_cache & 0x80)
+ {
+  DrawBG(linebuf, userle & ULE_BG);
+ }
+ //printf("%d %02x %02x\n", RCRCount, CR, CR_cache);
+ if(CR_cache & 0x40)
+  DrawSprites(linebuf, userle & ULE_SPR, boundbox_enable);
+}
+
 void VDC::CalcWidthStartEnd(uint32 &display_width, uint32 &start, uint32 &end)
 {
  display_width = (M_vdc_HDW + 1) * 8;
@@ -962,51 +1009,17 @@ void VDC::DrawBG(uint16 *target, int enabled)
   int bat_boom = (BG_XOffset >> 3) & bat_width_mask;
   int line_sub = BG_YOffset & 7;
 
-  if((MWR_cache & 0x3) == 0x3)
-  {
-   for(uint32 x = first_end; x < end; x+=8)
-   {
-    const uint16 bat = VRAM[bat_boom | bat_y];
-    const uint8 pal_or = ((bat >> 8) & 0xF0);
-    uint8 *pix_lut = bg_tile_cache[bat & 0xFFF][line_sub];
-
-    if((bat & 0xFFF) > VRAM_BGTileNoMask)
-     VDC_UNDEFINED("Unmapped BG tile read");
-
-
-    (target + 0)[x] = (pix_lut[0] & dohmask) | pal_or;
-    (target + 1)[x] = (pix_lut[1] & dohmask) | pal_or;
-    (target + 2)[x] = (pix_lut[2] & dohmask) | pal_or;
-    (target + 3)[x] = (pix_lut[3] & dohmask) | pal_or;
-    (target + 4)[x] = (pix_lut[4] & dohmask) | pal_or;
-    (target + 5)[x] = (pix_lut[5] & dohmask) | pal_or;
-    (target + 6)[x] = (pix_lut[6] & dohmask) | pal_or;
-    (target + 7)[x] = (pix_lut[7] & dohmask) | pal_or;
-
-    bat_boom = (bat_boom + 1) & bat_width_mask;
-    BG_XOffset++;
-
-   }
-  }
-  else
   for(uint32 x = first_end; x < end; x+=8) // This will draw past the right side of the buffer, but since our pitch is 1024, and max width is ~512, we're safe.  Also,
 					// any overflow that is on the visible screen are will be hidden by the overscan color code below this code.
   {
    const uint16 bat = VRAM[bat_boom | bat_y];
    const uint8 pal_or = ((bat >> 8) & 0xF0);
-   uint8 *pix_lut = bg_tile_cache[bat & 0xFFF][line_sub];
+   const uint8 *pix_lut = bg_tile_cache[bat & 0xFFF][line_sub];
 
    if((bat & 0xFFF) > VRAM_BGTileNoMask)
     VDC_UNDEFINED("Unmapped BG tile read");
 
-   (target + 0)[x] = pix_lut[0] | pal_or;
-   (target + 1)[x] = pix_lut[1] | pal_or;
-   (target + 2)[x] = pix_lut[2] | pal_or;
-   (target + 3)[x] = pix_lut[3] | pal_or;
-   (target + 4)[x] = pix_lut[4] | pal_or;
-   (target + 5)[x] = pix_lut[5] | pal_or;
-   (target + 6)[x] = pix_lut[6] | pal_or;
-   (target + 7)[x] = pix_lut[7] | pal_or;
+   ComposeBGTile(target + x, pix_lut, dohmask, pal_or);
 
    bat_boom = (bat_boom + 1) & bat_width_mask;
    BG_XOffset++;
@@ -1014,6 +1027,20 @@ void VDC::DrawBG(uint16 *target, int enabled)
  }
 }
 
+// Advances BG_XOffset as DrawBG() would, without drawing anything.
+void VDC::AdvanceBGXOffset(void)
+{
+ uint32 width;
+ uint32 start;
+ uint32 end;
+
+ CalcWidthStartEnd(width, start, end);
+
+ const uint32 first_end = start + 8 - (BG_XOffset & 7);
+
+ BG_XOffset += (first_end - start) + (end - first_end + 7) / 8;
+}
+
 #define SPRF_PRIORITY	0x00080
 #define SPRF_HFLIP	0x00800
 #define SPRF_VFLIP	0x08000
@@ -1258,6 +1285,214 @@ void VDC::DrawSprites(uint16 *target, int enabled, int boundbox_enabled)
  active_sprites = 0;
 }
 
+// Returns the opaque pixels of a sprite line as a mask, bit 0 being the leftmost pixel.
+static INLINE uint32 SpriteOpaqueMask(const uint16* pattern_data, const uint32 flags)
+{
+ uint32 m = pattern_data[0] | pattern_data[1] | pattern_data[2] | pattern_data[3];
+
+ if(!(flags & SPRF_HFLIP))
+ {
+  m = ((m >> 1) & 0x5555) | ((m & 0x5555) << 1);
+  m = ((m >> 2) & 0x3333) | ((m & 0x3333) << 2);
+  m = ((m >> 4) & 0x0F0F) | ((m & 0x0F0F) << 4);
+  m = ((m >> 8) & 0x00FF) | ((m & 0x00FF) << 8);
+ }
+
+ return m;
+}
+
+//
+// Sprite #0 collision detection for when the sprite line itself isn't needed; sets VDCS_CR as DrawSprites() would, by
+// AND'ing sprite #0's opaque pixel mask with the union of the other sprites' masks in a line bitset.  Doesn't handle
+// bounding boxes(a debugging aid that also triggers collisions), so DrawSprites() is still used when they're enabled.
+//
+void VDC::CheckSprite0Collision(void)
+{
+ // Line position + 32, so that sprites partially off the left edge fit.
+ uint64 others[(1024 + 32 + 16 + 63) / 64 + 1] = { 0 };
+ uint32 display_width, start, end;
+ bool hit = false;
+
+ CalcWidthStartEnd(display_width, start, end);
+
+ for(int i = 0; i < active_sprites; i++)
+ {
+  if(SpriteList[i].flags & SPRF_SPRITE0)
+   continue;
+
+  const uint32 p = SpriteList[i].x + start;
+  const uint64 m = SpriteOpaqueMask(SpriteList[i].pattern_data, SpriteList[i].flags);
+
+  others[p >> 6] |= m << (p & 63);
+  others[(p >> 6) + 1] |= (m >> 1) >> (63 - (p & 63));
+ }
+
+ for(int i = 0; i < active_sprites && !hit; i++)
+ {
+  if(!(SpriteList[i].flags & SPRF_SPRITE0))
+   continue;
+
+  const int32 pos = SpriteList[i].x - 0x20 + start;
+  const uint32 p = SpriteList[i].x + start;
+  uint32 m = SpriteOpaqueMask(SpriteList[i].pattern_data, SpriteList[i].flags);
+  uint64 o;
+
+  // Pixels outside of the display width don't collide.
+  if(pos < 0)
+   m &= 0xFFFF << std::min<int32>(16, -pos);
+
+  if(pos + 16 > (int32)end)
+   m &= (1U << std::max<int32>(0, (int32)end - pos)) - 1;
+
+  o = others[p >> 6] >> (p & 63);
+  o |= (others[(p >> 6) + 1] << 1) << (63 - (p & 63));
+
+  hit = (m & o) != 0;
+ }
+
+ if(hit)
+ {
+  status |= VDCS_CR;
+  VDC_DEBUG("Sprite hit IRQ");
+  IRQHook(true);
+ }
+
+ active_sprites = 0;
+}
+
+//
+// Counterpart of DrawLine() for skipped frames; the emulated state ends up the same as after DrawLine(), but nothing is
+// drawn.
+//
+void VDC::SkipLine(void)
+{
+ if((CR_cache & 0x80) && (userle & ULE_BG))
+  AdvanceBGXOffset();
+
+ if(CR_cache & 0x40)
+ {
+  // Sprite #0 collision detection affects emulation, so it can't be skipped.
+  if((CR & 0x01) && active_sprites > 0 && (SpriteList[0].flags & SPRF_SPRITE0))
+  {
+   if(boundbox_enable)
+    DrawSprites(linebuf, false, boundbox_enable);
+   else
+    CheckSprite0Collision();
+  }
+  else
+   active_sprites = 0;
+ }
+}
+
+//
+// Counterpart of DrawLine() when a render stream is set; the emulated state ends up the same as after DrawLine(), but
+// drawing is left to ReplayRenderStream().
+//
+void VDC::RecordLine(void)
+{
+ const uint32 num_sprites = (CR_cache & 0x40) ? active_sprites : 0;
+ const uint32 count = (sizeof(LineState) + num_sprites * sizeof(SPRLE) + 3) / 4;
+ uint32* p = rstream->Append(1 + count);
+ LineState ls;
+
+ ls.HDR = HDR;
+ ls.CR_cache = CR_cache;
+ ls.MWR_cache = MWR_cache;
+ ls.userle = userle;
+ ls.boundbox_enable = boundbox_enable;
+ ls.HDW_cache = HDW_cache;
+ ls.BG_XOffset = BG_XOffset;
+ ls.BG_YOffset = BG_YOffset;
+ ls.active_sprites = num_sprites;
+
+ p[0] = VDC_RenderStream::EVENT_LINE | (count << 2);
+ memcpy(p + 1, &ls, sizeof(ls));
+ memcpy((uint8*)(p + 1) + sizeof(ls), SpriteList, num_sprites * sizeof(SPRLE));
+
+ SkipLine();
+}
+
+void VDC::ReplayRenderStream(const uint32* words, const uint32 count, uint16* pixels)
+{
+ const uint32* const words_end = words + count;
+
+ while(words != words_end)
+ {
+  const uint32 w = *words++;
+  const uint32 n = w >> 2;
+
+  switch(w & 0x3)
+  {
+   case VDC_RenderStream::EVENT_FILL:
+	{
+	 const uint16 pix = *words++;
+
+	 for(uint32 i = 0; i < n; i++)
+	  pixels[i] = pix;
+
+	 pixels += n;
+	}
+	break;
+
+   case VDC_RenderStream::EVENT_COPY:
+	{
+	 const uint32 d = *words++;
+	 const uint16* src = &linebuf[d & 0xFFFF];
+	 const uint16 or_mask = d >> 16;
+
+	 for(uint32 i = 0; i < n; i++)
+	  pixels[i] = src[i] | or_mask;
+
+	 pixels += n;
+	}
+	break;
+
+   case VDC_RenderStream::EVENT_VRAM:
+	{
+	 const uint32 d = *words++;
+
+	 VRAM[d & 0xFFFF] = d >> 16;
+	 FixTileCache(d & 0xFFFF);
+	}
+	break;
+
+   case VDC_RenderStream::EVENT_LINE:
+	{
+	 LineState ls;
+
+	 memcpy(&ls, words, sizeof(ls));
+	 memcpy(SpriteList, (const uint8*)words + sizeof(ls), ls.active_sprites * sizeof(SPRLE));
+	 words += n;
+
+	 HDR = ls.HDR;
+	 CR = 0;	// No sprite #0 collision IRQs from here.
+	 CR_cache = ls.CR_cache;
+	 MWR_cache = ls.MWR_cache;
+	 userle = ls.userle;
+	 boundbox_enable = ls.boundbox_enable;
+	 HDW_cache = ls.HDW_cache;
+	 BG_XOffset = ls.BG_XOffset;
+	 BG_YOffset = ls.BG_YOffset;
+	 active_sprites = ls.active_sprites;
+
+	 pixel_copy_count = (HDW_cache + 1) * 8;
+	 DrawLine();
+	}
+	break;
+  }
+ }
+}
+
+void VDC::CopyVRAM(const VDC& src)
+{
+ VRAM_Size = src.VRAM_Size;
+ VRAM_SizeMask = src.VRAM_SizeMask;
+ VRAM_BGTileNoMask = src.VRAM_BGTileNoMask;
+
+ memcpy(VRAM, src.VRAM, sizeof(VRAM));
+ memcpy(bg_tile_cache64, src.bg_tile_cache64, sizeof(bg_tile_cache64));
+}
+
 /*
  Caution: If we ever add something to Write() or Read() that will affect the timing of the next event, make sure
  to set the passed-by-reference next_event BEFORE calling this function, or otherwise re-engineer this convoluted setup.
@@ -1423,6 +1658,7 @@ void VDC::CheckAndCommitPending(void)
    if(pending_write_addr < VRAM_Size)
    {
     VRAM[pending_write_addr] = pending_write_latch;
+    VRAMDirty.Mark(pending_write_addr << 1);
     FixTileCache(pending_write_addr);
    }
    //else
@@ -1741,6 +1977,7 @@ void VDC::Write16(bool A, uint16 V)
 int32 VDC::Reset(void)
 {
  memset(VRAM, 0, sizeof(VRAM));
+ VRAMDirty.MarkAll();
  memset(SAT, 0, sizeof(SAT));
  memset(SpriteList, 0, sizeof(SpriteList));
 
@@ -1837,6 +2074,10 @@ int32 VDC::Reset(void)
 
 VDC::VDC()
 {
+ rstream = NULL;
+ VRAMChangedUnstreamed = true;
+
+ VRAMDirty.Init(VRAM, sizeof(VRAM));
  SetUnlimitedSprites(false);
  SetVRAMSize(65536);
  userle = ~0;
@@ -1874,6 +2115,31 @@ VDC::~VDC()
 
 }
 
+VDC_RenderStream::VDC_RenderStream() : words(NULL), size(0), capacity(0), last_run(~0U)
+{
+ Grow(16384);
+}
+
+VDC_RenderStream::~VDC_RenderStream()
+{
+ delete[] words;
+}
+
+void VDC_RenderStream::Grow(const uint32 min_capacity)
+{
+ const uint32 new_capacity = std::max<uint32>(capacity * 2, min_capacity);
+ uint32* new_words = new uint32[new_capacity];
+
+ if(words)
+ {
+  memcpy(new_words, words, size * sizeof(uint32));
+  delete[] words;
+ }
+
+ words = new_words;
+ capacity = new_capacity;
+}
+
 void VDC::StateExtra(LEPacker &sl_packer, bool load)
 {
  sl_packer.set_read_mode(load);
@@ -2045,16 +2311,15 @@ bool VDC::DoGfxDecode(uint32 *target, const uint32 *color_table, const uint32 Tr
      continue;
     }
 
-    uint16 cg[4];
-    cg[0] = VRAM[which_tile * 64 + (y & 15)];
-    cg[1] = VRAM[which_tile * 64 + (y & 15) + 16];
-    cg[2] = VRAM[which_tile * 64 + (y & 15) + 32];
-    cg[3] = VRAM[which_tile * 64 + (y & 15) + 48];
+    const uint16* cg = &VRAM[which_tile * 64 + (y & 15)];
+    uint8 pix[16];
+
+    DecodePlanar8(&pix[0], cg[0] >> 8, cg[16] >> 8, cg[32] >> 8, cg[48] >> 8);
+    DecodePlanar8(&pix[8], cg[0], cg[16], cg[32], cg[48]);
+
     for(int sx = 0; sx < 16; sx++)
     {
-     int rev_sx = 15 - sx;
-     target[x + sx] = palette_ptr[(((cg[0] >> rev_sx) & 1) << 0) |
-                (((cg[1] >> rev_sx) & 1) << 1) | (((cg[2] >> rev_sx) & 1) << 2) | (((cg[3] >> rev_sx) & 1) << 3)];
+     target[x + sx] = palette_ptr[pix[sx]];
      target[x + w * 1 + sx] = which_tile;
      target[x + w * 2 + sx] = which_tile * 64;
     }
@@ -54,6 +54,73 @@ typedef struct
 	bool RegReadDone;
 } VDC_SimulateResult;
 
+//
+// Used by VDC::Run() in place of writing pixels, to defer background and sprite composition to another VDC instance(i.e. in another thread);
+// it records VRAM writes, the state needed to draw each line, and the runs of output pixels, in the order they happen.
+//
+class VDC_RenderStream
+{
+	public:
+
+	enum
+	{
+	 EVENT_FILL = 0,	// Next word: pixel value.
+	 EVENT_COPY,		// Next word: linebuf offset | (OR mask << 16).
+	 EVENT_VRAM,		// Next word: VRAM address | (data << 16).
+	 EVENT_LINE		// Followed by (count) words of line state.
+	};
+
+	VDC_RenderStream() MDFN_COLD;
+	~VDC_RenderStream() MDFN_COLD;
+
+	INLINE void Clear(void)
+	{
+	 size = 0;
+	 last_run = ~0U;
+	}
+
+	INLINE uint32 Size(void) const { return size; }
+	INLINE const uint32* Data(void) const { return words; }
+
+	INLINE uint32* Append(const uint32 count)
+	{
+	 if(MDFN_UNLIKELY((size + count) > capacity))
+	  Grow(size + count);
+
+	 uint32* ret = &words[size];
+
+	 size += count;
+	 last_run = ~0U;
+
+	 return ret;
+	}
+
+	// Adjacent runs of the same pixel value, or of consecutive linebuf offsets, are merged.
+	INLINE void AddRun(const uint32 type, const uint32 count, const uint32 data)
+	{
+	 if(last_run != ~0U && (words[last_run] & 0x3) == type && words[last_run + 1] == (data - ((type == EVENT_COPY) ? (words[last_run] >> 2) : 0)))
+	 {
+	  words[last_run] += count << 2;
+	  return;
+	 }
+
+	 uint32* p = Append(2);
+
+	 p[0] = type | (count << 2);
+	 p[1] = data;
+	 last_run = size - 2;
+	}
+
+	private:
+
+	void Grow(const uint32 min_capacity) MDFN_COLD;
+
+	uint32* words;
+	uint32 size;
+	uint32 capacity;
+	uint32 last_run;
+};
+
 class VDC
 {
 	public:
@@ -260,6 +327,27 @@ class VDC
 
 	int32 Run(int32 clocks, /*bool hs, bool vs,*/ uint16 *pixels, bool skip);
 
+	// While a render stream is set, Run() records into it instead of drawing lines and writing to "pixels", and VRAM writes are recorded too.
+	// The stream is replayed, producing the same pixels, with ReplayRenderStream() on a separate VDC instance that was last synchronized with
+	// CopyVRAM() while the stream was unset.
+	INLINE void SetRenderStream(VDC_RenderStream* rs)
+	{
+	 rstream = rs;
+	}
+
+	// Returns true if VRAM has changed since the last call while no render stream was set.
+	INLINE bool TestVRAMChangedUnstreamed(void)
+	{
+	 const bool ret = VRAMChangedUnstreamed;
+
+	 VRAMChangedUnstreamed = false;
+
+	 return ret;
+	}
+
+	void CopyVRAM(const VDC& src);
+	void ReplayRenderStream(const uint32* words, const uint32 count, uint16* pixels);
+
 
 	void FixTileCache(uint16);
 	void SetLayerEnableMask(uint64 mask);
@@ -298,6 +386,7 @@ class VDC
 	 if(Address < VRAM_Size)
 	 {
 	  VRAM[Address] = Data;
+	  VRAMDirty.Mark(Address << 1);
 	  FixTileCache(Address);
 	 }
 	}
@@ -427,9 +516,28 @@ class VDC
 
 	bool in_exhsync, in_exvsync;
 
+	struct LineState
+	{
+	 uint16 HDR;
+	 uint16 CR_cache;
+	 uint16 MWR_cache;
+	 uint8 userle;
+	 bool boundbox_enable;
+	 uint32 HDW_cache;
+	 uint32 BG_XOffset;
+	 uint32 BG_YOffset;
+	 uint32 active_sprites;
+	 // Followed by SpriteList[0 ... active_sprites - 1]
+	};
+
+	void DrawLine(void);
+	void SkipLine(void);
+	void RecordLine(void);
 	void CalcWidthStartEnd(uint32 &display_width, uint32 &start, uint32 &end);
 	void DrawBG(uint16 *target, int enabled);
+	void AdvanceBGXOffset(void);
 	void DrawSprites(uint16 *target, int enabled, int boundbox_enable);
+	void CheckSprite0Collision(void);
 	void FetchSpriteData(void);
 
 
@@ -488,6 +596,7 @@ class VDC
         uint16 SAT[0x100];
 
         uint16 VRAM[65536]; //VRAM_Size];
+	StateDirtyMap VRAMDirty;
 
 	union
 	{
@@ -538,6 +647,9 @@ class VDC
 
 	int active_sprites;
 	SPRLE SpriteList[64 * 2]; // (see unlimited_sprites option, *2 to accommodate 32-pixel-width sprites ) //16];
+
+	VDC_RenderStream* rstream;
+	bool VRAMChangedUnstreamed;
 };
 
 }
@@ -40,6 +40,7 @@
 
 #include "settings.h"
 #include "netplay.h"
+#include "netplay_rollback.h"
 #include "netplay-driver.h"
 #include "general.h"
 
@@ -53,6 +54,7 @@
 #include "tests.h"
 #include "video/tblur.h"
 #include "qtrecord.h"
+#include "profile.h"
 
 namespace Mednafen
 {
@@ -104,10 +106,14 @@ static const MDFNSetting MednafenSettings[] =
   { "netplay.nick", MDFNSF_NOFLAGS, gettext_noop("Nickname."), gettext_noop("Nickname to use for network play chat."), MDFNST_STRING, "" },
   { "netplay.gamekey", MDFNSF_NOFLAGS, gettext_noop("Key to hash with the MD5 hash of the game."), NULL, MDFNST_STRING, "" },
 
+  { "netplay.rollback.frames", MDFNSF_NOFLAGS, gettext_noop("Maximum number of frames to emulate ahead of the remote input during rollback netplay."), gettext_noop("Emulation waits for the remote peer when it gets this far ahead.  Should cover the round-trip time to the remote peer, minus the input delay.  A save state is kept in memory for each frame."), MDFNST_UINT, "12", "1", "60" },
+  { "netplay.rollback.delay", MDFNSF_NOFLAGS, gettext_noop("Local input delay, in frames, during rollback netplay."), gettext_noop("Delaying local input gives the remote peer's input that much more time to arrive, and so reduces how often and how far emulation is rolled back."), MDFNST_UINT, "1", "0", "10" },
+  { "netplay.rollback.simlatency", MDFNSF_NOFLAGS, gettext_noop("Simulated one-way network latency, in milliseconds, for rollback netplay."), gettext_noop("Delays processing of input received from the remote peer, for testing over a local connection."), MDFNST_UINT, "0", "0", "1000" },
+
   { "srwframes", MDFNSF_NOFLAGS, gettext_noop("Number of frames to keep states for when state rewinding is enabled."), 
 	gettext_noop("WARNING: Setting this to a large value may cause excessive RAM usage in some circumstances, such as with games that stream large volumes of data off of CDs."), MDFNST_UINT, "600", "10", "99999" },
 
-  { "cd.image_memcache", MDFNSF_NOFLAGS, gettext_noop("Cache entire CD images in memory."), gettext_noop("Reads the entire CD image(s) into memory at startup(which will cause a small delay).  Can help obviate emulation hiccups due to emulated CD access.  May cause more harm than good on low memory systems, systems with swap enabled, and/or when the disc images in question are on a fast SSD.\n\nCaution: When using a 32-bit build of Mednafen on Windows or a 32-bit operating system, Mednafen may run out of address space(and error out, possibly in the middle of emulation) if this option is enabled when loading large disc sets(e.g. 3+ discs) via M3U files."), MDFNST_BOOL, "0" },
+  { "cd.image_memcache", MDFNSF_NOFLAGS, gettext_noop("Cache entire CD images in memory."), gettext_noop("Uncompressed CD image files(e.g. BIN and ISO) are memory-mapped read-only where supported, which is nearly instant and shares the data via the operating system's file cache; other CD image files are read entirely into memory at startup(which will cause a small delay).  Can help obviate emulation hiccups due to emulated CD access.  May cause more harm than good on low memory systems, systems with swap enabled, and/or when the disc images in question are on a fast SSD.\n\nCaution: When using a 32-bit build of Mednafen on Windows or a 32-bit operating system, Mednafen may run out of address space(and error out, possibly in the middle of emulation) if this option is enabled when loading large disc sets(e.g. 3+ discs) via M3U files."), MDFNST_BOOL, "0" },
   { "cd.m3u.recursion_limit", MDFNSF_NOFLAGS, gettext_noop("M3U recursion limit."), gettext_noop("A value of 0 effectively disables recursive loading of M3U files."), MDFNST_UINT, "9", "0", "99" },
   { "cd.m3u.disc_limit", MDFNSF_NOFLAGS, gettext_noop("M3U total number of disc images limit."), NULL, MDFNST_UINT, "25", "1", "999" },
   { "filesys.untrusted_fip_check", MDFNSF_NOFLAGS, gettext_noop("Enable untrusted file-inclusion path security check."),
@@ -599,6 +605,7 @@ static const std::vector<FileExtensionSpecStruct> KnownCDExtensions =
  // M3U must be highest.
  { ".m3u", -40, "M3U" },
  { ".ccd", -50, "CloneCD" },
+ { ".chd", -55, "MAME CHD" },
  { ".cue", -60, "CUE" },
  { ".toc", -70, "cdrdao TOC" },
 };
@@ -1632,6 +1639,8 @@ static std::vector<int16> SoundBufPristine;
 
 static void ProcessAudio(EmulateSpecStruct *espec)
 {
+ MDFN_ProfileZone pz(PROFZONE_PROCESS_AUDIO);
+
  if(espec->SoundVolume != 1)
   volume_save = espec->SoundVolume;
 
@@ -1796,7 +1805,7 @@ void MDFN_MidSync(EmulateSpecStruct *espec, const unsigned flags)
  // We could act as if flags = 0 during netplay, and call MDFND_MidSync(), but
  // we'd need to fix the kludgy driver-side code that handles sound buffer underruns.
  //
- if(!MDFNnetplay)
+ if(!MDFNnetplay && !MDFNrollback)
  {
   MDFND_MidSync(espec, flags);
   //
@@ -1874,7 +1883,10 @@ void MDFNI_Emulate(EmulateSpecStruct *espec)
  if(MDFNGameInfo->TransformInput)
   MDFNGameInfo->TransformInput();
 
- Netplay_Update(PortDevice, PortData, PortDataLen);
+ if(MDFNrollback)
+  Rollback_Update(espec, PortDevice, PortData, PortDataLen);
+ else
+  Netplay_Update(PortDevice, PortData, PortDataLen);
 
  MDFNMOV_ProcessInput(PortData, PortDataLen, MDFNGameInfo->PortInfo.size());
 
@@ -1886,7 +1898,7 @@ void MDFNI_Emulate(EmulateSpecStruct *espec)
 
  if(espec->NeedRewind)
  {
-  if(MDFNnetplay)
+  if(MDFNnetplay || MDFNrollback)
   {
    espec->NeedRewind = false;
    MDFN_Notify(MDFN_NOTICE_STATUS, _("Can't rewind during netplay."));
@@ -1896,14 +1908,16 @@ void MDFNI_Emulate(EmulateSpecStruct *espec)
  // Don't even save states with state rewinding if netplay is enabled, it will degrade netplay performance, and can cause
  // desynchs with some emulation(IE SNES based on bsnes).
 
- if(MDFNnetplay)
+ if(MDFNnetplay || MDFNrollback)
   espec->NeedSoundReverse = false;
  else
   espec->NeedSoundReverse = MDFNSRW_Frame(espec->NeedRewind);
 
  MDFNGameInfo->Emulate(espec);
 
- if(MDFNnetplay)
+ if(MDFNrollback)
+  Rollback_PostProcess(PortDevice, PortData, PortDataLen);
+ else if(MDFNnetplay)
   Netplay_PostProcess(PortDevice, PortData, PortDataLen);
 
  //
@@ -1962,6 +1976,8 @@ void MDFNI_Emulate(EmulateSpecStruct *espec)
 
  if(espec->InterlaceOn)
  {
+  MDFN_ProfileZone pz(PROFZONE_DEINTERLACE);
+
   if(!PrevInterlaced)
    deint->ClearState();
 
@@ -2002,7 +2018,11 @@ void MDFNI_Emulate(EmulateSpecStruct *espec)
  }
 
  if(TBlur_IsOn())
+ {
+  MDFN_ProfileZone pz(PROFZONE_TBLUR);
+
   TBlur_Run(espec);
+ }
 }
 
 static void StateAction_RINP(StateMem* sm, const unsigned load, const bool data_only)
@@ -2197,7 +2217,9 @@ void MDFN_DoSimpleCommand(int cmd)
 
 void MDFN_QSimpleCommand(int cmd)
 {
- if(MDFNnetplay)
+ if(MDFNrollback)
+  MDFN_Notify(MDFN_NOTICE_STATUS, _("Can't do that during rollback netplay."));
+ else if(MDFNnetplay)
   NetplaySendCommand(cmd, 0);
  else
  {
@@ -2402,6 +2424,12 @@ bool MDFNI_SetMedia(uint32 drive_idx, uint32 state_idx, uint32 media_idx, uint32
 {
  assert(MDFNGameInfo);
 
+ if(MDFNrollback)
+ {
+  MDFN_Notify(MDFN_NOTICE_STATUS, _("Can't do that during rollback netplay."));
+  return false;
+ }
+
  if(MDFNnetplay || MDFNMOV_IsRecording())
  {
   uint8 buf[4 * 4];
@@ -100,6 +100,7 @@ static INLINE void WriteU8(uint32 addr, const uint8 val)
   const size_t offs = addr % PageSize;
 
   RAMInfo[page].Ptr[offs] = val;
+  StateDirtyMap::MarkPtr(&RAMInfo[page].Ptr[offs]);
  }
  else if(MDFNGameInfo->CheatInfo.MemWrite)
   MDFNGameInfo->CheatInfo.MemWrite(addr, val);
@@ -24,6 +24,7 @@
 #include "general.h"
 #include "video.h"
 #include "netplay.h"
+#include "netplay_rollback.h"
 #include "movie.h"
 #include "state.h"
 
@@ -94,6 +95,11 @@ void MDFNI_SaveMovie(char *fname, const MDFN_Surface *surface, const MDFN_Rect *
    throw MDFN_Error(0, _("Module %s is not compatible with manual movie save starting/stopping during netplay."), MDFNGameInfo->shortname);
   }
 
+  if(MDFNrollback)
+  {
+   throw MDFN_Error(0, _("Can't record movies during rollback netplay."));
+  }
+
   if(ActiveMovieMode == MOVIE_PLAYING)	/* Can't interrupt playback.*/
   {
    throw MDFN_Error(0, _("Can't record movie during movie playback."));
@@ -165,7 +171,7 @@ void MDFNI_LoadMovie(char *fname)
    throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
   }
 
-  if(MDFNnetplay)
+  if(MDFNnetplay || MDFNrollback)
   {
    throw MDFN_Error(0, _("Can't play movies during netplay."));
   }
@@ -47,17 +47,15 @@ std::unique_ptr<Connection> Connect(const char *host, unsigned int port)
  #endif
 }
 
-#if 0
-std::unique_ptr<Connection> Listen(unsigned int port)
+std::unique_ptr<Connection> Accept(unsigned int port)
 {
  #ifdef HAVE_POSIX_SOCKETS
  return POSIX_Accept(port);
  #elif defined(WIN32)
- return WS2_Accept(port);
+ throw MDFN_Error(0, _("Accepting incoming connections isn't supported on this platform."));
  #else
  throw MDFN_Error(0, _("Networking system API support not compiled in."));
  #endif
 }
-#endif
 
 }
@@ -67,15 +67,18 @@ class POSIX_Client : public POSIX_Connection
  virtual bool Established(int32 timeout = 0) override;
 };
 
-#if 0
 class POSIX_Server : public POSIX_Connection
 {
  public:
  POSIX_Server(unsigned int port);
+ virtual ~POSIX_Server() override;
 
- virtual bool Established(bool wait = false) override;
+ virtual bool Established(int32 timeout = 0) override;
+
+ private:
+
+ int listen_fd = -1;
 };
-#endif
 
 POSIX_Client::POSIX_Client(const char *host, unsigned int port)
 {
@@ -217,6 +220,142 @@ bool POSIX_Client::Established(int32 timeout)
  return true;
 }
 
+POSIX_Server::POSIX_Server(unsigned int port)
+{
+ struct sockaddr_in sa;
+ int opt = 1;
+
+ listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+ if(listen_fd == -1)
+ {
+  ErrnoHolder ene(errno);
+
+  throw MDFN_Error(ene.Errno(), _("socket() failed: %s"), ene.StrError());
+ }
+
+ try
+ {
+  if(setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1)
+  {
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("setsockopt() failed: %s"), ene.StrError());
+  }
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(INADDR_ANY);
+  sa.sin_port = htons(port);
+
+  if(bind(listen_fd, (struct sockaddr*)&sa, sizeof(sa)) == -1)
+  {
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("bind() failed: %s"), ene.StrError());
+  }
+
+  if(listen(listen_fd, 1) == -1)
+  {
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("listen() failed: %s"), ene.StrError());
+  }
+
+  fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+ }
+ catch(...)
+ {
+  close(listen_fd);
+  listen_fd = -1;
+  throw;
+ }
+}
+
+POSIX_Server::~POSIX_Server()
+{
+ if(listen_fd != -1)
+ {
+  close(listen_fd);
+  listen_fd = -1;
+ }
+}
+
+bool POSIX_Server::Established(int32 timeout)
+{
+ if(fully_established)
+  return true;
+
+ {
+  int rv;
+  struct pollfd fds[1];
+
+  TryAgain:
+  memset(fds, 0, sizeof(fds));
+  fds[0].fd = listen_fd;
+  fds[0].events = POLLIN;
+  rv = poll(fds, 1, ((timeout >= 0) ? (timeout + 500) / 1000 : -1));
+
+  if(rv == -1)
+  {
+   if(errno == EINTR)
+   {
+    timeout = 0;
+    goto TryAgain;
+   }
+
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("poll() failed: %s"), ene.StrError());
+  }
+
+  if(!(fds[0].revents & POLLIN))
+   return false;
+ }
+
+ fd = accept(listen_fd, NULL, NULL);
+ if(fd == -1)
+ {
+  if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED)
+   return false;
+
+  ErrnoHolder ene(errno);
+
+  throw MDFN_Error(ene.Errno(), _("accept() failed: %s"), ene.StrError());
+ }
+
+ close(listen_fd);
+ listen_fd = -1;
+
+ #ifdef SO_NOSIGPIPE
+ {
+  int opt = 1;
+
+  if(setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &opt, sizeof(opt)) == -1)
+  {
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("setsockopt() failed: %s"), ene.StrError());
+  }
+ }
+ #endif
+
+ fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+ {
+  int tcpopt = 1;
+  if(setsockopt(fd, SOL_TCP, TCP_NODELAY, &tcpopt, sizeof(int)) == -1)
+  {
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("setsockopt() failed: %s"), ene.StrError());
+  }
+ }
+
+ fully_established = true;
+
+ return true;
+}
+
 POSIX_Connection::POSIX_Connection()
 {
 
@@ -349,11 +488,9 @@ std::unique_ptr<Connection> POSIX_Connect(const char* host, unsigned int port)
  return std::unique_ptr<Connection>(new POSIX_Client(host, port));
 }
 
-#if 0
 std::unique_ptr<Connection> POSIX_Accept(unsigned int port)
 {
- return new POSIX_Server(port);
+ return std::unique_ptr<Connection>(new POSIX_Server(port));
 }
-#endif
 
 }
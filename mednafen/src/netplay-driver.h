@@ -5,7 +5,16 @@ namespace Mednafen
 {
 
 void MDFNI_NetplayConnect(void);
-void MDFNI_NetplayDisconnect(void);
+void MDFNI_NetplayDisconnect(void);	// Also ends any rollback netplay session.
+
+//
+// Rollback netplay: a direct connection between two Mednafen instances, without a server.  Remote input is predicted instead of waited on, and
+// emulation is re-run from a data-only save state when the prediction was wrong.  The hosting peer listens on "port" and controls the first
+// input port, the connecting peer controls the second; both take their local input from the first input port.
+//
+void MDFNI_RollbackHost(unsigned port);
+void MDFNI_RollbackConnect(const char* host, unsigned port);
+void MDFNI_RollbackDisconnect(void);
 
 /* Parse and handle a line of UI text(may include / commands) */
 void MDFNI_NetplayLine(const char *text, bool &inputable, bool &viewable);
@@ -24,6 +24,7 @@
 
 #include "netplay.h"
 #include "netplay-driver.h"
+#include "netplay_rollback.h"
 #include "general.h"
 #include <mednafen/string/string.h>
 #include "state.h"
@@ -1178,6 +1179,8 @@ static bool CC_nick(const char *arg);
 static bool CC_ping(const char *arg);
 //static bool CC_integrity(const char *arg);
 static bool CC_gamekey(const char *arg);
+static bool CC_rbhost(const char *arg);
+static bool CC_rbconnect(const char *arg);
 static bool CC_swap(const char *arg);
 static bool CC_dupe(const char *arg);
 static bool CC_drop(const char *arg);
@@ -1190,6 +1193,9 @@ static CommandEntry ConsoleCommands[]   =
 
  { "/connect", CC_server,	NULL, NULL },
 
+ { "/rbhost", CC_rbhost,	gettext_noop("[PORT]"), gettext_noop("Waits for a rollback netplay peer to connect on PORT.") },
+ { "/rbconnect", CC_rbconnect,	gettext_noop("REMOTE_HOST [PORT]"), gettext_noop("Connects to a rollback netplay peer at REMOTE_HOST, on PORT.") },
+
  { "/gamekey", CC_gamekey,	gettext_noop("[GAMEKEY]"), gettext_noop("Changes the game key to the specified GAMEKEY.") },
 
  { "/quit", CC_quit,		gettext_noop("[MESSAGE]"), gettext_noop("Disconnects from the netplay server.") },
@@ -1215,6 +1221,8 @@ static CommandEntry ConsoleCommands[]   =
 
 void MDFNI_NetplayDisconnect(void)
 {
+ MDFNI_RollbackDisconnect();
+
  const bool had_connection = Connection != nullptr;
  Connection.reset(nullptr);
 
@@ -1287,6 +1295,35 @@ static bool CC_server(const char *arg)
  return(false);
 }
 
+static bool CC_rbhost(const char *arg)
+{
+ unsigned int port = MDFN_GetSettingUI("netplay.port");
+
+ trio_sscanf(arg, "%u", &port);
+
+ MDFNI_RollbackHost(port);
+
+ return(false);
+}
+
+static bool CC_rbconnect(const char *arg)
+{
+ char host[300];
+ unsigned int port = MDFN_GetSettingUI("netplay.port");
+
+ host[0] = 0;
+
+ if(trio_sscanf(arg, "%299s %u", host, &port) < 1)
+ {
+  NetPrintText(_("*** No host specified!"));
+  return(true);
+ }
+
+ MDFNI_RollbackConnect(host, port);
+
+ return(false);
+}
+
 static bool CC_gamekey(const char *arg)
 {
  MDFNI_SetSetting("netplay.gamekey", arg);
@@ -1308,6 +1345,12 @@ static bool CC_gamekey(const char *arg)
 
 static bool CC_quit(const char *arg)
 {
+ if(MDFNrollback)
+ {
+  MDFNI_RollbackDisconnect();
+  return false;
+ }
+
  if(!MDFNnetplay && !Connection)
  {
   NetPrintText(_("*** Not connected!"));
@@ -0,0 +1,581 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* netplay_rollback.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+//
+// Rollback netplay is a direct connection between two peers, without a server.  Each peer sends its local input for each frame as
+// soon as it has it, and emulates ahead using the last remote input received as the prediction of the remote input for frames it
+// hasn't received yet.  A data-only save state is kept for every frame emulated with predicted input; when the real input for such a
+// frame arrives and differs from the prediction, the state is loaded and the frames since are emulated again, with video and sound
+// output skipped.  Emulation only waits on the remote peer when it gets "netplay.rollback.frames" frames ahead of the remote input.
+//
+// After the connection is established, both peers send a hello_t, then the host sends a save state, which the other peer loads.
+// After that, each packet is a 32-bit little-endian frame number followed by the sending peer's input port data for that frame,
+// sent in frame order.  Frames before the sending peer's input delay have all-zero input.
+//
+// The host controls the first input port, the other peer the second; both take their local input from the first input port.
+//
+
+#include "mednafen.h"
+#include "netplay.h"
+#include "netplay-driver.h"
+#include "netplay_rollback.h"
+#include "state.h"
+#include "movie.h"
+
+#include <mednafen/MemoryStream.h>
+#include <mednafen/Time.h>
+#include <mednafen/net/Net.h>
+#include <trio/trio.h>
+
+#include <deque>
+
+namespace Mednafen
+{
+
+bool MDFNrollback = false;
+
+struct hello_t
+{
+ uint8 magic[8];
+ uint8 gameid[16];
+
+ uint8 role;			// 0 = host, 1 = connecting peer.
+ uint8 total_controllers;
+ uint8 padding[6];
+
+ uint8 controller_type[16];
+ uint8 controller_data_size[16];
+};
+static_assert(sizeof(hello_t) == 64, "sizeof(hello_t) != 64");
+
+static const uint8 HelloMagic[8] = { 'M', 'D', 'F', 'N', 'R', 'B', 0x00, 0x01 };
+
+// Large enough to hold every frame within (max frames + max input delay) * 2 of the current frame.
+enum : uint32 { InputRingSize = 256 };
+
+struct InputSlot
+{
+ uint32 frame = ~0U;
+ bool remote_valid = false;
+
+ std::unique_ptr<uint8[]> local;
+ std::unique_ptr<uint8[]> remote;
+ std::unique_ptr<uint8[]> used;	// Remote input the frame was last emulated with.
+};
+
+struct Snapshot
+{
+ uint32 frame = ~0U;
+ MemoryStream data;
+ StateDeltaToken token;
+};
+
+static std::unique_ptr<Net::Connection> Connection;
+static bool IsHost;
+static bool Started;
+
+static unsigned LocalPort, RemotePort;
+static uint32 LocalLen, RemoteLen;
+static uint32 Delay;
+static uint32 MaxFrames;
+static uint32 SimLatency;
+
+static uint32 CurFrame;		// Next frame to be emulated.
+static uint32 ConfirmedFrame;	// Remote input has been received for all frames before this one.
+static bool NeedRollback;
+static uint32 RollbackFrame;	// Earliest frame emulated with mispredicted remote input, valid if NeedRollback.
+
+static std::unique_ptr<InputSlot[]> InputRing;
+static std::unique_ptr<Snapshot[]> Snapshots;	// MaxFrames
+static std::unique_ptr<uint8[]> LastRemote;	// Remote input for frame ConfirmedFrame - 1.
+static std::unique_ptr<uint8[]> PreUpdateLocal;	// Local input from the driver, for Rollback_PostProcess()
+static std::unique_ptr<uint8[]> OutgoingBuffer;	// 4 + LocalLen
+static std::unique_ptr<uint8[]> IncomingBuffer;	// 4 + RemoteLen
+static uint32 IncomingPos;
+static std::deque<std::pair<uint32, std::unique_ptr<uint8[]>>> Pending;	// Received packets, and the time they're due.
+
+static std::unique_ptr<int16[]> ResimSoundBuf;
+static int32 ResimSoundBufMaxSize = 0;
+
+static void RBPrintText(const char* format, ...) MDFN_FORMATSTR(gnu_printf, 1, 2);
+static void RBPrintText(const char* format, ...)
+{
+ char *temp = NULL;
+ va_list ap;
+
+ va_start(ap, format);
+ temp = trio_vaprintf(format, ap);
+ va_end(ap);
+
+ MDFND_NetplayText(temp, false);
+ free(temp);
+}
+
+static void RBError(const char* format, ...) MDFN_FORMATSTR(gnu_printf, 1, 2);
+static void RBError(const char* format, ...)
+{
+ char *temp = NULL;
+ va_list ap;
+
+ va_start(ap, format);
+ temp = trio_vaprintf(format, ap);
+ va_end(ap);
+
+ MDFND_NetplayText(temp, false);
+ MDFNI_RollbackDisconnect();
+ free(temp);
+}
+
+static void SendData(const void *data, uint32 len)
+{
+ do
+ {
+  uint32 sent = Connection->Send(data, len);
+
+  data = (uint8*)data + sent;
+  len -= sent;
+
+  if(len)
+  {
+   if(MDFND_CheckNeedExit())
+    throw MDFN_Error(0, _("Mednafen exit pending."));
+
+   Connection->CanSend(50000);
+  }
+ } while(len);
+}
+
+static void RecvData(void *data, uint32 len)
+{
+ do
+ {
+  uint32 received = Connection->Receive(data, len);
+
+  data = (uint8*)data + received;
+  len -= received;
+
+  if(len)
+  {
+   if(MDFND_CheckNeedExit())
+    throw MDFN_Error(0, _("Mednafen exit pending."));
+
+   Connection->CanReceive(50000);
+  }
+ } while(len);
+}
+
+static InputSlot* GetSlot(const uint32 frame)
+{
+ InputSlot* s = &InputRing[frame % InputRingSize];
+
+ if(s->frame != frame)
+ {
+  s->frame = frame;
+  s->remote_valid = false;
+ }
+
+ return s;
+}
+
+static void SendLocalInput(const uint32 frame, const uint8* data)
+{
+ InputSlot* s = GetSlot(frame);
+
+ memcpy(s->local.get(), data, LocalLen);
+
+ MDFN_en32lsb(&OutgoingBuffer[0], frame);
+ memcpy(&OutgoingBuffer[4], data, LocalLen);
+ SendData(&OutgoingBuffer[0], 4 + LocalLen);
+}
+
+static void Start(const uint32 PortDevIdx[], uint8* const PortData[], const uint32 PortLen[])
+{
+ const unsigned NumPorts = MDFNGameInfo->PortInfo.size();
+ hello_t ours, theirs;
+
+ memset(&ours, 0, sizeof(ours));
+ memcpy(ours.magic, HelloMagic, sizeof(HelloMagic));
+ memcpy(ours.gameid, MDFNGameInfo->MD5, 16);
+ ours.role = !IsHost;
+ ours.total_controllers = NumPorts;
+
+ for(unsigned x = 0; x < NumPorts; x++)
+ {
+  ours.controller_type[x] = PortDevIdx[x];
+  ours.controller_data_size[x] = PortLen[x];
+ }
+
+ SendData(&ours, sizeof(ours));
+ RecvData(&theirs, sizeof(theirs));
+
+ if(memcmp(theirs.magic, HelloMagic, sizeof(HelloMagic)))
+  throw MDFN_Error(0, _("Remote peer doesn't speak the rollback netplay protocol."));
+
+ if(theirs.role == ours.role)
+  throw MDFN_Error(0, _("Remote peer has the same role as us."));
+
+ if(memcmp(theirs.gameid, ours.gameid, 16))
+  throw MDFN_Error(0, _("Remote peer is running a different game."));
+
+ if(theirs.total_controllers != ours.total_controllers || memcmp(theirs.controller_type, ours.controller_type, 16) || memcmp(theirs.controller_data_size, ours.controller_data_size, 16))
+  throw MDFN_Error(0, _("Remote peer's input device configuration differs from ours."));
+
+ LocalPort = IsHost ? 0 : 1;
+ RemotePort = IsHost ? 1 : 0;
+
+ if(PortDevIdx[0] != PortDevIdx[LocalPort])
+  throw MDFN_Error(0, _("The first and second input ports must have the same device type for rollback netplay."));
+
+ LocalLen = PortLen[LocalPort];
+ RemoteLen = PortLen[RemotePort];
+ PreUpdateLocal.reset(new uint8[LocalLen ? LocalLen : 1]());
+
+ //
+ // Synchronize emulation state.
+ //
+ if(IsHost)
+ {
+  MemoryStream st(65536);
+  uint8 len[4];
+
+  MDFNSS_SaveSM(&st);
+
+  MDFN_en32lsb(len, st.size());
+  SendData(len, 4);
+  SendData(st.map(), st.size());
+ }
+ else
+ {
+  uint8 len[4];
+  uint32 st_len;
+
+  RecvData(len, 4);
+  st_len = MDFN_de32lsb(len);
+
+  if(st_len > 64 * 1024 * 1024)
+   throw MDFN_Error(0, _("Save state from remote peer is too large."));
+
+  MemoryStream st(st_len, -1);
+
+  RecvData(st.map(), st_len);
+
+  // The port data is saved in the state too, so keep hold of the driver's local input across the load.
+  memcpy(PreUpdateLocal.get(), PortData[0], LocalLen);
+  MDFNSS_LoadSM(&st);
+  memcpy(PortData[0], PreUpdateLocal.get(), LocalLen);
+ }
+
+ //
+ //
+ //
+ InputRing.reset(new InputSlot[InputRingSize]);
+ for(uint32 i = 0; i < InputRingSize; i++)
+ {
+  InputRing[i].local.reset(new uint8[LocalLen ? LocalLen : 1]());
+  InputRing[i].remote.reset(new uint8[RemoteLen ? RemoteLen : 1]());
+  InputRing[i].used.reset(new uint8[RemoteLen ? RemoteLen : 1]());
+ }
+
+ Snapshots.reset(new Snapshot[MaxFrames]);
+ LastRemote.reset(new uint8[RemoteLen ? RemoteLen : 1]());
+ OutgoingBuffer.reset(new uint8[4 + LocalLen]);
+ IncomingBuffer.reset(new uint8[4 + RemoteLen]);
+ IncomingPos = 0;
+ Pending.clear();
+
+ CurFrame = 0;
+ ConfirmedFrame = 0;
+ NeedRollback = false;
+
+ memset(PreUpdateLocal.get(), 0, LocalLen);
+ for(uint32 frame = 0; frame < Delay; frame++)
+  SendLocalInput(frame, PreUpdateLocal.get());
+
+ if(MDFNMOV_IsPlaying() || MDFNMOV_IsRecording())
+  MDFNMOV_Stop();
+
+ Started = true;
+
+ RBPrintText(_("*** Rollback netplay session started, controlling input port %u."), LocalPort + 1);
+ MDFND_NetplaySetHints(true, false, 1U << LocalPort);
+}
+
+static void ProcessPacket(const uint8* pkt)
+{
+ const uint32 frame = MDFN_de32lsb(pkt);
+
+ if(frame != ConfirmedFrame)
+  throw MDFN_Error(0, _("Rollback netplay protocol error: expected input for frame %u, got input for frame %u."), ConfirmedFrame, frame);
+
+ if((int32)(frame - CurFrame) >= (int32)(InputRingSize / 2))
+  throw MDFN_Error(0, _("Remote peer is too far ahead."));
+
+ InputSlot* s = GetSlot(frame);
+
+ memcpy(s->remote.get(), pkt + 4, RemoteLen);
+ s->remote_valid = true;
+
+ if((int32)(frame - CurFrame) < 0 && memcmp(s->used.get(), s->remote.get(), RemoteLen))
+ {
+  // Packets arrive in frame order, so the first misprediction is the earliest one.
+  if(!NeedRollback)
+  {
+   NeedRollback = true;
+   RollbackFrame = frame;
+  }
+ }
+
+ memcpy(LastRemote.get(), s->remote.get(), RemoteLen);
+ ConfirmedFrame++;
+}
+
+static void Receive(const bool wait)
+{
+ const uint32 packet_len = 4 + RemoteLen;
+
+ if(wait)
+ {
+  if(Pending.size())
+  {
+   const int32 until_due = Pending.front().first - Time::MonoMS();
+
+   if(until_due > 0)
+    Time::SleepMS(std::min<int32>(until_due, 10));
+  }
+  else
+   Connection->CanReceive(10000);
+ }
+
+ while(Connection->CanReceive())
+ {
+  IncomingPos += Connection->Receive(&IncomingBuffer[IncomingPos], packet_len - IncomingPos);
+
+  if(IncomingPos == packet_len)
+  {
+   std::unique_ptr<uint8[]> pkt(new uint8[packet_len]);
+
+   memcpy(pkt.get(), &IncomingBuffer[0], packet_len);
+   Pending.emplace_back(Time::MonoMS() + SimLatency, std::move(pkt));
+   IncomingPos = 0;
+  }
+ }
+
+ while(Pending.size() && (int32)(Time::MonoMS() - Pending.front().first) >= 0)
+ {
+  ProcessPacket(Pending.front().second.get());
+  Pending.pop_front();
+ }
+}
+
+//
+// Sets up the port data for emulating "frame", and saves the state beforehand if the frame is emulated with predicted remote input.
+//
+static void SetupFrame(const uint32 frame, uint8* const PortData[])
+{
+ InputSlot* s = GetSlot(frame);
+
+ memcpy(s->used.get(), s->remote_valid ? s->remote.get() : LastRemote.get(), RemoteLen);
+ memcpy(PortData[LocalPort], s->local.get(), LocalLen);
+ memcpy(PortData[RemotePort], s->used.get(), RemoteLen);
+
+ if(!s->remote_valid)
+ {
+  Snapshot* ss = &Snapshots[frame % MaxFrames];
+
+  ss->frame = frame;
+  MDFNSS_SaveSMDelta(&ss->data, &ss->token);
+ }
+}
+
+static void Resimulate(const EmulateSpecStruct* espec, uint8* const PortData[])
+{
+ Snapshot* ss = &Snapshots[RollbackFrame % MaxFrames];
+ EmulateSpecStruct resim = *espec;
+
+ assert(ss->frame == RollbackFrame);
+ MDFNSS_LoadSMDelta(&ss->data, &ss->token);
+
+ resim.skip = 1;
+ resim.VideoFormatChanged = false;
+ resim.SoundFormatChanged = false;
+ resim.NeedRewind = false;
+ resim.NeedSoundReverse = false;
+
+ if(resim.SoundBuf)
+ {
+  if(ResimSoundBufMaxSize < resim.SoundBufMaxSize)
+  {
+   ResimSoundBuf.reset(new int16[resim.SoundBufMaxSize * MDFNGameInfo->soundchan]);
+   ResimSoundBufMaxSize = resim.SoundBufMaxSize;
+  }
+  resim.SoundBuf = ResimSoundBuf.get();
+ }
+
+ for(uint32 frame = RollbackFrame; frame != CurFrame; frame++)
+ {
+  SetupFrame(frame, PortData);
+
+  resim.SoundBufSize = 0;
+  resim.SoundBufSize_InternalProcessed = 0;
+  resim.MasterCycles = 0;
+  resim.MasterCycles_InternalProcessed = 0;
+
+  MDFNGameInfo->Emulate(&resim);
+ }
+
+ NeedRollback = false;
+}
+
+void Rollback_Update(EmulateSpecStruct* espec, const uint32 PortDevIdx[], uint8* const PortData[], const uint32 PortLen[])
+{
+ try
+ {
+  if(!Started)
+  {
+   if(!Connection->Established())
+    return;
+
+   Start(PortDevIdx, PortData, PortLen);
+  }
+
+  memcpy(PreUpdateLocal.get(), PortData[0], LocalLen);
+
+  Receive(false);
+  SendLocalInput(CurFrame + Delay, PortData[0]);
+
+  // Can't get further ahead of the remote input than there are snapshots to roll back to.
+  while((int32)(CurFrame - ConfirmedFrame) >= (int32)MaxFrames)
+  {
+   if(MDFND_CheckNeedExit())
+    throw MDFN_Error(0, _("Mednafen exit pending."));
+
+   Receive(true);
+  }
+
+  if(NeedRollback)
+   Resimulate(espec, PortData);
+
+  SetupFrame(CurFrame, PortData);
+  CurFrame++;
+ }
+ catch(std::exception &e)
+ {
+  RBError("%s", e.what());
+ }
+}
+
+void Rollback_PostProcess(const uint32 PortDevIdx[], uint8* const PortData[], const uint32 PortLen[])
+{
+ if(!Started)
+  return;
+
+ //
+ // Put back the switch state the driver gave us, so that the delayed and remote input doesn't feed back into it.
+ //
+ for(auto const& idii : MDFNGameInfo->PortInfo[0].DeviceInfo[PortDevIdx[0]].IDII)
+ {
+  if(idii.Type == IDIT_SWITCH)
+   BitsIntract(PortData[0], idii.BitOffset, idii.BitSize, BitsExtract(PreUpdateLocal.get(), idii.BitOffset, idii.BitSize));
+ }
+}
+
+static void BeginSession(const bool host)
+{
+ if(!MDFNGameInfo->StateAction)
+  throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
+
+ if(MDFNGameInfo->SaveStateAltersState)
+  throw MDFN_Error(0, _("Module %s is not compatible with rollback netplay."), MDFNGameInfo->shortname);
+
+ if(MDFNGameInfo->PortInfo.size() < 2)
+  throw MDFN_Error(0, _("Rollback netplay requires at least two input ports."));
+
+ IsHost = host;
+ Started = false;
+ Delay = MDFN_GetSettingUI("netplay.rollback.delay");
+ MaxFrames = MDFN_GetSettingUI("netplay.rollback.frames");
+ SimLatency = MDFN_GetSettingUI("netplay.rollback.simlatency");
+ MDFNrollback = true;
+}
+
+void MDFNI_RollbackHost(unsigned port)
+{
+ MDFNI_NetplayDisconnect();
+
+ try
+ {
+  BeginSession(true);
+  RBPrintText(_("*** Waiting for rollback netplay peer on port %u..."), port);
+  Connection = Net::Accept(port);
+ }
+ catch(std::exception &e)
+ {
+  RBError("%s", e.what());
+ }
+}
+
+void MDFNI_RollbackConnect(const char* host, unsigned port)
+{
+ MDFNI_NetplayDisconnect();
+
+ try
+ {
+  BeginSession(false);
+  RBPrintText(_("*** Connecting to rollback netplay peer %s port %u..."), host, port);
+  Connection = Net::Connect(host, port);
+ }
+ catch(std::exception &e)
+ {
+  RBError("%s", e.what());
+ }
+}
+
+void MDFNI_RollbackDisconnect(void)
+{
+ const bool had_connection = Connection != nullptr;
+
+ Connection.reset(nullptr);
+
+ InputRing.reset(nullptr);
+ Snapshots.reset(nullptr);
+ LastRemote.reset(nullptr);
+ PreUpdateLocal.reset(nullptr);
+ OutgoingBuffer.reset(nullptr);
+ IncomingBuffer.reset(nullptr);
+ Pending.clear();
+ ResimSoundBuf.reset(nullptr);
+ ResimSoundBufMaxSize = 0;
+
+ if(MDFNrollback)
+ {
+  MDFNrollback = false;
+
+  if(Started)
+   RBPrintText(_("*** Rollback netplay session ended"));
+  else if(had_connection)
+   RBPrintText(_("*** Rollback netplay connection attempt aborted"));
+
+  Started = false;
+  MDFND_NetplaySetHints(false, false, 0);
+ }
+}
+
+}
@@ -0,0 +1,36 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* netplay_rollback.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_NETPLAY_ROLLBACK_H
+#define __MDFN_NETPLAY_ROLLBACK_H
+
+namespace Mednafen
+{
+
+// Called instead of Netplay_Update() and Netplay_PostProcess() while a rollback session is active.  Rollback_Update() may re-emulate
+// previous frames with skip=1 before returning.
+void Rollback_Update(EmulateSpecStruct* espec, const uint32 PortDevIdx[], uint8* const PortData[], const uint32 PortLen[]);
+void Rollback_PostProcess(const uint32 PortDevIdx[], uint8* const PortData[], const uint32 PortLen[]);
+
+MDFN_HIDE extern bool MDFNrollback;
+
+}
+#endif
@@ -0,0 +1,277 @@
+/******************************************************************************/
+/* Mednafen NEC PC Engine Emulation Module                                    */
+/******************************************************************************/
+/* coverage.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "pce.h"
+#include "coverage.h"
+#include "huc.h"
+
+#include <mednafen/FileStream.h>
+
+#include <zlib.h>
+
+namespace MDFN_IEN_PCE
+{
+
+static const char CoverageMagic[8] = { 'M', 'D', 'F', 'N', 'P', 'C', 'E', 'C' };
+
+struct CoverageFile
+{
+ uint32 rom_size;
+ uint32 rom_crc;
+ std::vector<uint8> flags;
+};
+
+// Returns false if the file doesn't exist.
+static bool LoadCoverageFile(const std::string& path, CoverageFile* cf)
+{
+ try
+ {
+  FileStream fp(path, FileStream::MODE_READ);
+  uint8 header[20];
+
+  fp.read(header, sizeof(header));
+
+  if(memcmp(header, CoverageMagic, sizeof(CoverageMagic)))
+   throw MDFN_Error(0, _("\"%s\" is not a PC Engine coverage file."), path.c_str());
+
+  if(MDFN_de32lsb(&header[8]) != PCECoverage::FORMAT_VERSION)
+   throw MDFN_Error(0, _("PC Engine coverage file \"%s\" is an unsupported version(%u)."), path.c_str(), MDFN_de32lsb(&header[8]));
+
+  cf->rom_size = MDFN_de32lsb(&header[12]);
+  cf->rom_crc = MDFN_de32lsb(&header[16]);
+
+  if(fp.size() != sizeof(header) + (uint64)cf->rom_size)
+   throw MDFN_Error(0, _("PC Engine coverage file \"%s\" is truncated or corrupt."), path.c_str());
+
+  cf->flags.resize(cf->rom_size);
+  fp.read(cf->flags.data(), cf->flags.size());
+ }
+ catch(MDFN_Error& e)
+ {
+  if(e.GetErrno() == ENOENT)
+   return false;
+
+  throw;
+ }
+
+ return true;
+}
+
+//
+// Serializes read-merge-write cycles on the coverage file 'path' across processes(e.g. parallel regression workers
+// saving to the same file), for as long as the returned object exists.  The lock is taken on a separate file, since
+// the coverage file itself is replaced by rename.
+//
+static std::unique_ptr<FileStream> LockCoverageFile(const std::string& path)
+{
+ return std::unique_ptr<FileStream>(new FileStream(path + ".lck", FileStream::MODE_WRITE_INPLACE, true));
+}
+
+// Writes to a temporary file first, so that a coverage file is never seen half-written.
+static void SaveCoverageFile(const std::string& path, const CoverageFile& cf)
+{
+ const std::string tmp_path = path + ".tmp";
+ FileStream fp(tmp_path, FileStream::MODE_WRITE);
+ uint8 header[20];
+
+ memcpy(header, CoverageMagic, sizeof(CoverageMagic));
+ MDFN_en32lsb(&header[8], PCECoverage::FORMAT_VERSION);
+ MDFN_en32lsb(&header[12], cf.rom_size);
+ MDFN_en32lsb(&header[16], cf.rom_crc);
+
+ fp.write(header, sizeof(header));
+ fp.write(cf.flags.data(), cf.flags.size());
+ fp.close();
+
+ NVFS.rename(tmp_path, path);
+}
+
+static void MergeCoverage(CoverageFile* dest, const CoverageFile& src, const std::string& src_path)
+{
+ if(src.rom_size != dest->rom_size || src.rom_crc != dest->rom_crc)
+  throw MDFN_Error(0, _("PC Engine coverage file \"%s\" is for a different ROM image(size 0x%08x, CRC32 0x%08x; expected size 0x%08x, CRC32 0x%08x)."), src_path.c_str(), src.rom_size, src.rom_crc, dest->rom_size, dest->rom_crc);
+
+ for(size_t i = 0; i < dest->flags.size(); i++)
+  dest->flags[i] |= src.flags[i];
+}
+
+//
+//
+//
+PCECoverage::PCECoverage(const std::string& new_path) : path(new_path), ReadMap(21, 8), ExecMap(21, 8)
+{
+ uint32 rom_size;
+ const uint8* rom = HuC_GetROM(&rom_size);
+
+ if(!rom)
+  throw MDFN_Error(0, _("Code coverage is only supported for HuCard and System Card ROM images."));
+
+ rom_crc = crc32(0, rom, rom_size);
+ flags.resize(rom_size, 0);
+ fold_buf.resize(8192 * 2);
+
+ HuCPU.SetUsageMaps(HuC6280::USAGE_OWNER_COVERAGE, &ReadMap, NULL, &ExecMap);
+}
+
+PCECoverage::~PCECoverage()
+{
+ HuCPU.SetUsageMaps(HuC6280::USAGE_OWNER_COVERAGE, NULL, NULL, NULL);
+}
+
+void PCECoverage::Fold(const unsigned bank, const unsigned count)
+{
+ uint16* const exec = &fold_buf[0];
+ uint16* const read = &fold_buf[8192];
+
+ for(unsigned b = bank; b < bank + count; b++)
+ {
+  const int32 offs = HuC_GetROMOffset(b << 13);
+
+  if(offs < 0 || (uint32)offs >= flags.size())
+   continue;
+
+  // The last bank of a ROM image that isn't a multiple of 8KiB is partial.
+  const uint32 span = std::min<uint32>(8192, flags.size() - offs);
+
+  ExecMap.Export(b << 13, 8192, exec);
+  ReadMap.Export(b << 13, 8192, read);
+
+  for(unsigned i = 0; i < span; i++)
+   flags[offs + i] |= (exec[i] ? FLAG_EXEC : 0) | (read[i] ? FLAG_READ : 0);
+
+  ExecMap.Clear(b << 13, 8192);
+  ReadMap.Clear(b << 13, 8192);
+ }
+}
+
+void PCECoverage::Save(void)
+{
+ CoverageFile cf;
+ CoverageFile existing;
+
+ Fold(0x00, 0x100);
+
+ cf.rom_size = flags.size();
+ cf.rom_crc = rom_crc;
+ cf.flags = flags;
+
+ std::unique_ptr<FileStream> lock = LockCoverageFile(path);
+
+ if(LoadCoverageFile(path, &existing))
+  MergeCoverage(&cf, existing, path);
+
+ SaveCoverageFile(path, cf);
+}
+
+//
+//
+//
+static void CountFlags(const uint8* flags, const size_t count, uint32* exec, uint32* read)
+{
+ *exec = 0;
+ *read = 0;
+
+ for(size_t i = 0; i < count; i++)
+ {
+  *exec += (bool)(flags[i] & PCECoverage::FLAG_EXEC);
+  *read += (bool)(flags[i] & PCECoverage::FLAG_READ);
+ }
+}
+
+static void PrintTotals(const CoverageFile& cf, FILE* out)
+{
+ uint32 exec, read;
+ const double pct_scale = 100.0 / std::max<uint32>(1, cf.rom_size);
+
+ CountFlags(cf.flags.data(), cf.flags.size(), &exec, &read);
+
+ fprintf(out, "# ROM image: %u bytes, CRC32 0x%08x\n", cf.rom_size, cf.rom_crc);
+ fprintf(out, "# Executed: %u bytes(%.2f%%)\n", exec, exec * pct_scale);
+ fprintf(out, "# Read as data: %u bytes(%.2f%%)\n", read, read * pct_scale);
+}
+
+void PCECoverage_Merge(const std::string& out_path, const std::vector<std::string>& in_paths, FILE* out)
+{
+ std::unique_ptr<FileStream> lock = LockCoverageFile(out_path);
+ CoverageFile cf;
+ bool have = false;
+
+ for(auto const& p : in_paths)
+ {
+  CoverageFile in;
+
+  if(!LoadCoverageFile(p, &in))
+   throw MDFN_Error(ENOENT, _("PC Engine coverage file \"%s\" not found."), p.c_str());
+
+  if(!have)
+  {
+   cf = std::move(in);
+   have = true;
+  }
+  else
+   MergeCoverage(&cf, in, p);
+ }
+
+ SaveCoverageFile(out_path, cf);
+ PrintTotals(cf, out);
+}
+
+void PCECoverage_Dump(const std::string& path, FILE* out)
+{
+ CoverageFile cf;
+
+ if(!LoadCoverageFile(path, &cf))
+  throw MDFN_Error(ENOENT, _("PC Engine coverage file \"%s\" not found."), path.c_str());
+
+ PrintTotals(cf, out);
+ fprintf(out, "\n");
+
+ fprintf(out, "# ROM bank(8KiB)   executed      read\n");
+ for(uint32 b = 0; b < (cf.rom_size + 8191) / 8192; b++)
+ {
+  uint32 exec, read;
+
+  CountFlags(&cf.flags[b * 8192], std::min<uint32>(8192, cf.rom_size - b * 8192), &exec, &read);
+
+  if(exec || read)
+   fprintf(out, "    %02X(0x%06X)  %9u %9u\n", b, b * 8192, exec, read);
+ }
+ fprintf(out, "\n");
+
+ fprintf(out, "# Executed ROM offset ranges\n");
+ for(uint32 i = 0; i < cf.rom_size;)
+ {
+  if(!(cf.flags[i] & PCECoverage::FLAG_EXEC))
+  {
+   i++;
+   continue;
+  }
+
+  const uint32 start = i;
+
+  while(i < cf.rom_size && (cf.flags[i] & PCECoverage::FLAG_EXEC))
+   i++;
+
+  fprintf(out, "    0x%06X-0x%06X\n", start, i - 1);
+ }
+}
+
+}
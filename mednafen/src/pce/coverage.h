@@ -0,0 +1,80 @@
+/******************************************************************************/
+/* Mednafen NEC PC Engine Emulation Module                                    */
+/******************************************************************************/
+/* coverage.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_PCE_COVERAGE_H
+#define __MDFN_PCE_COVERAGE_H
+
+#include <mednafen/UsageMap.h>
+
+using namespace Mednafen;
+
+namespace MDFN_IEN_PCE
+{
+
+//
+// Records which bytes of the HuCard(or System Card) ROM image the HuC6280 executed and read as data.
+//
+// The CPU counts its accesses by physical address in usage maps, from the same RunSub() instantiation as the profiler
+// and tracer.  The counts are translated to ROM image offsets through the HuCard mapper only when that translation is
+// about to change(SF2 mapper bank switches, state loads) and when coverage is saved, so there's no per-access callback.
+//
+// The coverage file is the 8-byte magic "MDFNPCEC", then the 32-bit little-endian format version, ROM image size, and
+// ROM image CRC32, followed by one byte of flags(FLAG_*) per ROM image byte.  Coverage files for the same ROM image
+// merge by OR'ing their flags; saving merges with the output file's existing coverage, if any.
+//
+class PCECoverage
+{
+ public:
+
+ enum : uint32 { FORMAT_VERSION = 1 };
+ enum : uint8
+ {
+  FLAG_EXEC = 0x01,	// Executed, as an opcode or operand byte.
+  FLAG_READ = 0x02	// Read as data.
+ };
+
+ PCECoverage(const std::string& path) MDFN_COLD;
+ ~PCECoverage() MDFN_COLD;
+
+ // Translates and zeroes the counts for physical banks [bank, bank + count) under the current mapping.
+ void Fold(const unsigned bank, const unsigned count);
+
+ void Save(void) MDFN_COLD;
+
+ private:
+
+ std::string path;
+ uint32 rom_crc;
+ std::vector<uint8> flags;
+
+ UsageMap ReadMap;
+ UsageMap ExecMap;
+ std::vector<uint16> fold_buf;
+};
+
+// Merges the coverage files 'in_paths' into 'out_path'(which may be one of them), and writes a summary to 'out'.
+void PCECoverage_Merge(const std::string& out_path, const std::vector<std::string>& in_paths, FILE* out) MDFN_COLD;
+
+// Writes a per-bank summary of a coverage file, and the ROM offset ranges executed, to 'out' as text.
+void PCECoverage_Dump(const std::string& path, FILE* out) MDFN_COLD;
+
+}
+#endif
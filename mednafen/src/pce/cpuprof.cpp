@@ -0,0 +1,263 @@
+/******************************************************************************/
+/* Mednafen NEC PC Engine Emulation Module                                    */
+/******************************************************************************/
+/* cpuprof.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "pce.h"
+#include "cpuprof.h"
+
+#include <mednafen/FileStream.h>
+
+namespace MDFN_IEN_PCE
+{
+
+// Master clock cycles per scanline.
+static const unsigned CyclesPerLine = 1365;
+
+CPUProfiler::CPUProfiler()
+{
+ Start(0);
+}
+
+CPUProfiler::~CPUProfiler()
+{
+
+}
+
+void CPUProfiler::Start(const uint32 timestamp)
+{
+ for(auto& b : banks)
+  b.reset(nullptr);
+
+ memset(&dummy_counter, 0, sizeof(dummy_counter));
+ memset(&irq_entry_counter, 0, sizeof(irq_entry_counter));
+ cur = &dummy_counter;
+ last_ts = timestamp;
+ total_cycles = 0;
+
+ functions.clear();
+ edges.clear();
+
+ depth = 1;
+ stack[0].func = GetFunction(ROOT_FUNCTION, 0);
+ stack[0].edge = nullptr;
+ stack[0].entry_cycles = 0;
+ stack[0].sp = 0xFF;
+}
+
+void CPUProfiler::AllocBank(const unsigned bank)
+{
+ banks[bank].reset(new Counter[0x2000]);
+ memset(banks[bank].get(), 0, sizeof(Counter) * 0x2000);
+}
+
+CPUProfiler::Function* CPUProfiler::GetFunction(const uint32 phys_addr, const uint16 logical_addr)
+{
+ auto it = functions.find(phys_addr);
+
+ if(it == functions.end())
+ {
+  Function f;
+
+  f.phys_addr = phys_addr;
+  f.logical_addr = logical_addr;
+  f.calls = 0;
+  f.self_cycles = 0;
+  f.inclusive_cycles = 0;
+
+  it = functions.emplace(phys_addr, f).first;
+ }
+
+ return &it->second;
+}
+
+void CPUProfiler::Resync(const uint32 timestamp)
+{
+ while(depth > 1)
+  PopFrame();
+
+ cur = &dummy_counter;
+ last_ts = timestamp;
+}
+
+void CPUProfiler::PushFrame(const uint32 phys_target, const uint16 logical_target, const uint8 sp)
+{
+ //
+ // A stack pointer at or below that of the deepest frame means the program has abandoned that frame without
+ // returning(e.g. reset the stack pointer or popped the return address), so don't leave it lying around.
+ //
+ PopFrames(sp);
+
+ if(depth == MAX_DEPTH)
+  PopFrame();
+
+ Function* caller = stack[depth - 1].func;
+ Function* callee = GetFunction(phys_target, logical_target);
+ Edge* edge = &edges[((uint64)caller->phys_addr << 32) | phys_target];
+
+ callee->calls++;
+ edge->calls++;
+
+ stack[depth].func = callee;
+ stack[depth].edge = edge;
+ stack[depth].entry_cycles = total_cycles;
+ stack[depth].sp = sp;
+ depth++;
+}
+
+void CPUProfiler::Call(const uint32 phys_target, const uint16 logical_target, const uint8 sp, const uint32 timestamp)
+{
+ Sync(timestamp);
+ PushFrame(phys_target, logical_target, sp);
+}
+
+void CPUProfiler::Interrupt(const uint32 phys_target, const uint16 logical_target, const uint8 sp, const uint32 timestamp)
+{
+ PushFrame(phys_target, logical_target, sp);
+ Sync(timestamp);
+}
+
+void CPUProfiler::Return(const uint8 sp, const uint32 timestamp)
+{
+ Sync(timestamp);
+ PopFrames(sp);
+}
+
+void CPUProfiler::PopFrame(void)
+{
+ Frame* f = &stack[depth - 1];
+ const uint64 inclusive = total_cycles - f->entry_cycles;
+
+ f->func->inclusive_cycles += inclusive;
+ f->edge->inclusive_cycles += inclusive;
+ depth--;
+}
+
+void CPUProfiler::PopFrames(const uint8 sp)
+{
+ while(depth > 1 && stack[depth - 1].sp <= sp)
+  PopFrame();
+}
+
+static std::string AddrString(const uint32 phys_addr)
+{
+ char tmp[16];
+
+ trio_snprintf(tmp, sizeof(tmp), "%02X:%04X", phys_addr >> 13, phys_addr & 0x1FFF);
+
+ return tmp;
+}
+
+static std::string FuncString(const uint32 phys_addr, const uint16 logical_addr)
+{
+ char tmp[32];
+
+ if(phys_addr == 0xFFFFFFFF)
+  return "<root>";
+
+ trio_snprintf(tmp, sizeof(tmp), "%02X:%04X($%04X)", phys_addr >> 13, phys_addr & 0x1FFF, logical_addr);
+
+ return tmp;
+}
+
+void CPUProfiler::Dump(const std::string& path, const uint64 first_frame, const uint64 frame_count)
+{
+ std::vector<std::pair<uint32, const Counter*>> flat;
+ std::vector<const Function*> funcs;
+ std::vector<std::pair<uint64, const Edge*>> sorted_edges;
+ const double pct_scale = 100.0 / std::max<uint64>(1, total_cycles);
+ FileStream fp(path, FileStream::MODE_WRITE);
+
+ // Close any frames still open, so their time up to now shows up in inclusive counts.
+ while(depth > 1)
+  PopFrame();
+
+ stack[0].func->inclusive_cycles = total_cycles;
+
+ for(unsigned b = 0; b < 0x100; b++)
+ {
+  if(!banks[b])
+   continue;
+
+  for(unsigned o = 0; o < 0x2000; o++)
+  {
+   const Counter* c = &banks[b][o];
+
+   if(c->count)
+    flat.push_back(std::make_pair((b << 13) | o, c));
+  }
+ }
+
+ std::sort(flat.begin(), flat.end(), [](const std::pair<uint32, const Counter*>& a, const std::pair<uint32, const Counter*>& b) { return a.second->cycles > b.second->cycles; });
+
+ for(auto const& f : functions)
+  funcs.push_back(&f.second);
+
+ std::sort(funcs.begin(), funcs.end(), [](const Function* a, const Function* b) { return a->self_cycles > b->self_cycles; });
+
+ for(auto const& e : edges)
+  sorted_edges.push_back(std::make_pair(e.first, &e.second));
+
+ std::sort(sorted_edges.begin(), sorted_edges.end(), [](const std::pair<uint64, const Edge*>& a, const std::pair<uint64, const Edge*>& b) { return a.second->inclusive_cycles > b.second->inclusive_cycles; });
+
+ fp.print_format("# HuC6280 profile, frames %llu through %llu\n", (unsigned long long)first_frame, (unsigned long long)(first_frame + frame_count - 1));
+ fp.print_format("# Total: %llu master cycles(%.1f scanlines, %.1f per frame)\n", (unsigned long long)total_cycles, (double)total_cycles / CyclesPerLine, (double)total_cycles / CyclesPerLine / std::max<uint64>(1, frame_count));
+ fp.print_format("# Addresses are physical, bank:offset; cycles are master clock cycles, and \"stolen\" cycles(VDC/VCE wait states) are included in \"cycles\".\n");
+ fp.print_format("# Interrupt entry(IRQ1, IRQ2, and timer) is listed as \"<irq>\" in the flat profile, and counted in the handler's time in the function list.\n");
+ fp.print_format("\n");
+
+ fp.print_format("# Flat profile\n");
+ fp.print_format("#   address        cycles       %%    lines/frame       stolen     executed\n");
+ for(auto const& f : flat)
+ {
+  const Counter* c = f.second;
+
+  fp.print_format("    %s %14llu %7.3f %14.3f %12llu %12llu\n", AddrString(f.first).c_str(), (unsigned long long)c->cycles, c->cycles * pct_scale, (double)c->cycles / CyclesPerLine / std::max<uint64>(1, frame_count), (unsigned long long)c->stolen, (unsigned long long)c->count);
+ }
+
+ if(irq_entry_counter.count)
+ {
+  const Counter* c = &irq_entry_counter;
+
+  fp.print_format("    <irq>   %14llu %7.3f %14.3f %12llu %12llu\n", (unsigned long long)c->cycles, c->cycles * pct_scale, (double)c->cycles / CyclesPerLine / std::max<uint64>(1, frame_count), (unsigned long long)c->stolen, (unsigned long long)c->count);
+ }
+ fp.print_format("\n");
+
+ fp.print_format("# Functions(JSR/BSR and interrupt targets)\n");
+ fp.print_format("#   function              self       %%       inclusive       %%      calls\n");
+ for(const Function* f : funcs)
+ {
+  fp.print_format("    %-16s %14llu %7.3f %14llu %7.3f %10llu\n", FuncString(f->phys_addr, f->logical_addr).c_str(), (unsigned long long)f->self_cycles, f->self_cycles * pct_scale, (unsigned long long)f->inclusive_cycles, f->inclusive_cycles * pct_scale, (unsigned long long)f->calls);
+ }
+ fp.print_format("\n");
+
+ fp.print_format("# Call graph\n");
+ fp.print_format("#   caller           -> callee                inclusive       %%      calls\n");
+ for(auto const& e : sorted_edges)
+ {
+  const uint32 caller = e.first >> 32;
+  const uint32 callee = (uint32)e.first;
+
+  fp.print_format("    %-16s -> %-16s %14llu %7.3f %10llu\n", FuncString(caller, functions[caller].logical_addr).c_str(), FuncString(callee, functions[callee].logical_addr).c_str(), (unsigned long long)e.second->inclusive_cycles, e.second->inclusive_cycles * pct_scale, (unsigned long long)e.second->calls);
+ }
+
+ fp.close();
+}
+
+}
@@ -0,0 +1,159 @@
+/******************************************************************************/
+/* Mednafen NEC PC Engine Emulation Module                                    */
+/******************************************************************************/
+/* cpuprof.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_PCE_CPUPROF_H
+#define __MDFN_PCE_CPUPROF_H
+
+#include <unordered_map>
+
+namespace MDFN_IEN_PCE
+{
+
+//
+// Attributes every master clock cycle the HuC6280 spends to the physical(bank:offset) address of the instruction
+// it was spent in, including cycles stolen by VDC/VCE wait states, or to interrupt entry, and keeps a call graph from
+// JSR/BSR/interrupts and RTS/RTI.  The CPU calls into this directly from a separate RunSub() instantiation, so
+// profiling doesn't go through the debugger's per-instruction hook, and has no effect on emulated timing.
+//
+class CPUProfiler
+{
+ public:
+
+ CPUProfiler() MDFN_COLD;
+ ~CPUProfiler() MDFN_COLD;
+
+ // Called at the start of each instruction, with the physical address and current timestamp.
+ INLINE void Instr(const uint32 phys_pc, const uint32 timestamp)
+ {
+  Sync(timestamp);
+
+  if(MDFN_UNLIKELY(!banks[phys_pc >> 13]))
+   AllocBank(phys_pc >> 13);
+
+  cur = &banks[phys_pc >> 13][phys_pc & 0x1FFF];
+  cur->count++;
+ }
+
+ // Called at the start of interrupt entry, after Instr() for the instruction the interrupt preempted; the cycles up
+ // to Interrupt() are charged to interrupt entry instead, and that instruction's execution count is taken back.
+ INLINE void InterruptBegin(const uint32 timestamp)
+ {
+  Sync(timestamp);
+
+  cur->count--;
+  cur = &irq_entry_counter;
+  cur->count++;
+ }
+
+ // Cycles stolen from the instruction currently executing; they're also included in its cycle count.
+ INLINE void Steal(const uint32 master_cycles)
+ {
+  cur->stolen += master_cycles;
+ }
+
+ // 'sp' is the stack pointer value from before the return address was pushed.
+ void Call(const uint32 phys_target, const uint16 logical_target, const uint8 sp, const uint32 timestamp);
+
+ // Called at the end of interrupt entry; like Call(), but the entry cycles are counted in the handler's time.
+ void Interrupt(const uint32 phys_target, const uint16 logical_target, const uint8 sp, const uint32 timestamp);
+
+ // Unwinds call frames that returning to/setting stack pointer 'sp' has popped.
+ void Return(const uint8 sp, const uint32 timestamp);
+
+ // Called when the CPU state is replaced(state load, power); unwinds the call stack, which no longer matches the
+ // CPU's, and resumes counting from 'timestamp' without charging the cycles in between to anything.
+ void Resync(const uint32 timestamp) MDFN_COLD;
+
+ INLINE void RebaseTimestamp(const int32 delta)
+ {
+  last_ts += delta;
+ }
+
+ void Start(const uint32 timestamp) MDFN_COLD;
+ void Dump(const std::string& path, const uint64 first_frame, const uint64 frame_count) MDFN_COLD;
+
+ private:
+
+ // Charges the cycles since the last call to the current instruction and function.
+ INLINE void Sync(const uint32 timestamp)
+ {
+  const uint32 delta = timestamp - last_ts;
+
+  cur->cycles += delta;
+  stack[depth - 1].func->self_cycles += delta;
+  total_cycles += delta;
+  last_ts = timestamp;
+ }
+
+ struct Counter
+ {
+  uint64 cycles;
+  uint64 stolen;
+  uint64 count;
+ };
+
+ struct Function
+ {
+  uint32 phys_addr;
+  uint16 logical_addr;
+  uint64 calls;
+  uint64 self_cycles;
+  uint64 inclusive_cycles;
+ };
+
+ struct Edge
+ {
+  uint64 calls;
+  uint64 inclusive_cycles;
+ };
+
+ struct Frame
+ {
+  Function* func;
+  Edge* edge;
+  uint64 entry_cycles;
+  uint8 sp;
+ };
+
+ void AllocBank(const unsigned bank) MDFN_COLD;
+ Function* GetFunction(const uint32 phys_addr, const uint16 logical_addr);
+ void PushFrame(const uint32 phys_target, const uint16 logical_target, const uint8 sp);
+ void PopFrames(const uint8 sp);
+ void PopFrame(void);
+
+ enum : uint32 { ROOT_FUNCTION = 0xFFFFFFFF };
+ enum : unsigned { MAX_DEPTH = 256 };
+
+ std::unique_ptr<Counter[]> banks[0x100];
+ Counter dummy_counter;
+ Counter irq_entry_counter;
+ Counter* cur;
+ uint32 last_ts;
+ uint64 total_cycles;
+
+ std::unordered_map<uint32, Function> functions;
+ std::unordered_map<uint64, Edge> edges;	// (caller physical address << 32) | callee physical address
+ Frame stack[MAX_DEPTH];
+ unsigned depth;
+};
+
+}
+#endif
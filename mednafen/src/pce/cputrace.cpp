@@ -0,0 +1,244 @@
+/******************************************************************************/
+/* Mednafen NEC PC Engine Emulation Module                                    */
+/******************************************************************************/
+/* cputrace.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "pce.h"
+#include "cputrace.h"
+
+namespace MDFN_IEN_PCE
+{
+
+static const char TraceMagic[8] = { 'M', 'D', 'F', 'N', 'P', 'C', 'E', 'T' };
+
+// Instruction length, in bytes, including the opcode; undefined opcodes are treated as 1 byte long.
+const uint8 CPUTrace_InstrLength[256] =
+{
+ 1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 2, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3,
+ 3, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 1, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3,
+ 1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 2, 1, 2, 2, 2, 1, 3, 1, 1, 1, 3, 3, 3,
+ 1, 2, 1, 1, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 7, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3,
+ 2, 2, 1, 3, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 4, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 3, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 4, 2, 2, 2, 2, 1, 3, 1, 1, 3, 3, 3, 3,
+ 2, 2, 1, 7, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 7, 1, 2, 2, 2, 1, 3, 1, 1, 1, 3, 3, 3,
+ 2, 2, 1, 7, 2, 2, 2, 2, 1, 2, 1, 1, 3, 3, 3, 3,
+ 2, 2, 2, 7, 1, 2, 2, 2, 1, 3, 1, 1, 1, 3, 3, 3,
+};
+
+// Fast compression; the record encoding already removes most of the redundancy, and the trace is written while
+// emulating.
+CPUTracer::CPUTracer(const std::string& path) : fp(path, GZFileStream::MODE::WRITE, 1)
+{
+ last_ts = 0;
+ first = true;
+ next_PC = 0;
+ memset(regs, 0, sizeof(regs));
+ buf_pos = 0;
+
+ memcpy(buf, TraceMagic, sizeof(TraceMagic));
+ MDFN_en32lsb(&buf[8], FORMAT_VERSION);
+ buf_pos = 12;
+}
+
+CPUTracer::~CPUTracer()
+{
+
+}
+
+void CPUTracer::Start(const uint32 timestamp)
+{
+ last_ts = timestamp;
+}
+
+void CPUTracer::Flush(void)
+{
+ fp.write(buf, buf_pos);
+ buf_pos = 0;
+}
+
+void CPUTracer::Close(void)
+{
+ Flush();
+ fp.close();
+}
+
+void CPUTracer::Instr(const uint16 PC, const uint8 bank, const uint8 A, const uint8 X, const uint8 Y, const uint8 P, const uint8 S, const uint32 timestamp)
+{
+ const uint8 nregs[6] = { bank, A, X, Y, P, S };
+ uint8 op[7];
+ unsigned len;
+ uint8* flags;
+
+ if(MDFN_UNLIKELY(buf_pos > (sizeof(buf) - 32)))
+  Flush();
+
+ PCE_InDebug++;
+ op[0] = HuCPU.PeekLogical(PC);
+ len = CPUTrace_InstrLength[op[0]];
+ for(unsigned i = 1; i < len; i++)
+  op[i] = HuCPU.PeekLogical(PC + i);
+ PCE_InDebug--;
+
+ flags = &buf[buf_pos++];
+ *flags = 0;
+
+ if(first || PC != next_PC)
+ {
+  *flags |= 0x01;
+  MDFN_en16lsb(&buf[buf_pos], PC);
+  buf_pos += 2;
+ }
+
+ for(unsigned i = 0; i < 6; i++)
+ {
+  if(first || nregs[i] != regs[i])
+  {
+   *flags |= 0x02 << i;
+   buf[buf_pos++] = nregs[i];
+   regs[i] = nregs[i];
+  }
+ }
+
+ WriteVarint(timestamp - last_ts);
+ last_ts = timestamp;
+
+ memcpy(&buf[buf_pos], op, len);
+ buf_pos += len;
+
+ next_PC = PC + len;
+ first = false;
+}
+
+void CPUTracer::Interrupt(const uint16 vector, const uint32 timestamp)
+{
+ if(MDFN_UNLIKELY(buf_pos > (sizeof(buf) - 32)))
+  Flush();
+
+ buf[buf_pos++] = 0x80;
+ buf[buf_pos++] = vector;
+ WriteVarint(timestamp - last_ts);
+ last_ts = timestamp;
+}
+
+//
+//
+//
+static uint8 ReadByte(GZFileStream* fp)
+{
+ const int c = fp->get_char();
+
+ if(c < 0)
+  throw MDFN_Error(0, _("Unexpected end of CPU trace."));
+
+ return c;
+}
+
+static uint32 ReadVarint(GZFileStream* fp)
+{
+ uint32 ret = 0;
+ unsigned shift = 0;
+ uint8 b;
+
+ do
+ {
+  if(shift >= 32)
+   throw MDFN_Error(0, _("Malformed CPU trace."));
+
+  b = ReadByte(fp);
+  ret |= (uint32)(b & 0x7F) << shift;
+  shift += 7;
+ } while(b & 0x80);
+
+ return ret;
+}
+
+void CPUTrace_Dump(const std::string& path, FILE* out)
+{
+ GZFileStream fp(path, GZFileStream::MODE::READ);
+ uint8 header[12];
+ uint64 cycles = 0;
+ uint16 PC = 0;
+ uint8 regs[6] = { 0 };	// bank, A, X, Y, P, S
+ int c;
+
+ fp.read(header, sizeof(header));
+
+ if(memcmp(header, TraceMagic, sizeof(TraceMagic)))
+  throw MDFN_Error(0, _("Not a PC Engine CPU trace file."));
+
+ if(MDFN_de32lsb(&header[8]) != CPUTracer::FORMAT_VERSION)
+  throw MDFN_Error(0, _("Unsupported PC Engine CPU trace version %u."), MDFN_de32lsb(&header[8]));
+
+ fprintf(out, "#      cycles  bank:PC    bytes                 A  X  Y  P  S\n");
+
+ while((c = fp.get_char()) >= 0)
+ {
+  const uint8 flags = c;
+
+  if(flags & 0x80)
+  {
+   const uint8 vector = ReadByte(&fp);
+
+   cycles += ReadVarint(&fp);
+   fprintf(out, "%14llu  interrupt  $FF%02X\n", (unsigned long long)cycles, vector);
+  }
+  else
+  {
+   uint8 op[7];
+   char opstr[7 * 3 + 1];
+   unsigned len;
+
+   if(flags & 0x01)
+   {
+    PC = ReadByte(&fp);
+    PC |= ReadByte(&fp) << 8;
+   }
+
+   for(unsigned i = 0; i < 6; i++)
+   {
+    if(flags & (0x02 << i))
+     regs[i] = ReadByte(&fp);
+   }
+
+   cycles += ReadVarint(&fp);
+
+   op[0] = ReadByte(&fp);
+   len = CPUTrace_InstrLength[op[0]];
+   for(unsigned i = 1; i < len; i++)
+    op[i] = ReadByte(&fp);
+
+   opstr[0] = 0;
+   for(unsigned i = 0; i < len; i++)
+    trio_snprintf(opstr + i * 3, sizeof(opstr) - i * 3, "%02X ", op[i]);
+
+   fprintf(out, "%14llu  %02X:%04X    %-21s %02X %02X %02X %02X %02X\n", (unsigned long long)cycles, regs[0], PC, opstr, regs[1], regs[2], regs[3], regs[4], regs[5]);
+
+   PC += len;
+  }
+ }
+}
+
+}
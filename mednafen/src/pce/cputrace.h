@@ -0,0 +1,105 @@
+/******************************************************************************/
+/* Mednafen NEC PC Engine Emulation Module                                    */
+/******************************************************************************/
+/* cputrace.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_PCE_CPUTRACE_H
+#define __MDFN_PCE_CPUTRACE_H
+
+#include <mednafen/compress/GZFileStream.h>
+
+using namespace Mednafen;
+
+namespace MDFN_IEN_PCE
+{
+
+//
+// Records every instruction the HuC6280 executes to a gzip-compressed binary log.
+//
+// The (uncompressed) log starts with the 8-byte magic "MDFNPCET" and a 32-bit little-endian version number, followed by
+// records that each start with a flags byte:
+//
+//  Instruction record(flags bit 7 clear); fields are present in this order:
+//   bit 0 set: PC(16-bit little-endian); if clear, PC is the previous instruction's PC plus its length.
+//   bit 1 set: MPR bank PC is in; if clear, the same as the previous instruction's.
+//   bits 2-6 set: A, X, Y, P, S respectively, each 8 bits; if clear, the same as the previous instruction's.
+//   Master cycles since the previous record, as an unsigned LEB128 varint.
+//   The instruction's opcode and operand bytes; the length is implied by the opcode(CPUTrace_InstrLength[]).
+//
+//  Interrupt/reset record(flags == 0x80):
+//   The low byte of the vector address(0xF6, 0xF8, 0xFA, or 0xFE).
+//   Master cycles since the previous record, as an unsigned LEB128 varint.
+//
+// Register values are as of the start of the instruction.  The first instruction record has all its fields present.  An
+// interrupt record sits between the last instruction executed before the interrupt and the first one of its handler.
+//
+class CPUTracer
+{
+ public:
+
+ enum : uint32 { FORMAT_VERSION = 1 };
+
+ // Opens(creates) the trace file; nothing past the header is recorded until Start() is called.
+ CPUTracer(const std::string& path) MDFN_COLD;
+ ~CPUTracer() MDFN_COLD;
+
+ void Start(const uint32 timestamp) MDFN_COLD;
+
+ void Instr(const uint16 PC, const uint8 bank, const uint8 A, const uint8 X, const uint8 Y, const uint8 P, const uint8 S, const uint32 timestamp);
+ void Interrupt(const uint16 vector, const uint32 timestamp);
+
+ INLINE void RebaseTimestamp(const int32 delta)
+ {
+  last_ts += delta;
+ }
+
+ void Close(void) MDFN_COLD;
+
+ private:
+
+ INLINE void WriteVarint(uint32 v)
+ {
+  while(v >= 0x80)
+  {
+   buf[buf_pos++] = 0x80 | (v & 0x7F);
+   v >>= 7;
+  }
+  buf[buf_pos++] = v;
+ }
+
+ void Flush(void);
+
+ GZFileStream fp;
+ uint32 last_ts;
+
+ bool first;
+ uint16 next_PC;
+ uint8 regs[6];	// bank, A, X, Y, P, S
+
+ uint32 buf_pos;
+ uint8 buf[65536];
+};
+
+MDFN_HIDE extern const uint8 CPUTrace_InstrLength[256];
+
+// Writes a trace as text, one line per record.
+void CPUTrace_Dump(const std::string& path, FILE* out) MDFN_COLD;
+
+}
+#endif
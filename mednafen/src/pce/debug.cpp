@@ -104,14 +104,124 @@ static bool BTEnabled;
 //
 
 
-typedef struct __PCE_BPOINT 
+//
+// Read/write/aux breakpoint address ranges, flattened into a bitmap with one bit per address, so that testing
+// an access costs the same regardless of how many breakpoints are set.  Addresses at or above the bitmap's
+// size(which the emulated hardware doesn't generate, but a user can enter) are kept as a list of ranges instead.
+//
+class BPMap
 {
-        unsigned int A[2];
-        int type;
-        bool logical;
-} PCE_BPOINT;
+ public:
+
+ BPMap(const unsigned addr_bits) : limit((uint32)1 << addr_bits), used(false)
+ {
+
+ }
+
+ void Add(uint32 A1, uint32 A2)
+ {
+  if(A1 > A2)
+   return;
+
+  used = true;
+
+  if(A2 >= limit)
+  {
+   overflow.push_back(std::make_pair(std::max<uint32>(A1, limit), A2));
+
+   if(A1 >= limit)
+    return;
+
+   A2 = limit - 1;
+  }
+
+  if(!bitmap.size())
+   bitmap.resize(limit / 64, 0);
+
+  for(uint32 A = A1; A <= A2;)
+  {
+   const unsigned shift = A & 63;
+   const uint32 count = std::min<uint32>(64 - shift, A2 - A + 1);
+
+   bitmap[A >> 6] |= (~(uint64)0 >> (64 - count)) << shift;
+   A += count;
+  }
+ }
+
+ void Clear(void)
+ {
+  std::vector<uint64>().swap(bitmap);
+  overflow.clear();
+  used = false;
+ }
+
+ INLINE bool Used(void) const
+ {
+  return used;
+ }
+
+ INLINE bool Test(const uint32 A) const
+ {
+  if(MDFN_LIKELY(A < limit))
+   return bitmap.size() && ((bitmap[A >> 6] >> (A & 63)) & 1);
+
+  return TestOverflow(A, A);
+ }
+
+ // Tests [A, A + len).
+ bool TestRange(const uint32 A, const uint32 len) const
+ {
+  if(!len)
+   return false;
+
+  const uint64 end = (uint64)A + len - 1;
+
+  if(A < limit && bitmap.size())
+  {
+   const uint32 last = std::min<uint64>(end, limit - 1);
+
+   for(uint32 i = A; i <= last;)
+   {
+    const unsigned shift = i & 63;
+    const uint32 count = std::min<uint32>(64 - shift, last - i + 1);
+
+    if(bitmap[i >> 6] & ((~(uint64)0 >> (64 - count)) << shift))
+     return true;
+
+    i += count;
+   }
+  }
 
-static std::vector<PCE_BPOINT> BreakPointsRead, BreakPointsWrite, BreakPointsAux0Read, BreakPointsAux0Write;
+  if(end >= limit)
+   return TestOverflow(std::max<uint32>(A, limit), (uint32)std::min<uint64>(end, 0xFFFFFFFF));
+
+  return false;
+ }
+
+ private:
+
+ bool TestOverflow(const uint32 A1, const uint32 A2) const
+ {
+  for(auto const& r : overflow)
+  {
+   if(r.first <= A2 && r.second >= A1)
+    return true;
+  }
+
+  return false;
+ }
+
+ std::vector<uint64> bitmap;
+ std::vector<std::pair<uint32, uint32>> overflow;
+ const uint32 limit;
+ bool used;
+};
+
+// Physical(21-bit) and logical(16-bit) read and write breakpoints, and VDC VRAM(which_vdc << 16) and
+// register(0x20000 | (which_vdc << 16)) aux breakpoints.
+static BPMap BreakPointsReadPhys(21), BreakPointsReadLogical(16);
+static BPMap BreakPointsWritePhys(21), BreakPointsWriteLogical(16);
+static BPMap BreakPointsAux0Read(18), BreakPointsAux0Write(18);
 
 static uint8 BreakPointsPC[65536 / 8];
 static bool BreakPointsPCUsed;
@@ -219,46 +329,19 @@ static INLINE bool TestPCBP(uint16 PC)
 
 void PCEDBG_CheckBP(int type, uint32 address, unsigned int len)
 {
- std::vector<PCE_BPOINT>::iterator bpit, bpit_end;
+ bool found = false;
 
  if(type == BPOINT_READ)
- {
-  bpit = BreakPointsRead.begin();
-  bpit_end = BreakPointsRead.end();
- }
+  found = BreakPointsReadPhys.TestRange(address, len) || BreakPointsReadLogical.TestRange(address, len);
  else if(type == BPOINT_WRITE)
- {
-  bpit = BreakPointsWrite.begin();
-  bpit_end = BreakPointsWrite.end();
- }
+  found = BreakPointsWritePhys.TestRange(address, len) || BreakPointsWriteLogical.TestRange(address, len);
  else if(type == BPOINT_AUX_READ)
- {
-  bpit = BreakPointsAux0Read.begin();
-  bpit_end = BreakPointsAux0Read.end();
- }
+  found = BreakPointsAux0Read.TestRange(address, len);
  else if(type == BPOINT_AUX_WRITE)
- {
-  bpit = BreakPointsAux0Write.begin();
-  bpit_end = BreakPointsAux0Write.end();
- }
- else
-  return;
-
- for(; bpit != bpit_end; bpit++)
- {
-  uint32 tmp_address = address;
-  uint32 tmp_len = len;
+  found = BreakPointsAux0Write.TestRange(address, len);
 
-  while(tmp_len--)
-  {
-   if(tmp_address >= bpit->A[0] && tmp_address <= bpit->A[1])
-   {
-    FoundBPoint = true;
-    break;
-   }
-   tmp_address++;
-  }
- }
+ if(found)
+  FoundBPoint = true;
 }
 
 
@@ -390,7 +473,7 @@ static bool CPUHandler(uint32 PC)
  CPUCBContinuous |= FoundBPoint;
  if(CPUCBContinuous && CPUCB)
  {
-  vce->Update(HuCPU.Timestamp());
+  PCE_ForceEventUpdates(HuCPU.Timestamp());
   CPUCB(PC, FoundBPoint);
  }
 
@@ -959,9 +1042,7 @@ static int32 FindInMem(uint16 StartAddr, uint16 EndAddr, uint8 *buf, uint16 LenB
 
 static DECLFR(ReadHandler)
 {
- std::vector<PCE_BPOINT>::iterator bpit;
-
- if((A & 0x1FFFFF) >= (0xFF * 8192) && (A & 0x1FFFFF) <= (0xFF * 8192 + 0x3FF))
+ if((BreakPointsAux0Read.Used() || BreakPointsAux0Write.Used()) && (A & 0x1FFFFF) >= (0xFF * 8192) && (A & 0x1FFFFF) <= (0xFF * 8192 + 0x3FF))
  {
   VDC_SimulateResult result;
 
@@ -977,25 +1058,15 @@ static DECLFR(ReadHandler)
    PCEDBG_CheckBP(BPOINT_AUX_READ, 0x20000 | (which_vdc << 16) | result.RegRWIndex, 1);
  }
 
- for(bpit = BreakPointsRead.begin(); bpit != BreakPointsRead.end(); bpit++)
- {
-  unsigned int testA = bpit->logical ? ShadowCPU.GetLastLogicalReadAddr() : A;
-
-  if(testA >= bpit->A[0] && testA <= bpit->A[1])
-  {
-   FoundBPoint = 1;
-   break;
-  }
- }
+ if(BreakPointsReadPhys.Test(A) || BreakPointsReadLogical.Test(ShadowCPU.GetLastLogicalReadAddr()))
+  FoundBPoint = 1;
 
  return(HuCPU.PeekPhysical(A));
 }
 
 static DECLFW(WriteHandler)
 {
- std::vector<PCE_BPOINT>::iterator bpit;
-
- if((A & 0x1FFFFF) >= (0xFF * 8192) && (A & 0x1FFFFF) <= (0xFF * 8192 + 0x3FF))
+ if((BreakPointsAux0Read.Used() || BreakPointsAux0Write.Used()) && (A & 0x1FFFFF) >= (0xFF * 8192) && (A & 0x1FFFFF) <= (0xFF * 8192 + 0x3FF))
  {
   VDC_SimulateResult result;
 
@@ -1011,36 +1082,19 @@ static DECLFW(WriteHandler)
    PCEDBG_CheckBP(BPOINT_AUX_WRITE, 0x20000 | (which_vdc << 16) | result.RegRWIndex, 1);
  }
 
-
- for(bpit = BreakPointsWrite.begin(); bpit != BreakPointsWrite.end(); bpit++)
- {
-  unsigned int testA;
-
-  if(!bpit->logical)
-   testA = A;
-  else
-  {
-   if(A & 0x80000000) continue;		// Ignore ST0/ST1/ST2 writes, which always use hardcoded physical addresses.
-
-   testA = ShadowCPU.GetLastLogicalWriteAddr();
-  }
-
-  if(testA >= bpit->A[0] && testA <= bpit->A[1])
-  {
-   FoundBPoint = 1;
-   break;
-  }
- }
+ // Logical breakpoints ignore ST0/ST1/ST2 writes, which always use hardcoded physical addresses.
+ if(BreakPointsWritePhys.Test(A) || (!(A & 0x80000000) && BreakPointsWriteLogical.Test(ShadowCPU.GetLastLogicalWriteAddr())))
+  FoundBPoint = 1;
 }
 
 static void RedoDH(void)
 {
  bool BPointsUsed;
 
- NeedExecSimu = BreakPointsRead.size() || BreakPointsWrite.size() || BreakPointsAux0Read.size() || BreakPointsAux0Write.size();
+ NeedExecSimu = BreakPointsReadPhys.Used() || BreakPointsReadLogical.Used() || BreakPointsWritePhys.Used() || BreakPointsWriteLogical.Used() ||
+		BreakPointsAux0Read.Used() || BreakPointsAux0Write.Used();
 
- BPointsUsed = BreakPointsPCUsed || BreakPointsOpUsed || BreakPointsRead.size() || BreakPointsWrite.size() || 
-		BreakPointsAux0Read.size() || BreakPointsAux0Write.size();
+ BPointsUsed = BreakPointsPCUsed || BreakPointsOpUsed || NeedExecSimu;
 
  if(BPointsUsed || CPUCB || PCE_LoggingOn)
   HuCPU.SetCPUHook(CPUHandler, BTEnabled ? AddBranchTrace : NULL);
@@ -1050,17 +1104,10 @@ static void RedoDH(void)
 
 void PCEDBG_AddBreakPoint(int type, unsigned int A1, unsigned int A2, bool logical)
 {
- PCE_BPOINT tmp;
-
- tmp.A[0] = A1;
- tmp.A[1] = A2;
- tmp.type =type;
- tmp.logical = logical;
-
  if(type == BPOINT_READ)
-  BreakPointsRead.push_back(tmp);
+  (logical ? BreakPointsReadLogical : BreakPointsReadPhys).Add(A1, A2);
  else if(type == BPOINT_WRITE)
-  BreakPointsWrite.push_back(tmp);
+  (logical ? BreakPointsWriteLogical : BreakPointsWritePhys).Add(A1, A2);
  else if(type == BPOINT_PC)
  {
   for(unsigned int i = A1; i <= A2; i++)
@@ -1073,9 +1120,9 @@ void PCEDBG_AddBreakPoint(int type, unsigned int A1, unsigned int A2, bool logic
   }
  }
  else if(type == BPOINT_AUX_READ)
-  BreakPointsAux0Read.push_back(tmp);
+  BreakPointsAux0Read.Add(A1, A2);
  else if(type == BPOINT_AUX_WRITE)
-  BreakPointsAux0Write.push_back(tmp);
+  BreakPointsAux0Write.Add(A1, A2);
  else if(type == BPOINT_OP)
  {
   for(unsigned int i = A1; i <= A2; i++)
@@ -1093,21 +1140,25 @@ void PCEDBG_AddBreakPoint(int type, unsigned int A1, unsigned int A2, bool logic
 
 void PCEDBG_FlushBreakPoints(int type)
 {
- std::vector<PCE_BPOINT>::iterator bpit;
-
  if(type == BPOINT_READ)
-  BreakPointsRead.clear();
+ {
+  BreakPointsReadPhys.Clear();
+  BreakPointsReadLogical.Clear();
+ }
  else if(type == BPOINT_WRITE)
-  BreakPointsWrite.clear();
+ {
+  BreakPointsWritePhys.Clear();
+  BreakPointsWriteLogical.Clear();
+ }
  else if(type == BPOINT_PC)
  {
   memset(BreakPointsPC, 0, sizeof(BreakPointsPC));
   BreakPointsPCUsed = false;
  }
  else if(type == BPOINT_AUX_READ)
-  BreakPointsAux0Read.clear();
+  BreakPointsAux0Read.Clear();
  else if(type == BPOINT_AUX_WRITE)
-  BreakPointsAux0Write.clear();
+  BreakPointsAux0Write.Clear();
  else if(type == BPOINT_OP)
  {
   memset(BreakPointsOp, 0, sizeof(BreakPointsOp));
@@ -1752,6 +1803,10 @@ static void PutAddressSpaceBytes(const char *name, uint32 Address, uint32 Length
  else if(!strncmp(name, "psgram", 6))
   psg->PokeWave(name[6] - '0', Address, Length, Buffer);
 
+ // High-level pokes bypass the write handlers.
+ if(hl)
+  StateDirtyMap::MarkAllMaps();
+
  PCE_InDebug--;
 }
 
@@ -1788,6 +1843,12 @@ DebuggerInfoStruct PCEDBGInfo =
  PCEDBG_SetLogFunc,
 };
 
+// The CPU counts its own accesses, so the usage maps see reads through the fast-read pages too.
+static void EnableUsageMap_Physical(UsageMap* read_map, UsageMap* write_map, UsageMap* exec_map)
+{
+ HuCPU.SetUsageMaps(HuC6280::USAGE_OWNER_DEBUGGER, read_map, write_map, exec_map);
+}
+
 static void Cleanup(void)
 {
 
@@ -1835,7 +1896,27 @@ void PCEDBG_Init(bool sgx, PCE_PSG *new_psg, const uint32 vram_size)
    MDFNDBG_AddRegGroup(&RegsGroup_SGXVDC);
 
   ASpace_Add(GetAddressSpaceBytes, PutAddressSpaceBytes, "cpu", "CPU Logical", 16, 0, true);
-  ASpace_Add(GetAddressSpaceBytes, PutAddressSpaceBytes, "physical", "CPU Physical", 21, 0, true);
+  {
+   AddressSpaceType newt;
+
+   newt.GetAddressSpaceBytes = GetAddressSpaceBytes;
+   newt.PutAddressSpaceBytes = PutAddressSpaceBytes;
+
+   newt.name = "physical";
+   newt.long_name = "CPU Physical";
+   newt.TotalBits = 21;
+   newt.NP2Size = 0;
+   newt.PossibleSATB = true;
+
+   newt.Wordbytes  = 1;
+   newt.Endianness = ENDIAN_LITTLE;
+   newt.MaxDigit   = 1;
+   newt.IsPalette  = false;
+
+   newt.EnableUsageMap = EnableUsageMap_Physical;
+
+   ASpace_Add(newt);
+  }
   ASpace_Add(GetAddressSpaceBytes, PutAddressSpaceBytes, "ram", "RAM", IsSGX ? 15 : 13, 0, true);
 
   ASpace_AddPalette(Do16BitGet, Do16BitPut, "pram", "VCE Palette RAM", 10, 0, false, 2, ENDIAN_LITTLE, PALETTE_PCE);
@@ -29,10 +29,7 @@ void PCEDBG_SetLogFunc(void (*func)(const char *, const char *));
 void PCEDBG_DoLog(const char *type, const char *format, ...);
 char *PCEDBG_ShiftJIS_to_UTF8(const uint16 sjc);
 
-void PCEDBG_EnableUsageMap(bool);
-
 MDFN_HIDE extern bool PCE_LoggingOn;
-MDFN_HIDE extern bool PCE_UsageMapOn;
 
 MDFN_HIDE extern DebuggerInfoStruct PCEDBGInfo;
 
@@ -39,7 +39,9 @@ ArcadeCard *arcade_card = NULL;
 
 static MCGenjin *mcg = NULL;
 static uint8 *HuCROM = NULL;
+static uint32 HuCROMSize;
 static uint8 *ROMMap[0x100] = { NULL };
+static void (*MapperChangeCB)(unsigned bank, unsigned count) = NULL;
 
 static bool IsPopulous;
 bool IsTsushin;
@@ -50,8 +52,10 @@ static uint8 *PopRAM = NULL; // 0x8000
 static uint8 SaveRAM[2048];
 static uint8 MB128RAM[131072];
 static uint8 *CDRAM = NULL; //262144;
+static StateDirtyMap CDRAMDirty;
 
 static uint8 *SysCardRAM = NULL;
+static StateDirtyMap SysCardRAMDirty;
 
 static void Cleanup(void)
 {
@@ -60,6 +64,7 @@ static void Cleanup(void)
   delete[] HuCROM;
   HuCROM = NULL;
  }
+ HuCROMSize = 0;
 
  if(PopRAM)
  {
@@ -73,6 +78,9 @@ static void Cleanup(void)
   TsushinRAM = NULL;
  }
 
+ CDRAMDirty.Kill();
+ SysCardRAMDirty.Kill();
+
  if(CDRAM)
  {
   delete[] CDRAM;
@@ -112,6 +120,7 @@ static DECLFW(AC_PhysWrite)
 static DECLFW(SysCardRAMWrite)
 {
  SysCardRAM[A - 0x50 * 8192] = V;
+ SysCardRAMDirty.Mark(A - 0x50 * 8192);
 }
 
 static DECLFR(SysCardRAMRead)
@@ -122,6 +131,7 @@ static DECLFR(SysCardRAMRead)
 static DECLFW(CDRAMWrite)
 {
  CDRAM[A - 0x80 * 8192] = V;
+ CDRAMDirty.Mark(A - 0x80 * 8192);
 }
 
 static DECLFR(CDRAMRead)
@@ -159,6 +169,7 @@ static DECLFW(HuCRAMWrite)
  ROMMap[A >> 13][A] = V;
 }
 
+static bool IsSF2;
 static uint8 HuCSF2Latch;
 static uint8 HuCSF2BankMask;
 
@@ -172,10 +183,19 @@ static DECLFR(HuCSF2Read)
  return(HuCROM[(A & 0x7FFFF) + 0x80000 + (HuCSF2Latch & HuCSF2BankMask) * 0x80000 ]);
 }
 
+static void SF2LatchChanging(const uint8 new_latch)
+{
+ if(MapperChangeCB && ((HuCSF2Latch ^ new_latch) & HuCSF2BankMask))
+  MapperChangeCB(0x40, 0x40);
+}
+
 static DECLFW(HuCSF2Write)
 {
  if((A & 0x1FF0) == 0x1FF0)
+ {
+  SF2LatchChanging(A & 0xF);
   HuCSF2Latch = A & 0xF;
+ }
 }
 
 static DECLFR(MCG_ReadHandler)
@@ -265,6 +285,7 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
   }
 
   IsPopulous = 0;
+  IsSF2 = false;
   PCE_IsCD = 0;
 
   if(syscard != SYSCARD_NONE)
@@ -280,6 +301,7 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
     HuCPU.SetWriteHandler(x, CDRAMWrite);
    }
    MDFNMP_AddRAM(8 * 8192, 0x80 * 8192, CDRAM);
+   CDRAMDirty.Init(CDRAM, 8 * 8192);
 
    UseBRAM = true;
   }
@@ -316,6 +338,7 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
   }
 
   HuCROM = new uint8[m_len];
+  HuCROMSize = m_len;
   memset(HuCROM, 0xFF, m_len);
   s->read(HuCROM, std::min<uint64>(m_len, len));
   crc = crc32(0, HuCROM, std::min<uint64>(m_len, len));
@@ -398,6 +421,7 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
      HuCPU.SetWriteHandler(x, SysCardRAMWrite);
     } 
     MDFNMP_AddRAM(48 * 8192, 0x50 * 8192, SysCardRAM); 
+    SysCardRAMDirty.Init(SysCardRAM, 48 * 8192);
    }
 
    if(syscard == SYSCARD_ARCADE)
@@ -471,6 +495,7 @@ uint32 HuC_Load(Stream* s, bool DisableBRAM, SysCardType syscard)
 
     MDFN_printf("Street Fighter 2 Mapper\n");
     HuCSF2Latch = 0;
+    IsSF2 = true;
    }
   }	// end else to if(syscard)
 
@@ -545,6 +570,10 @@ bool IsBRAMUsed(void)
 
 void HuC_StateAction(StateMem *sm, const unsigned load, const bool data_only)
 {
+ // The latch may change under us on load.
+ if(load && IsSF2 && MapperChangeCB)
+  MapperChangeCB(0x40, 0x40);
+
  SFORMAT StateRegs[] =
  {
   SFPTR8(PopRAM, IsPopulous ? 32768 : 0, SFORMAT::FORM::NVMEM),
@@ -651,12 +680,46 @@ void HuC_Power(void)
  if(arcade_card)
   arcade_card->Power();
 
+ SF2LatchChanging(0);
  HuCSF2Latch = 0;
 
  if(mcg)
   mcg->Power();
 }
 
+const uint8* HuC_GetROM(uint32* size)
+{
+ *size = HuCROMSize;
+
+ return HuCROM;
+}
+
+int32 HuC_GetROMOffset(uint32 A)
+{
+ const unsigned bank = (A >> 13) & 0xFF;
+
+ if(!HuCROM)
+  return -1;
+
+ if(IsSF2 && bank >= 0x40 && bank < 0x80)
+  return (A & 0x7FFFF) + 0x80000 + (HuCSF2Latch & HuCSF2BankMask) * 0x80000;
+
+ if(!ROMMap[bank])
+  return -1;
+
+ const uintptr_t p = (uintptr_t)(ROMMap[bank] + (A & 0x1FFFFF));
+
+ if(p < (uintptr_t)HuCROM || p >= (uintptr_t)HuCROM + HuCROMSize)
+  return -1;
+
+ return p - (uintptr_t)HuCROM;
+}
+
+void HuC_SetMapperChangeCallback(void (*cb)(unsigned bank, unsigned count))
+{
+ MapperChangeCB = cb;
+}
+
 
 bool HuC_IsBRAMAvailable(void)
 {
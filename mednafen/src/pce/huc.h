@@ -38,6 +38,15 @@ void HuC_PokeBRAM(uint32 A, uint8 V);
 bool HuC_IsMB128Available(void);
 uint8 HuC_PeekMB128(uint32 A);
 void HuC_PokeMB128(uint32 A, uint8 V);
+
+// Code coverage support functions.
+//
+// HuC_GetROM() returns NULL if there's no ROM image mapped directly into the physical address space(e.g. MCGenjin).
+// HuC_GetROMOffset() returns the offset into that ROM image that physical address A currently maps to, or -1.
+// The mapper change callback is called just before the ROM offsets of physical banks [bank, bank + count) change.
+const uint8* HuC_GetROM(uint32* size);
+int32 HuC_GetROMOffset(uint32 A);
+void HuC_SetMapperChangeCallback(void (*cb)(unsigned bank, unsigned count));
 };
 
 #endif
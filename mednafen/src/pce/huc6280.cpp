@@ -52,17 +52,32 @@ INLINE void HuC6280::LastCycle(void)
 
 void HuC6280::StealCycle(void)
 {
+ const uint32 ts = timestamp;
+
  ADDCYC(1);
+
+ if(Profiler)
+  Profiler->Steal(timestamp - ts);
 }
 
 void HuC6280::StealCycles(const int count)
 {
+ const uint32 ts = timestamp;
+
  ADDCYC(count);
+
+ if(Profiler)
+  Profiler->Steal(timestamp - ts);
 }
 
 void HuC6280::StealMasterCycles(const int count)
 {
+ const uint32 ts = timestamp;
+
  ADDCYC_MASTER(count);
+
+ if(Profiler)
+  Profiler->Steal(timestamp - ts);
 }
 
 void HuC6280::FlushMPRCache(void)
@@ -71,17 +86,19 @@ void HuC6280::FlushMPRCache(void)
   SetMPR(x, MPR[x & 0x7]);
 }
 
+template<bool InstrumentMode>
 INLINE void HuC6280::PUSH(const uint8 V)
 {
- WrMem(0x2100 | S, V);
+ WrMem<InstrumentMode>(0x2100 | S, V);
  S--;
 }       
 
+template<bool InstrumentMode>
 INLINE uint8 HuC6280::POP(void)
 {
  S++;
 
- return(RdMem(0x2100 | S));
+ return(RdMem<InstrumentMode>(0x2100 | S));
 }
 
 static uint8 ZNTable[256];
@@ -482,6 +499,15 @@ void HuC6280::Init(const bool emulate_wai)
 	LastLogicalWriteAddr = 0;
 
 	SetCPUHook(NULL, NULL);
+	Profiler = NULL;
+	Tracer = NULL;
+	for(unsigned i = 0; i < USAGE_OWNER_COUNT; i++)
+	{
+	 UsageRead[i] = NULL;
+	 UsageWrite[i] = NULL;
+	 UsageExec[i] = NULL;
+	}
+	UsageMapsActive = false;
 }
 
 HuC6280::~HuC6280()
@@ -523,6 +549,9 @@ void HuC6280::Power(void)
   FastPageR[i] = 0;
  }  
  Reset();
+
+ if(Profiler)
+  Profiler->Resync(timestamp);
 }
 
 // TimerSync() doesn't call CalcNextEvent(), so we'll need to call it some time after TimerSync() (TimerSync() is
@@ -572,7 +601,17 @@ void HuC6280::HappySync(void)
  CalcNextEvent();
 }
 
-template<bool DebugMode>
+//
+// Route the opcode handlers' memory accesses through the InstrumentMode variants, which count them in the usage maps;
+// with InstrumentMode false they're the same as the plain functions.
+//
+#define RdMem RdMem<InstrumentMode>
+#define WrMem WrMem<InstrumentMode>
+#define WrMemPhysical WrMemPhysical<InstrumentMode>
+#define PUSH PUSH<InstrumentMode>
+#define POP POP<InstrumentMode>
+
+template<bool DebugMode, bool InstrumentMode>
 NO_INLINE void HuC6280::RunSub(void)
 {
  uint32 old_PC;
@@ -596,6 +635,9 @@ NO_INLINE void HuC6280::RunSub(void)
          if(DebugMode)
           old_PC = PC;
 
+	 if(InstrumentMode && Profiler)
+	  Profiler->Instr(((uint32)MPR[(PC & 0xFFFF) >> 13] << 13) | (PC & 0x1FFF), timestamp);
+
          if(DebugMode && CPUHook)
          {
           TimerSync();
@@ -607,13 +649,15 @@ NO_INLINE void HuC6280::RunSub(void)
 	  }
          }
 
-         // TIMER interrupt to be tested after opcodes, not one cycle early
-         //
-         if (!IFlagSample)
-           IRQSample |= (IRQlow & IRQMask & IQTIMER);
-
+	 // IRQSample can only pick up the timer interrupt below if IRQlow is nonzero, so this one test covers the common case
+	 // of no pending interrupts.
 	 if(IRQSample | IRQlow)
 	 {
+          // TIMER interrupt to be tested after opcodes, not one cycle early
+          //
+          if (!IFlagSample)
+            IRQSample |= (IRQlow & IRQMask & IQTIMER);
+
           if(MDFN_UNLIKELY(IRQSample & IQRESET))
           {
            speed = 0;
@@ -631,6 +675,9 @@ NO_INLINE void HuC6280::RunSub(void)
 	   if(DebugMode && ADDBT)
 	    ADDBT(old_PC, PC, 0xFFFE);
 
+	   if(InstrumentMode && Tracer)
+	    Tracer->Interrupt(0xFFFE, timestamp);
+
 	   continue;
 	  }
 	  else
@@ -651,6 +698,9 @@ NO_INLINE void HuC6280::RunSub(void)
 
 	   if(tmpa)
 	   {
+	    if(InstrumentMode && Profiler)
+	     Profiler->InterruptBegin(timestamp);
+
 	    // Total: 8 cycles(7 ADDCYC(1), 1 LASTCYCLE)
 
 	    ADDCYC(1);	// Cycle 1
@@ -682,26 +732,91 @@ NO_INLINE void HuC6280::RunSub(void)
             if(DebugMode && ADDBT)
              ADDBT(old_PC, PC, tmpa);
 
+	    if(InstrumentMode && Profiler)
+	     Profiler->Interrupt(((uint32)MPR[PC >> 13] << 13) | (PC & 0x1FFF), PC, (uint8)(S + 3), timestamp);
+
+	    if(InstrumentMode && Tracer)
+	     Tracer->Interrupt(tmpa, timestamp);
+
 	    continue;
            }
 	  }
 	 }
          PC &= 0xFFFF;     // Our cpu core can only handle PC going about 8192 bytes over, so make sure it never gets that far...
 
+	 if(InstrumentMode && Tracer)
+	  Tracer->Instr(PC, MPR[PC >> 13], A, X, Y, P, S, timestamp);
+
 	 lastop = RdOp(PC);
 
+	 if(InstrumentMode && UsageMapsActive)
+	 {
+	  for(unsigned i = 0; i < CPUTrace_InstrLength[lastop]; i++)
+	   IncUsage(UsageExec, LogicalToPhysical(PC + i));
+	 }
+
 	 PC++;
 
+#if HAVE_COMPUTED_GOTO
+	 static const void* const op_goto_table[256] =
+	 {
+	  &&op_00, &&op_01, &&op_02, &&op_03, &&op_04, &&op_05, &&op_06, &&op_07, &&op_08, &&op_09, &&op_0A, &&op_ILL, &&op_0C, &&op_0D, &&op_0E, &&op_0F,
+	  &&op_10, &&op_11, &&op_12, &&op_13, &&op_14, &&op_15, &&op_16, &&op_17, &&op_18, &&op_19, &&op_1A, &&op_ILL, &&op_1C, &&op_1D, &&op_1E, &&op_1F,
+	  &&op_20, &&op_21, &&op_22, &&op_23, &&op_24, &&op_25, &&op_26, &&op_27, &&op_28, &&op_29, &&op_2A, &&op_ILL, &&op_2C, &&op_2D, &&op_2E, &&op_2F,
+	  &&op_30, &&op_31, &&op_32, &&op_ILL, &&op_34, &&op_35, &&op_36, &&op_37, &&op_38, &&op_39, &&op_3A, &&op_ILL, &&op_3C, &&op_3D, &&op_3E, &&op_3F,
+	  &&op_40, &&op_41, &&op_42, &&op_43, &&op_44, &&op_45, &&op_46, &&op_47, &&op_48, &&op_49, &&op_4A, &&op_ILL, &&op_4C, &&op_4D, &&op_4E, &&op_4F,
+	  &&op_50, &&op_51, &&op_52, &&op_53, &&op_54, &&op_55, &&op_56, &&op_57, &&op_58, &&op_59, &&op_5A, &&op_ILL, &&op_ILL, &&op_5D, &&op_5E, &&op_5F,
+	  &&op_60, &&op_61, &&op_62, &&op_ILL, &&op_64, &&op_65, &&op_66, &&op_67, &&op_68, &&op_69, &&op_6A, &&op_ILL, &&op_6C, &&op_6D, &&op_6E, &&op_6F,
+	  &&op_70, &&op_71, &&op_72, &&op_73, &&op_74, &&op_75, &&op_76, &&op_77, &&op_78, &&op_79, &&op_7A, &&op_ILL, &&op_7C, &&op_7D, &&op_7E, &&op_7F,
+	  &&op_80, &&op_81, &&op_82, &&op_83, &&op_84, &&op_85, &&op_86, &&op_87, &&op_88, &&op_89, &&op_8A, &&op_ILL, &&op_8C, &&op_8D, &&op_8E, &&op_8F,
+	  &&op_90, &&op_91, &&op_92, &&op_93, &&op_94, &&op_95, &&op_96, &&op_97, &&op_98, &&op_99, &&op_9A, &&op_ILL, &&op_9C, &&op_9D, &&op_9E, &&op_9F,
+	  &&op_A0, &&op_A1, &&op_A2, &&op_A3, &&op_A4, &&op_A5, &&op_A6, &&op_A7, &&op_A8, &&op_A9, &&op_AA, &&op_ILL, &&op_AC, &&op_AD, &&op_AE, &&op_AF,
+	  &&op_B0, &&op_B1, &&op_B2, &&op_B3, &&op_B4, &&op_B5, &&op_B6, &&op_B7, &&op_B8, &&op_B9, &&op_BA, &&op_ILL, &&op_BC, &&op_BD, &&op_BE, &&op_BF,
+	  &&op_C0, &&op_C1, &&op_C2, &&op_C3, &&op_C4, &&op_C5, &&op_C6, &&op_C7, &&op_C8, &&op_C9, &&op_CA, &&op_CB, &&op_CC, &&op_CD, &&op_CE, &&op_CF,
+	  &&op_D0, &&op_D1, &&op_D2, &&op_D3, &&op_D4, &&op_D5, &&op_D6, &&op_D7, &&op_D8, &&op_D9, &&op_DA, &&op_ILL, &&op_ILL, &&op_DD, &&op_DE, &&op_DF,
+	  &&op_E0, &&op_E1, &&op_ILL, &&op_E3, &&op_E4, &&op_E5, &&op_E6, &&op_E7, &&op_E8, &&op_E9, &&op_EA, &&op_ILL, &&op_EC, &&op_ED, &&op_EE, &&op_EF,
+	  &&op_F0, &&op_F1, &&op_F2, &&op_F3, &&op_F4, &&op_F5, &&op_F6, &&op_F7, &&op_F8, &&op_F9, &&op_FA, &&op_ILL, &&op_ILL, &&op_FD, &&op_FE, &&op_FF,
+	 };
+
+	 goto *op_goto_table[lastop];
+	 do	// "break" in an opcode handler exits this loop, like it would the switch().
+	 {
+	  #define HUC6280_CASEL(label, caseval) label
+	  #define HUC6280_DEFAULTL(label) label
+#else
          switch(lastop)
          {
+	  #define HUC6280_CASEL(label, caseval) case (caseval)
+	  #define HUC6280_DEFAULTL(label) default
+#endif
           #include "huc6280_ops.inc"
+	  #undef HUC6280_DEFAULTL
+	  #undef HUC6280_CASEL
+#if HAVE_COMPUTED_GOTO
+	 } while(0);
+#else
          } 
+#endif
 
 	 P &= ~T_FLAG;
 	 skip_T_flag_clear:;	// goto'd by the SET code
+
+	 if(InstrumentMode && Profiler)
+	 {
+	  if(lastop == 0x20 || lastop == 0x44)	// JSR, BSR
+	   Profiler->Call(((uint32)MPR[PC >> 13] << 13) | (PC & 0x1FFF), PC, (uint8)(S + 2), timestamp);
+	  else if(lastop == 0x60 || lastop == 0x40 || lastop == 0x9A)	// RTS, RTI, TXS
+	   Profiler->Return(S, timestamp);
+	 }
  } while(MDFN_LIKELY(runrunrun > 0));
 }
 
+#undef POP
+#undef PUSH
+#undef WrMemPhysical
+#undef WrMem
+#undef RdMem
+
 void HuC6280::Run(const bool StepMode)
 {
  if(StepMode)
@@ -709,10 +824,24 @@ void HuC6280::Run(const bool StepMode)
  else
   runrunrun = 1;
 
+ // Profiling, tracing, and usage maps share an instantiation; they're rarely used together, and each call is behind a
+ // pointer test.
+ const bool instrument = Profiler || Tracer || UsageMapsActive;
+
  if(CPUHook || ADDBT)
-  RunSub<true>();
+ {
+  if(instrument)
+   RunSub<true, true>();
+  else
+   RunSub<true, false>();
+ }
  else
-  RunSub<false>();
+ {
+  if(instrument)
+   RunSub<false, true>();
+  else
+   RunSub<false, false>();
+ }
 }
 
 uint8 HuC6280::TimerRead(unsigned int address, bool peek)
@@ -845,6 +974,9 @@ void HuC6280::StateAction(StateMem *sm, const unsigned load, const bool data_onl
   FlushMPRCache();
   REDOSPEEDCACHE();
   REDOPIMCACHE();
+
+  if(Profiler)
+   Profiler->Resync(timestamp);
  }
 }
 
@@ -2,6 +2,9 @@
 #define __MDFN_PCE_HUC6280_H
 
 #include <trio/trio.h>
+#include "cpuprof.h"
+#include "cputrace.h"
+#include <mednafen/UsageMap.h>
 
 using namespace Mednafen;
 
@@ -70,7 +73,7 @@ class alignas(128) HuC6280
 
 	void StateAction(StateMem *sm, const unsigned load, const bool data_only);
 
-	template<bool DebugMode>
+	template<bool DebugMode, bool InstrumentMode>
 	NO_INLINE void RunSub(void);
 
 	void Run(const bool StepMode = false);
@@ -84,6 +87,12 @@ class alignas(128) HuC6280
 	{
          TimerSync();
 
+	 if(Profiler)
+	  Profiler->RebaseTimestamp((int32)(ts_base - timestamp));
+
+	 if(Tracer)
+	  Tracer->RebaseTimestamp((int32)(ts_base - timestamp));
+
 	 timer_lastts = ts_base;
 	 timestamp = ts_base;
 	}
@@ -122,6 +131,41 @@ class alignas(128) HuC6280
 	 ADDBT = new_ADDBT;
 	}
 
+	// nullptr to disable.
+	INLINE void SetProfiler(CPUProfiler* new_Profiler)
+	{
+	 Profiler = new_Profiler;
+	}
+
+	// nullptr to disable.
+	INLINE void SetTracer(CPUTracer* new_Tracer)
+	{
+	 Tracer = new_Tracer;
+	}
+
+	enum : unsigned
+	{
+	 USAGE_OWNER_DEBUGGER = 0,
+	 USAGE_OWNER_COVERAGE,
+	 USAGE_OWNER_COUNT
+	};
+
+	// Usage maps for the 21-bit physical address space, counting data reads, data writes, and instruction bytes
+	// executed; all nullptr to disable.  The debugger and code coverage each set their own maps, and every access is
+	// counted in the maps of both.
+	INLINE void SetUsageMaps(const unsigned owner, UsageMap* read_map, UsageMap* write_map, UsageMap* exec_map)
+	{
+	 assert(owner < USAGE_OWNER_COUNT);
+
+	 UsageRead[owner] = read_map;
+	 UsageWrite[owner] = write_map;
+	 UsageExec[owner] = exec_map;
+
+	 UsageMapsActive = false;
+	 for(unsigned i = 0; i < USAGE_OWNER_COUNT; i++)
+	  UsageMapsActive |= UsageRead[i] || UsageWrite[i] || UsageExec[i];
+	}
+
 	INLINE void LoadShadow(const HuC6280 &state)
 	{
 	 //EmulateWAI = state.EmulateWAI;
@@ -397,9 +441,27 @@ class alignas(128) HuC6280
         }
 
 
-	// Logical
+	INLINE uint32 LogicalToPhysical(unsigned int address)
+	{
+	 return ((uint32)MPR[address >> 13] << 13) | (address & 0x1FFF);
+	}
+
+	static INLINE void IncUsage(UsageMap* const* maps, const uint32 physical_address)
+	{
+	 for(unsigned i = 0; i < USAGE_OWNER_COUNT; i++)
+	 {
+	  if(maps[i])
+	   maps[i]->Inc(physical_address);
+	 }
+	}
+
+	// Logical; the InstrumentMode variants(used by RunSub<..., true>) also count the access in the usage maps.
+	template<bool InstrumentMode = false>
 	INLINE uint8 RdMem(unsigned int address)
 	{
+	 if(InstrumentMode && UsageMapsActive)
+	  IncUsage(UsageRead, LogicalToPhysical(address));
+
 	 if(FastPageR[address >> 13])
 	  return *(uint8*)(FastPageR[address >> 13] + address);
 
@@ -416,10 +478,14 @@ class alignas(128) HuC6280
 	}
 
 	// Logical
+	template<bool InstrumentMode = false>
 	INLINE void WrMem(unsigned int address, uint8 V)
 	{
 	 uint8 wmpr = MPR[address >> 13];
 
+	 if(InstrumentMode && UsageMapsActive)
+	  IncUsage(UsageWrite, LogicalToPhysical(address));
+
 	 LastLogicalWriteAddr = address;
 
 	 WriteMap[wmpr]((wmpr << 13) | (address & 0x1FFF), V);
@@ -427,8 +493,12 @@ class alignas(128) HuC6280
 
 	// Used for ST0, ST1, ST2
 	// Must not modify address(upper bit is abused for ST0/ST1/ST2 handling).
+	template<bool InstrumentMode = false>
 	INLINE void WrMemPhysical(uint32 address, uint8 data)
 	{
+	 if(InstrumentMode && UsageMapsActive)
+	  IncUsage(UsageWrite, address & 0x1FFFFF);
+
 	 WriteMap[(address >> 13) & 0xFF](address, data);
 	}
 
@@ -480,8 +550,8 @@ class alignas(128) HuC6280
 	void X_ZN(const uint8);
 	void X_ZNT(const uint8);
 
-	void PUSH(const uint8 V);
-	uint8 POP(void);
+	template<bool InstrumentMode = false> void PUSH(const uint8 V);
+	template<bool InstrumentMode = false> uint8 POP(void);
 
 	template<bool DebugMode>
 	void JR(const bool cond, const bool BBRS = false);
@@ -551,6 +621,13 @@ class alignas(128) HuC6280
 	bool (*CPUHook)(uint32);
 	void (*ADDBT)(uint32, uint32, uint32);
 
+	CPUProfiler* Profiler;
+	CPUTracer* Tracer;
+	UsageMap* UsageRead[USAGE_OWNER_COUNT];
+	UsageMap* UsageWrite[USAGE_OWNER_COUNT];
+	UsageMap* UsageExec[USAGE_OWNER_COUNT];
+	bool UsageMapsActive;
+
 	bool EmulateWAI;		// For speed hacks
 };
 
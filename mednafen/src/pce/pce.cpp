@@ -25,12 +25,16 @@
 #include "hes.h"
 #include "debug.h"
 #include "tsushin.h"
+#include "cpuprof.h"
+#include "cputrace.h"
+#include "coverage.h"
 #include <mednafen/hw_misc/arcade_card/arcade_card.h>
 #include <mednafen/mempatcher.h>
 #include <mednafen/cdrom/CDInterface.h>
 #include <mednafen/hash/md5.h>
 #include <mednafen/FileStream.h>
 #include <mednafen/sound/OwlResampler.h>
+#include <mednafen/profile.h>
 
 #include <zlib.h>
 
@@ -39,6 +43,12 @@
 namespace MDFN_IEN_PCE
 {
 
+enum
+{
+ PCE_RENDERER_ST = 0,
+ PCE_RENDERER_MT
+};
+
 static const MDFNSetting_EnumList PSGRevisionList[] =
 {
  { "huc6280", PCE_PSG::REVISION_HUC6280, "HuC6280", gettext_noop("HuC6280 as found in the original PC Engine.") },
@@ -71,11 +81,213 @@ bool bBRAMEnabled;
 uint32 PCE_InDebug = 0;
 uint64 PCE_TimestampBase;	// Only used with the debugger for the time being.
 
+//
+// HuC6280 profiling(pce.cpuprofile*), over the range of emulated frames [CPUProf_Start, CPUProf_Start + CPUProf_Frames).
+//
+static CPUProfiler* CPUProf = NULL;
+static std::string CPUProf_Path;
+static uint64 CPUProf_Start;
+static uint64 CPUProf_Frames;	// 0 = until the game is closed.
+static bool CPUProf_Running;
+
+//
+// HuC6280 instruction tracing(pce.cputrace*), over [CPUTrace_Start, CPUTrace_Start + CPUTrace_Frames).
+//
+static CPUTracer* CPUTrace = NULL;
+static std::string CPUTrace_Path;
+static uint64 CPUTrace_Start;
+static uint64 CPUTrace_Frames;	// 0 = until the game is closed.
+static bool CPUTrace_Running;
+
+static uint64 EmulatedFrames;	// Since the game was loaded.
+
+//
+// ROM code coverage(pce.coverage), from game load until the game is closed.
+//
+static PCECoverage* Coverage = NULL;
+
+static void Coverage_MapperChange(unsigned bank, unsigned count)
+{
+ Coverage->Fold(bank, count);
+}
+
 static bool IsSGX;
 static bool IsHES;
 
+//
+// Event scheduling
+//
+struct event_list_entry
+{
+ uint32 which;
+ int32 event_time;
+ event_list_entry *prev;
+ event_list_entry *next;
+};
+
+static event_list_entry events[PCE_EVENT__COUNT];
+
+static void EventReset(void)
+{
+ for(unsigned i = 0; i < PCE_EVENT__COUNT; i++)
+ {
+  events[i].which = i;
+
+  if(i == PCE_EVENT__SYNFIRST)
+   events[i].event_time = (int32)0x80000000;
+  else if(i == PCE_EVENT__SYNLAST)
+   events[i].event_time = 0x7FFFFFFF;
+  else
+   events[i].event_time = PCE_EVENT_MAXTS;
+
+  events[i].prev = (i > 0) ? &events[i - 1] : NULL;
+  events[i].next = (i < (PCE_EVENT__COUNT - 1)) ? &events[i + 1] : NULL;
+ }
+}
+
+// Events not scheduled(at PCE_EVENT_MAXTS) stay that way.
+static void RebaseTS(const int32 delta)
+{
+ for(unsigned i = 0; i < PCE_EVENT__COUNT; i++)
+ {
+  if(i == PCE_EVENT__SYNFIRST || i == PCE_EVENT__SYNLAST)
+   continue;
+
+  if(events[i].event_time < PCE_EVENT_MAXTS)
+  {
+   assert(events[i].event_time >= delta);
+   events[i].event_time -= delta;
+  }
+ }
+}
+
+// Device next-event values are relative, and may be far larger than a frame's worth of cycles.
+static INLINE int32 EventTS(const int32 timestamp, const int32 cycles)
+{
+ return timestamp + std::min<int32>(cycles, PCE_EVENT_MAXTS - timestamp);
+}
+
+// Doesn't update the CPU's event counter.
+static void SetEventNT(const int type, const int32 next_timestamp)
+{
+ event_list_entry *e = &events[type];
+
+ if(next_timestamp < e->event_time)
+ {
+  event_list_entry *fe = e;
+
+  do
+  {
+   fe = fe->prev;
+  }
+  while(next_timestamp < fe->event_time);
+
+  // Remove this event from the list, temporarily of course.
+  e->prev->next = e->next;
+  e->next->prev = e->prev;
+
+  // Insert into the list, just after "fe".
+  e->prev = fe;
+  e->next = fe->next;
+  fe->next->prev = e;
+  fe->next = e;
+
+  e->event_time = next_timestamp;
+ }
+ else if(next_timestamp > e->event_time)
+ {
+  event_list_entry *fe = e;
+
+  do
+  {
+   fe = fe->next;
+  } while(next_timestamp > fe->event_time);
+
+  // Remove this event from the list, temporarily of course
+  e->prev->next = e->next;
+  e->next->prev = e->prev;
+
+  // Insert into the list, just BEFORE "fe".
+  e->prev = fe->prev;
+  e->next = fe;
+  fe->prev->next = e;
+  fe->prev = e;
+
+  e->event_time = next_timestamp;
+ }
+}
+
+void PCE_SetEvent(const int type, const int32 next_timestamp)
+{
+ SetEventNT(type, next_timestamp);
+
+ HuCPU.SetEvent(events[PCE_EVENT__SYNFIRST].next->event_time - (int32)HuCPU.Timestamp());
+}
+
+int32 PCE_GetNextEventTS(const int exclude_type)
+{
+ const event_list_entry *e = events[PCE_EVENT__SYNFIRST].next;
+
+ if(e->which == (uint32)exclude_type)
+  e = e->next;
+
+ return std::min<int32>(e->event_time, PCE_EVENT_MAXTS);
+}
+
+void PCE_ForceEventUpdates(const int32 timestamp)
+{
+ if(PCE_IsCD)
+ {
+  MDFN_ProfileZone pz(PROFZONE_CD);
+
+  SetEventNT(PCE_EVENT_CD, EventTS(timestamp, PCECD_Run(timestamp)));
+ }
+
+ SetEventNT(PCE_EVENT_VCE, EventTS(timestamp, vce->Update(timestamp)));
+
+ HuCPU.SetEvent(events[PCE_EVENT__SYNFIRST].next->event_time - timestamp);
+}
+
+static MDFN_FASTCALL int32 PCE_EventHandler(const int32 timestamp)
+{
+ event_list_entry *e = events[PCE_EVENT__SYNFIRST].next;
+
+ while(timestamp >= e->event_time)
+ {
+  event_list_entry *prev = e->prev;
+  int32 nt;
+
+  // Devices are brought up to the current timestamp rather than the event's; the CPU only checks for events between
+  // instructions, and catching up by the difference here is what the devices do on any other access anyway.
+  switch(e->which)
+  {
+   default: abort();
+
+   case PCE_EVENT_VCE:
+	nt = EventTS(timestamp, vce->Update(timestamp));
+	break;
+
+   case PCE_EVENT_CD:
+	{
+	 MDFN_ProfileZone pz(PROFZONE_CD);
+
+	 nt = EventTS(timestamp, PCECD_Run(timestamp));
+	}
+	break;
+  }
+
+  SetEventNT(e->which, nt);
+
+  // Order of events can change due to calling SetEventNT(), this prev business ensures we don't miss an event due to reordering.
+  e = prev->next;
+ }
+
+ return events[PCE_EVENT__SYNFIRST].next->event_time - timestamp;
+}
+
 // Accessed in debug.cpp
 static uint8 BaseRAM[32768]; // 8KB for PCE, 32KB for Super Grafx
+static StateDirtyMap BaseRAMDirty;
 uint8 PCE_PeekMainRAM(uint32 A)
 {
  return BaseRAM[A & ((IsSGX ? 32768 : 8192) - 1)];
@@ -84,6 +296,7 @@ uint8 PCE_PeekMainRAM(uint32 A)
 void PCE_PokeMainRAM(uint32 A, uint8 V)
 {
  BaseRAM[A & ((IsSGX ? 32768 : 8192) - 1)] = V;
+ BaseRAMDirty.Mark(A & ((IsSGX ? 32768 : 8192) - 1));
 }
 
 
@@ -115,6 +328,7 @@ static DECLFR(BaseRAMReadSGX)
 static DECLFW(BaseRAMWriteSGX)
 {
  BaseRAM[A & 0x7FFF] = V;
+ BaseRAMDirty.Mark(A & 0x7FFF);
 }
 
 static DECLFR(BaseRAMRead)
@@ -125,6 +339,7 @@ static DECLFR(BaseRAMRead)
 static DECLFW(BaseRAMWrite)
 {
  BaseRAM[A & 0x1FFF] = V;
+ BaseRAMDirty.Mark(A & 0x1FFF);
 }
 
 static DECLFR(IORead)
@@ -192,9 +407,13 @@ static DECLFR(IORead)
 		int32 next_cd_event;
 		uint8 ret;
 
-		ret = PCECD_Read(HuCPU.Timestamp(), A, next_cd_event, PCE_InDebug);
+		{
+		 MDFN_ProfileZone pz(PROFZONE_CD);
+
+		 ret = PCECD_Read(HuCPU.Timestamp(), A, next_cd_event, PCE_InDebug);
+		}
 
-		vce->SetCDEvent(next_cd_event);
+		PCE_SetEvent(PCE_EVENT_CD, EventTS(HuCPU.Timestamp(), next_cd_event));
 
 		return(ret);
 	       }
@@ -226,7 +445,11 @@ static DECLFW(IOWrite)
 	       break;
 
   case 0x0800: HuCPU.SetIODataBuffer(V); 
-	       psg->Write(HuCPU.Timestamp() / 3, A & 0x1FFF, V);
+	       {
+		MDFN_ProfileZone pz(PROFZONE_PSG);
+
+	        psg->Write(HuCPU.Timestamp() / 3, A & 0x1FFF, V);
+	       }
 	       break;
 
   case 0x0c00: HuCPU.SetIODataBuffer(V);
@@ -263,9 +486,15 @@ static DECLFW(IOWrite)
 	       }
 	       else
 	       {
-	        int32 next_cd_event = PCECD_Write(HuCPU.Timestamp(), A & 0x1FFF, V);
+		int32 next_cd_event;
 
-		vce->SetCDEvent(next_cd_event);
+		{
+		 MDFN_ProfileZone pz(PROFZONE_CD);
+
+	         next_cd_event = PCECD_Write(HuCPU.Timestamp(), A & 0x1FFF, V);
+		}
+
+		PCE_SetEvent(PCE_EVENT_CD, EventTS(HuCPU.Timestamp(), next_cd_event));
 	       }
 
 	       break;
@@ -423,6 +652,7 @@ static MDFN_COLD void LoadCommonPre(void)
  PCE_ACEnabled = MDFN_GetSettingB("pce.arcadecard");
 
  HuCPU.Init(IsHES);
+ HuCPU.SetEventHandler(PCE_EventHandler);
 
  for(int x = 0; x < 0x100; x++)
  {
@@ -446,6 +676,30 @@ static MDFN_COLD int LoadCommon(void)
  vce = new VCE(IsSGX, vram_size);
  vce->SetVDCUnlimitedSprites(MDFN_GetSettingB("pce.nospritelimit"));
  vce->SetMWRTiming(MDFN_GetSettingB("pce.mwrtiming_approx"));
+ vce->SetMTRender(MDFN_GetSettingUI("pce.renderer") == PCE_RENDERER_MT, MDFN_GetSettingUI("pce.affinity.vdc"));
+
+ CPUProf_Path = MDFN_GetSettingS("pce.cpuprofile");
+ CPUProf_Start = MDFN_GetSettingUI("pce.cpuprofile.start");
+ CPUProf_Frames = MDFN_GetSettingUI("pce.cpuprofile.frames");
+ EmulatedFrames = 0;
+ CPUProf_Running = false;
+
+ if(CPUProf_Path.size())
+  CPUProf = new CPUProfiler();
+
+ CPUTrace_Path = MDFN_GetSettingS("pce.cputrace");
+ CPUTrace_Start = MDFN_GetSettingUI("pce.cputrace.start");
+ CPUTrace_Frames = MDFN_GetSettingUI("pce.cputrace.frames");
+ CPUTrace_Running = false;
+
+ if(CPUTrace_Path.size())
+  CPUTrace = new CPUTracer(CPUTrace_Path);
+
+ if(MDFN_GetSettingS("pce.coverage").size())
+ {
+  Coverage = new PCECoverage(MDFN_GetSettingS("pce.coverage"));
+  HuC_SetMapperChangeCallback(Coverage_MapperChange);
+ }
 
 
  if(IsSGX)
@@ -463,6 +717,7 @@ static MDFN_COLD int LoadCommon(void)
  }
 
  MDFNMP_AddRAM(IsSGX ? 32768 : 8192, 0xf8 * 8192, BaseRAM);
+ BaseRAMDirty.Init(BaseRAM, IsSGX ? 32768 : 8192);
 
  HuCPU.SetReadHandler(0xFF, IORead);
  HuCPU.SetWriteHandler(0xFF, IOWrite);
@@ -689,12 +944,74 @@ static MDFN_COLD void LoadCD(std::vector<CDInterface*> *CDInterfaces)
  }
 }
 
+static void CPUProf_Finish(void)
+{
+ HuCPU.SetProfiler(NULL);
+ CPUProf_Running = false;
+
+ try
+ {
+  CPUProf->Dump(CPUProf_Path, CPUProf_Start, EmulatedFrames - CPUProf_Start);
+ }
+ catch(std::exception& e)
+ {
+  MDFN_Notify(MDFN_NOTICE_ERROR, _("Error writing CPU profile: %s"), e.what());
+ }
+}
+
+static void CPUTrace_Finish(void)
+{
+ HuCPU.SetTracer(NULL);
+ CPUTrace_Running = false;
+
+ try
+ {
+  CPUTrace->Close();
+ }
+ catch(std::exception& e)
+ {
+  MDFN_Notify(MDFN_NOTICE_ERROR, _("Error writing CPU trace: %s"), e.what());
+ }
+
+ delete CPUTrace;
+ CPUTrace = NULL;
+}
+
 static MDFN_COLD void Cleanup(void)
 {
  #ifdef WANT_DEBUGGER
  PCEDBG_Kill();
  #endif
 
+ if(CPUProf)
+ {
+  if(CPUProf_Running)
+   CPUProf_Finish();
+
+  delete CPUProf;
+  CPUProf = NULL;
+ }
+
+ if(CPUTrace)
+  CPUTrace_Finish();
+
+ if(Coverage)
+ {
+  HuC_SetMapperChangeCallback(NULL);
+
+  try
+  {
+   Coverage->Save();
+  }
+  catch(std::exception& e)
+  {
+   MDFN_Notify(MDFN_NOTICE_ERROR, _("Error writing code coverage: %s"), e.what());
+  }
+
+  delete Coverage;
+  Coverage = NULL;
+ }
+
  if(PCE_IsCD)
  {
   PCECD_Close();
@@ -745,6 +1062,8 @@ static MDFN_COLD void Cleanup(void)
   delete HRRes;
   HRRes = NULL;
  }
+
+ BaseRAMDirty.Kill();
 }
 
 static MDFN_COLD void CloseGame(void)
@@ -859,6 +1178,20 @@ static void Emulate(EmulateSpecStruct *espec)
 
  //int t = MDFND_GetTime();
 
+ if(CPUProf && EmulatedFrames == CPUProf_Start)
+ {
+  CPUProf->Start(HuCPU.Timestamp());
+  HuCPU.SetProfiler(CPUProf);
+  CPUProf_Running = true;
+ }
+
+ if(CPUTrace && EmulatedFrames == CPUTrace_Start)
+ {
+  CPUTrace->Start(HuCPU.Timestamp());
+  HuCPU.SetTracer(CPUTrace);
+  CPUTrace_Running = true;
+ }
+
  vce->StartFrame(espec->surface, &espec->DisplayRect, espec->LineWidths, IsHES ? 1 : espec->skip);
 
  // Begin loop here:
@@ -883,18 +1216,27 @@ static void Emulate(EmulateSpecStruct *espec)
 
   INPUT_AdjustTS((int32)end_timestamp_mod12 - (int32)end_timestamp);	// Careful with this!
 
-  psg->Update(end_timestamp / 3);
-  psg->ResetTS(end_timestamp_mod12 / 3);
+  {
+   MDFN_ProfileZone pz(PROFZONE_PSG);
+
+   psg->Update(end_timestamp / 3);
+   psg->ResetTS(end_timestamp_mod12 / 3);
+  }
 
   HuC_Update(end_timestamp);
   HuC_ResetTS(end_timestamp_mod12);
 
   {
+   MDFN_ProfileZone pz(PROFZONE_PSG);
    const unsigned rsc = std::min<unsigned>(65536, end_timestamp_div12);
    int32 new_sc;
 
    if(ADPCMBuf)
+   {
+    MDFN_ProfileZone adpcm_pz(PROFZONE_CD);
+
     PCECD_ProcessADPCMBuffer(rsc);
+   }
 
    for(unsigned ch = 0; ch < 2; ch++)
    {
@@ -982,6 +1324,7 @@ static void Emulate(EmulateSpecStruct *espec)
 
   vce->ResetTS(end_timestamp_mod12);
 
+  RebaseTS(end_timestamp - end_timestamp_mod12);
   HuCPU.SyncAndResetTimestamp(end_timestamp_mod12);
 
   //
@@ -996,6 +1339,16 @@ static void Emulate(EmulateSpecStruct *espec)
   }
  } while(!rp_rv);
 
+ vce->EndFrame();
+
+ EmulatedFrames++;
+
+ if(CPUProf_Running && CPUProf_Frames && EmulatedFrames == CPUProf_Start + CPUProf_Frames)
+  CPUProf_Finish();
+
+ if(CPUTrace_Running && CPUTrace_Frames && EmulatedFrames == CPUTrace_Start + CPUTrace_Frames)
+  CPUTrace_Finish();
+
  //printf("%d\n", MDFND_GetTime() - t);
 
  // End loop here.
@@ -1030,7 +1383,15 @@ static void StateAction(StateMem *sm, const unsigned load, const bool data_only)
 
  if(load)
  {
+  // Device timing isn't saved in a form the event list can be rebuilt from, so have every device synchronize and
+  // reschedule itself at the first opportunity; catching up early is harmless.
+  EventReset();
+  SetEventNT(PCE_EVENT_VCE, HuCPU.Timestamp());
+
+  if(PCE_IsCD)
+   SetEventNT(PCE_EVENT_CD, HuCPU.Timestamp());
 
+  HuCPU.SetEvent(0);
  }
 }
 
@@ -1046,7 +1407,10 @@ void PCE_Power(void)
  PCE_TimestampBase = 0;	// FIXME, move to init.
  const int32 timestamp = HuCPU.Timestamp();
 
+ EventReset();
+
  vce->Reset(timestamp);
+ SetEventNT(PCE_EVENT_VCE, timestamp);
  psg->Power(timestamp / 3);
 
  if(IsHES)
@@ -1060,8 +1424,11 @@ void PCE_Power(void)
 
  if(PCE_IsCD)
  {
-  vce->SetCDEvent(PCECD_Power(timestamp));
+  PCE_SetEvent(PCE_EVENT_CD, EventTS(timestamp, PCECD_Power(timestamp)));
  }
+
+ // Memory was reinitialized behind the dirty maps' backs.
+ StateDirtyMap::MarkAllMaps();
  //printf("%d\n", HuCPU.Timestamp());
 }
 
@@ -1095,6 +1462,14 @@ static void DoSimpleCommand(int cmd)
  }
 }
 
+static const MDFNSetting_EnumList Renderer_List[] =
+{
+ { "st", PCE_RENDERER_ST, gettext_noop("Single-threaded"), gettext_noop("VDC rendering is performed in the main emulation thread.") },
+ { "mt", PCE_RENDERER_MT, gettext_noop("Multi-threaded"), gettext_noop("VDC rendering is performed in a dedicated thread.") },
+
+ { NULL, 0 }
+};
+
 static const MDFNSetting PCESettings[] = 
 {
   { "pce.input.multitap", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE, gettext_noop("Enable multitap(TurboTap) emulation."), NULL, MDFNST_BOOL, "1" },
@@ -1125,6 +1500,9 @@ static const MDFNSetting PCESettings[] =
   { "pce.mwrtiming_approx", MDFNSF_NOFLAGS, gettext_noop("Approximate MWR VRAM access timing during active display"), 
 					 gettext_noop("WARNING: This is an approximation, and is not accurate; sprite prefetch during HBLANK is not simulated either."), MDFNST_BOOL, "0" },
 
+  { "pce.renderer", MDFNSF_NOFLAGS, gettext_noop("VDC renderer."), gettext_noop("Background and sprite composition and VCE mixing can be done in a separate thread, which only helps with more than one physical CPU core.  Frame-skipped frames are always rendered in the main emulation thread."), MDFNST_ENUM, "st", NULL, NULL, NULL, NULL, Renderer_List },
+  { "pce.affinity.vdc", MDFNSF_NOFLAGS, gettext_noop("VDC rendering thread CPU affinity mask."), gettext_noop("Set to 0 to disable changing affinity."), MDFNST_UINT, "0", "0x0000000000000000", "0xFFFFFFFFFFFFFFFF" },
+
   { "pce.cdbios", MDFNSF_EMU_STATE | MDFNSF_CAT_PATH, gettext_noop("Path to the CD BIOS"), NULL, MDFNST_STRING, "syscard3.pce" },
   { "pce.gecdbios", MDFNSF_EMU_STATE | MDFNSF_CAT_PATH, gettext_noop("Path to the GE CD BIOS"), gettext_noop("Games Express CD Card BIOS (Unlicensed)"), MDFNST_STRING, "gecard.pce" },
 
@@ -1140,6 +1518,16 @@ static const MDFNSetting PCESettings[] =
 
   { "pce.vramsize", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE | MDFNSF_SUPPRESS_DOC, gettext_noop("Size of emulated VRAM per VDC in 16-bit words.  DO NOT CHANGE THIS UNLESS YOU KNOW WTF YOU ARE DOING."), NULL, MDFNST_UINT, "32768", "32768", "65536" },
 
+  { "pce.cpuprofile", MDFNSF_NOFLAGS, gettext_noop("HuC6280 profile output file."), gettext_noop("If set, the emulated CPU's cycles are attributed to the (physical) addresses of the instructions that spent them, and a flat profile and call graph are written to this file when profiling ends.  Set to an empty string to disable."), MDFNST_STRING, "" },
+  { "pce.cpuprofile.start", MDFNSF_NOFLAGS, gettext_noop("First emulated frame to profile."), NULL, MDFNST_UINT, "0", "0", "0x7FFFFFFF" },
+  { "pce.cpuprofile.frames", MDFNSF_NOFLAGS, gettext_noop("Number of emulated frames to profile."), gettext_noop("0 profiles until the game is closed."), MDFNST_UINT, "0", "0", "0x7FFFFFFF" },
+
+  { "pce.cputrace", MDFNSF_NOFLAGS, gettext_noop("HuC6280 instruction trace output file."), gettext_noop("If set, every instruction the emulated CPU executes, with its register values and timestamp, is written to this file in a compressed binary format.  Set to an empty string to disable."), MDFNST_STRING, "" },
+  { "pce.cputrace.start", MDFNSF_NOFLAGS, gettext_noop("First emulated frame to trace."), NULL, MDFNST_UINT, "0", "0", "0x7FFFFFFF" },
+  { "pce.cputrace.frames", MDFNSF_NOFLAGS, gettext_noop("Number of emulated frames to trace."), gettext_noop("0 traces until the game is closed."), MDFNST_UINT, "0", "0", "0x7FFFFFFF" },
+
+  { "pce.coverage", MDFNSF_NOFLAGS, gettext_noop("HuCard ROM code coverage output file."), gettext_noop("If set, which bytes of the HuCard(or System Card) ROM image the emulated CPU executed or read as data is recorded, and merged into this file when the game is closed.  Concurrent processes may share one file; saving is serialized through a \"<path>.lck\" lock file.  Set to an empty string to disable."), MDFNST_STRING, "" },
+
   { "pce.cdthrottle", MDFNSF_NOFLAGS, gettext_noop("Enable Sherlock Holmes best-quality video playback."), gettext_noop("This can be enabled to detect and throttle the Sherlock Holmes video playback to 120KB/s."), MDFNST_BOOL, "0" },
 
   { NULL }
@@ -27,6 +27,28 @@ MDFN_HIDE extern uint32 PCE_InDebug;
 MDFN_HIDE extern bool PCE_ACEnabled; // Arcade Card emulation enabled?
 void PCE_Power(void);
 
+//
+// Events are kept in a timestamp-ordered list; each device schedules its own next event(in absolute HuC6280
+// timestamps), and PCE_EventHandler() services only the devices whose events are due.
+//
+enum
+{
+ PCE_EVENT__SYNFIRST = 0,
+ PCE_EVENT_VCE,		// VCE and VDC(s)
+ PCE_EVENT_CD,		// CD interface, ADPCM, and SCSI CD
+ PCE_EVENT__SYNLAST,
+ PCE_EVENT__COUNT,
+};
+
+#define PCE_EVENT_MAXTS			0x20000000
+void PCE_SetEvent(const int type, const int32 next_timestamp);
+
+// Returns the timestamp of the soonest event not of type 'exclude_type'.
+int32 PCE_GetNextEventTS(const int exclude_type);
+
+// Called from debug.cpp too.
+void PCE_ForceEventUpdates(const int32 timestamp);
+
 bool PCE_IsBRAMEnabled(void);
 
 uint8 PCE_PeekMainRAM(uint32 A);
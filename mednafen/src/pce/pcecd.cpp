@@ -163,6 +163,7 @@ typedef struct
 } ADPCM_t;
 
 static ADPCM_t ADPCM;
+static StateDirtyMap ADPCMRAMDirty;
 
 typedef struct
 {
@@ -325,6 +326,7 @@ void ADPCM_PokeRAM(uint32 Address, uint32 Length, const uint8 *Buffer)
  {
   Address &= 0xFFFF;
   ADPCM.RAM[Address] = *Buffer;
+  ADPCMRAMDirty.Mark(Address);
   Address++;
   Buffer++;
  }
@@ -434,6 +436,8 @@ bool PCECD_SetSettings(const PCECD_Settings *settings)
 
 static void Cleanup(void)
 {
+	ADPCMRAMDirty.Kill();
+
         if(ADPCM.RAM)
         {
          delete[] ADPCM.RAM;
@@ -460,6 +464,7 @@ void PCECD_Init(const PCECD_Settings *settings, void (*irqcb)(bool), double mast
 	SCSICD_Init(SCSICD_PCE, 3, hrbuf_l, hrbuf_r, 153600, master_clock, CDIRQ, StuffSubchannel);
 
         ADPCM.RAM = new uint8[0x10000];
+	ADPCMRAMDirty.Init(ADPCM.RAM, 0x10000);
 
 	PCECD_SetSettings(settings);
 
@@ -494,6 +499,7 @@ int32 PCECD_Power(uint32 timestamp)
 	ClearACKDelay = 0;
 
 	memset(ADPCM.RAM, 0x00, 65536);
+	ADPCMRAMDirty.MarkAll();
 
 	ADPCM.ReadPending = ADPCM.WritePending = 0;
 	ADPCM.ReadBuffer = 0;
@@ -1196,6 +1202,7 @@ static INLINE void ADPCM_Run(const int32 clocks, const int32 timestamp)
    if(!(ADPCM.LastCmd & 0x10) && ADPCM.LengthCount < 0x1FFFF)
     ADPCM.LengthCount++;
 
+   ADPCMRAMDirty.Mark(ADPCM.WriteAddr);
    ADPCM.RAM[ADPCM.WriteAddr++] = ADPCM.WritePendingValue;
    ADPCM.WritePending = 0;
   }
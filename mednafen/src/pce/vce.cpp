@@ -31,6 +31,15 @@
 #include "debug.h"
 #include "pcecd.h"
 #include <trio/trio.h>
+#include <mednafen/MThreading.h>
+#include <mednafen/profile.h>
+
+#include <atomic>
+
+#if defined(HAVE_SSE2_INTRINSICS)
+ #include <xmmintrin.h>
+ #include <emmintrin.h>
+#endif
 
 extern bool DebugHSyncFlag;
 extern bool DebugVSyncFlag;
@@ -56,7 +65,7 @@ bool VCE::WS_Hook(int32 vdc_cycles)
  int32 to_steal;
 
  if(vdc_cycles == -1) // Special event-based wait-stating
-  to_steal = CalcNextEvent();
+  to_steal = std::min<int32>(CalcNextEvent(), PCE_GetNextEventTS(PCE_EVENT_VCE) - HuCPU.Timestamp());
  else
   to_steal = ((vdc_cycles * dot_clock_ratio - clock_divider) + 2) / 3;
 
@@ -130,17 +139,19 @@ VCE::VCE(const bool want_sgfx, const uint32 vram_size)
  //printf("%zu\n", (size_t)((uintptr_t)&vdc[0] - (uintptr_t)this));
 
  ShowHorizOS = false;
+ mix_flags = 0;
 
  sgfx = want_sgfx;
  chip_count = sgfx ? 2 : 1;
 
- cd_event = 1;
-
  framenum = 0;
 
  fb = NULL;
  pitch32 = 0;
 
+ mt = NULL;
+ mt_recording = false;
+
  for(unsigned chip = 0; chip < chip_count; chip++)
  {
   vdc[chip].SetVRAMSize(vram_size);
@@ -178,7 +189,7 @@ void VCE::SetMWRTiming(const bool mwr_switch)
 
 VCE::~VCE()
 {
-
+ MT_Kill();
 }
 
 void VCE::Reset(const int32 timestamp)
@@ -240,6 +251,9 @@ void VCE::Reset(const int32 timestamp)
 
 void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, int32 *LineWidths, int skip)
 {
+ if(mt_recording)
+  MT_End();
+
  FrameDone = false;
 
  //printf("Clock divider: %d\n", clock_divider);
@@ -273,17 +287,25 @@ void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, int32 *LineW
  }
 
  skipframe = skip;
+
+ if(mt && !skipframe)
+  MT_Begin();
 }
 
-bool VCE::RunPartial(void)
+void VCE::EndFrame(void)
 {
- HuCPU.SetEventHandler(Sync);
-
- if(!PCE_IsCD)
-  cd_event = 0x3FFFFFFF;
+ if(mt_recording)
+  MT_End();
+}
 
+bool VCE::RunPartial(void)
+{
  ws_counter = 0;
- HuCPU.Run();
+ {
+  MDFN_ProfileZone pz(PROFZONE_CPU);
+
+  HuCPU.Run();
+ }
 
  if(!skipframe)
  {
@@ -306,19 +328,11 @@ bool VCE::RunPartial(void)
   }
  }
 
- Update(HuCPU.Timestamp());
+ PCE_ForceEventUpdates(HuCPU.Timestamp());
 
  return(FrameDone);
 }
 
-void VCE::Update(const int32 timestamp)
-{
- if(PCE_IsCD)
-  SetCDEvent(PCECD_Run(timestamp));
-
- HuCPU.SetEvent(Sync(timestamp));
-}
-
 INLINE int32 VCE::CalcNextEvent(void)
 {
  int32 next_event = hblank_counter;
@@ -326,9 +340,6 @@ INLINE int32 VCE::CalcNextEvent(void)
  if(next_event > vblank_counter)
   next_event = vblank_counter;
 
- if(next_event > cd_event)
-  next_event = cd_event;
-
  next_event = std::min<int32>(next_event, child_event[0] * dot_clock_ratio - clock_divider);
 
  if(sgfx)
@@ -340,6 +351,552 @@ INLINE int32 VCE::CalcNextEvent(void)
  return next_event;
 }
 
+template<bool TA_SuperGrafx, bool TA_BoundBox>
+INLINE uint32 VCE::MixDot(int32* wc, const uint8* prio, const uint32* ctc, const uint16 p0, const uint16 p1)
+{
+ if(TA_SuperGrafx)
+ {
+  static const int prio_select[4] = { 1, 1, 0, 0 };
+  static const int prio_shift[4] = { 4, 0, 4, 0 };
+  int in_window = 0;
+
+  if(wc[0] > 0x40)
+  {
+   in_window |= 1;
+   wc[0]--;
+  }
+
+  if(wc[1] > 0x40)
+  {
+   in_window |= 2;
+   wc[1]--;
+  }
+
+  uint8 pb = (prio[prio_select[in_window]] >> prio_shift[in_window]) & 0xF;
+  uint32 vdc2_pixel, vdc1_pixel;
+
+  vdc2_pixel = vdc1_pixel = 0;
+
+  if(pb & 1)
+   vdc1_pixel = p0 & 0x3FF;
+  if(pb & 2)
+   vdc2_pixel = p1 & 0x3FF;
+
+  /* Dai MakaiMura uses setting 1, and expects VDC #2 sprites in front of VDC #1 background, but
+    behind VDC #1's sprites.
+  */
+  switch(pb & 3)
+  {
+    case 0:
+       vdc1_pixel = 0;
+       vdc2_pixel = 0;
+       break;
+
+    case 1:
+       vdc2_pixel = 0;
+       break;
+
+    case 2:
+       vdc1_pixel = 0;
+       break;
+
+    default:
+       switch(pb >> 2)
+       {
+        case 1:
+                 if((vdc2_pixel & 0x100) && !(vdc1_pixel & 0x100) && (vdc2_pixel & 0xF))
+                         vdc1_pixel = 0; //amask;
+                 break;
+        case 2:
+                 if((vdc1_pixel & 0x100) && !(vdc2_pixel & 0x100) && (vdc2_pixel & 0xF))
+                         vdc1_pixel = 0; //|= amask;
+                 break;
+       }
+  }
+
+  if (TA_BoundBox && ((p0 & VDC_BOUND_BOX_MASK) || (p1 & VDC_BOUND_BOX_MASK)))
+   return boundbox_color;  // magenta bound box
+
+  if ((vdc1_pixel & 0x0f) != 0)
+   return ctc[vdc1_pixel & 0x1FF];
+
+  return ctc[((vdc2_pixel & 0x1FF) ? vdc2_pixel : vdc1_pixel) & 0x1FF];
+ }
+ else
+ {
+  if (TA_BoundBox && (p0 & VDC_BOUND_BOX_MASK))
+   return boundbox_color;  // magenta bound box
+
+  return ctc[p0 & 0x3FF];
+ }
+}
+
+static INLINE void LookupDots(uint32* target, const uint16* pb, const uint32* ctc, const int32 count)
+{
+ int32 i = 0;
+
+#if defined(HAVE_SSE2_INTRINSICS)
+ for(; i + 8 <= count; i += 8)
+ {
+  const __m128i idx = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pb + i)), _mm_set1_epi16(0x3FF));
+
+  _mm_storeu_si128((__m128i*)(target + i + 0), _mm_set_epi32(ctc[_mm_extract_epi16(idx, 3)], ctc[_mm_extract_epi16(idx, 2)], ctc[_mm_extract_epi16(idx, 1)], ctc[_mm_extract_epi16(idx, 0)]));
+  _mm_storeu_si128((__m128i*)(target + i + 4), _mm_set_epi32(ctc[_mm_extract_epi16(idx, 7)], ctc[_mm_extract_epi16(idx, 6)], ctc[_mm_extract_epi16(idx, 5)], ctc[_mm_extract_epi16(idx, 4)]));
+ }
+#endif
+
+ for(; i < count; i++)
+  target[i] = ctc[pb[i] & 0x3FF];
+}
+
+template<bool TA_SuperGrafx, bool TA_AwesomeMode, bool TA_BoundBox, int32 TA_Ratio>
+NO_INLINE void VCE::MixDotsT(uint32* target, int32& pixel_offset_io, int32* window_counter_io, const uint8* prio, const uint32* ctc, const uint16* pb0, const uint16* pb1, const int32 count)
+{
+ int32 po = pixel_offset_io;
+ int32 wc[2] = { window_counter_io[0], window_counter_io[1] };
+
+ if(TA_AwesomeMode)
+ {
+  for(int32 i = 0; MDFN_LIKELY(i < count); i++)
+  {
+   const uint32 pix = MixDot<TA_SuperGrafx, TA_BoundBox>(wc, prio, ctc, pb0[i], pb1[i]);
+
+   for(int32 s_i = 0; s_i < TA_Ratio; s_i++)
+   {
+    target[po & 2047] = pix;
+    target[(po & 2047) + 1] = boundbox_color;  // see the location of the raster scan
+    target[(po & 2047) + 2] = boundbox_color;
+    po++;
+   }
+  }
+ }
+ else
+ {
+  int32 i = 0;
+
+  // Dots are written in runs that don't cross the wraparound point of the line buffer.
+  while(MDFN_LIKELY(i < count))
+  {
+   const int32 base = po & 2047;
+   const int32 run = std::min<int32>(count - i, 2048 - base);
+   uint32* const out = target + base;
+
+   if(!TA_SuperGrafx && !TA_BoundBox)
+    LookupDots(out, pb0 + i, ctc, run);
+   else
+   {
+    for(int32 j = 0; j < run; j++)
+     out[j] = MixDot<TA_SuperGrafx, TA_BoundBox>(wc, prio, ctc, pb0[i + j], pb1[i + j]);
+   }
+
+   // The marker written after the last dot before the wraparound point isn't overwritten by any later dot.
+   if((base + run) == 2048)
+    target[2048] = target[2049] = boundbox_color;
+
+   i += run;
+   po += run;
+  }
+
+  if(count > 0)
+  {
+   target[((po - 1) & 2047) + 1] = boundbox_color;  // see the location of the raster scan
+   target[((po - 1) & 2047) + 2] = boundbox_color;
+  }
+ }
+
+ pixel_offset_io = po;
+ window_counter_io[0] = wc[0];
+ window_counter_io[1] = wc[1];
+}
+
+template<bool TA_SuperGrafx, bool TA_AwesomeMode>
+INLINE void VCE::MixDots(uint32* target, int32& pixel_offset_io, int32* window_counter_io, const uint8* prio, const int32 ratio, const unsigned flags, const uint32* ctc, const uint16* pb0, const uint16* pb1, const int32 count)
+{
+ #define MIXDOTS_VARIANTS(r)	\
+  if(flags & MIXF_BOUNDBOX)	\
+   MixDotsT<TA_SuperGrafx, TA_AwesomeMode, true,  r>(target, pixel_offset_io, window_counter_io, prio, ctc, pb0, pb1, count);	\
+  else	\
+   MixDotsT<TA_SuperGrafx, TA_AwesomeMode, false, r>(target, pixel_offset_io, window_counter_io, prio, ctc, pb0, pb1, count);
+
+ // The dot clock ratio only matters for the output in awesome mode.
+ switch(TA_AwesomeMode ? ratio : 0)
+ {
+  case 4: MIXDOTS_VARIANTS(TA_AwesomeMode ? 4 : 1) break;
+  case 3: MIXDOTS_VARIANTS(TA_AwesomeMode ? 3 : 1) break;
+  default: MIXDOTS_VARIANTS(TA_AwesomeMode ? 2 : 1) break;
+ }
+
+ #undef MIXDOTS_VARIANTS
+}
+
+//
+// Multithreaded rendering
+//
+enum : uint32
+{
+ MTCMD_SPAN = 0,	// Header(see MT_Flush()), followed by the render streams of both VDCs.
+ MTCMD_PCACHE,
+ MTCMD_WRAP,
+ MTCMD_EXIT
+};
+
+static const uint32 MTQ_SIZE = 1U << 20;	// In 32-bit words; must be a power of 2.
+
+struct VCE::MTRender
+{
+ VDC vdc[2];	// Synchronized with the emulated VDCs at the start of a frame, and then only via the render streams.
+ VDC_RenderStream stream[2];
+
+ uint32 color_table_cache[0x200 * 2];
+ uint16 pixel_buffer[2][2048];
+ uint32* fb;
+
+ // State at the start of the span being recorded.
+ uint32 span_dots;
+ uint32 span_row;
+ int32 span_pixel_offset;
+ int32 span_window_counter[2];
+ uint8 span_priority[2];
+ int32 span_dot_clock_ratio;
+ unsigned span_mix_flags;
+
+ std::unique_ptr<uint32[]> Q;
+ uint8 padding0[64];
+ uint32 WritePos;
+ uint32 ReadPos;
+ uint8 padding1[64];
+ std::atomic_uint_least32_t TMP_WritePos;
+ uint8 padding2[64];
+ std::atomic_uint_least32_t TMP_ReadPos;
+ uint8 padding3[64];
+
+ MThreading::Sem* RT_WakeupSem;
+ MThreading::Sem* WakeupSem;
+ MThreading::Thread* RThread;
+};
+
+void VCE::SetMTRender(const bool enable, const uint64 affinity)
+{
+ MT_Kill();
+
+ if(!enable)
+  return;
+
+ mt = new MTRender();
+ mt->Q.reset(new uint32[MTQ_SIZE]);
+ mt->WritePos = 0;
+ mt->ReadPos = 0;
+ mt->TMP_WritePos = 0;
+ mt->TMP_ReadPos = 0;
+ mt->RT_WakeupSem = NULL;
+ mt->WakeupSem = NULL;
+ mt->RThread = NULL;
+
+ try
+ {
+  mt->RT_WakeupSem = MThreading::Sem_Create();
+  mt->WakeupSem = MThreading::Sem_Create();
+  mt->RThread = MThreading::Thread_Create(MT_ThreadEntry, this, "VDC Render");
+ }
+ catch(...)
+ {
+  MT_Kill();
+  throw;
+ }
+
+ if(affinity)
+  MThreading::Thread_SetAffinity(mt->RThread, affinity);
+}
+
+void VCE::MT_Kill(void)
+{
+ if(!mt)
+  return;
+
+ if(mt_recording)
+  MT_End();
+
+ if(mt->RThread)
+ {
+  MT_Reserve(1)[0] = MTCMD_EXIT;
+  MT_Commit(1);
+  MT_Wakeup(false);
+
+  MThreading::Thread_Wait(mt->RThread, NULL);
+  mt->RThread = NULL;
+ }
+
+ if(mt->RT_WakeupSem)
+ {
+  MThreading::Sem_Destroy(mt->RT_WakeupSem);
+  mt->RT_WakeupSem = NULL;
+ }
+
+ if(mt->WakeupSem)
+ {
+  MThreading::Sem_Destroy(mt->WakeupSem);
+  mt->WakeupSem = NULL;
+ }
+
+ delete mt;
+ mt = NULL;
+}
+
+void VCE::MT_Wakeup(const bool wait_until_empty)
+{
+ MTRender* const m = mt;
+
+ m->TMP_WritePos.store(m->WritePos, std::memory_order_release);
+ m->ReadPos = m->TMP_ReadPos.load(std::memory_order_acquire);
+
+ if(m->ReadPos != m->WritePos)
+ {
+  MThreading::Sem_Post(m->RT_WakeupSem);
+
+  if(wait_until_empty)
+  {
+   do
+   {
+    MThreading::Sem_TimedWait(m->WakeupSem, 1);
+    m->ReadPos = m->TMP_ReadPos.load(std::memory_order_acquire);
+   } while(m->ReadPos != m->WritePos);
+  }
+ }
+}
+
+void VCE::MT_WaitSpace(const uint32 count)
+{
+ MTRender* const m = mt;
+
+ while(MDFN_UNLIKELY((((m->WritePos - m->ReadPos) & (MTQ_SIZE - 1)) + count) >= MTQ_SIZE))
+ {
+  MT_Wakeup(false);
+  MThreading::Sem_TimedWait(m->WakeupSem, 1);
+  m->ReadPos = m->TMP_ReadPos.load(std::memory_order_acquire);
+ }
+}
+
+// Returns a pointer to (count) contiguous words in the queue, which become visible to the render thread after MT_Commit() and MT_Wakeup().
+uint32* VCE::MT_Reserve(const uint32 count)
+{
+ MTRender* const m = mt;
+
+ assert(count < MTQ_SIZE / 2);
+
+ if((m->WritePos + count) >= MTQ_SIZE)
+ {
+  MT_WaitSpace(MTQ_SIZE - m->WritePos);
+  m->Q[m->WritePos] = MTCMD_WRAP;
+  m->WritePos = 0;
+ }
+
+ MT_WaitSpace(count);
+
+ return &m->Q[m->WritePos];
+}
+
+INLINE void VCE::MT_Commit(const uint32 count)
+{
+ mt->WritePos += count;
+}
+
+void VCE::MT_Begin(void)
+{
+ MTRender* const m = mt;
+
+ // The render thread is idle here.
+ m->fb = fb;
+ memcpy(m->color_table_cache, color_table_cache, sizeof(color_table_cache));
+
+ for(unsigned chip = 0; chip < chip_count; chip++)
+ {
+  if(vdc[chip].TestVRAMChangedUnstreamed())
+   m->vdc[chip].CopyVRAM(vdc[chip]);
+
+  m->stream[chip].Clear();
+  vdc[chip].SetRenderStream(&m->stream[chip]);
+ }
+
+ m->span_dots = 0;
+ mt_recording = true;
+}
+
+void VCE::MT_End(void)
+{
+ MT_Flush();
+
+ for(unsigned chip = 0; chip < chip_count; chip++)
+  vdc[chip].SetRenderStream(NULL);
+
+ mt_recording = false;
+
+ MT_Wakeup(true);
+}
+
+void VCE::MT_Flush(void)
+{
+ MTRender* const m = mt;
+ const uint32 n0 = m->stream[0].Size();
+ const uint32 n1 = m->stream[1].Size();
+
+ if(!m->span_dots && !n0 && !n1)
+  return;
+
+ uint32* p = MT_Reserve(8 + n0 + n1);
+
+ p[0] = MTCMD_SPAN | (m->span_dots << 4);
+ p[1] = m->span_row;
+ p[2] = m->span_pixel_offset;
+ p[3] = m->span_window_counter[0];
+ p[4] = m->span_window_counter[1];
+ p[5] = m->span_priority[0] | (m->span_priority[1] << 8) | (m->span_dot_clock_ratio << 16) | (m->span_mix_flags << 24);
+ p[6] = n0;
+ p[7] = n1;
+ memcpy(p + 8, m->stream[0].Data(), n0 * sizeof(uint32));
+ memcpy(p + 8 + n0, m->stream[1].Data(), n1 * sizeof(uint32));
+
+ MT_Commit(8 + n0 + n1);
+
+ m->stream[0].Clear();
+ m->stream[1].Clear();
+ m->span_dots = 0;
+}
+
+//
+// Advances the mixing state like MixDots() would, leaving the mixing itself to the render thread.
+//
+template<bool TA_SuperGrafx, bool TA_AwesomeMode>
+INLINE void VCE::MT_AddDots(const int32 count)
+{
+ MTRender* const m = mt;
+
+ if(!m->span_dots)
+ {
+  m->span_row = scanline_out_ptr - fb;
+  m->span_pixel_offset = pixel_offset;
+  m->span_window_counter[0] = window_counter[0];
+  m->span_window_counter[1] = window_counter[1];
+  m->span_priority[0] = priority[0];
+  m->span_priority[1] = priority[1];
+  m->span_dot_clock_ratio = dot_clock_ratio;
+  m->span_mix_flags = mix_flags;
+ }
+
+ m->span_dots += count;
+ pixel_offset += TA_AwesomeMode ? count * dot_clock_ratio : count;
+
+ if(TA_SuperGrafx)
+ {
+  for(unsigned w = 0; w < 2; w++)
+  {
+   if(window_counter[w] > 0x40)
+    window_counter[w] = std::max<int32>(0x40, window_counter[w] - count);
+  }
+ }
+
+ if(MDFN_UNLIKELY((m->stream[0].Size() + m->stream[1].Size()) >= 8192))
+  MT_Flush();
+}
+
+void VCE::MT_PCache(const unsigned entry)
+{
+ uint32* p = MT_Reserve(2);
+
+ p[0] = MTCMD_PCACHE | (entry << 4);
+ p[1] = color_table_cache[entry];
+
+ MT_Commit(2);
+}
+
+int VCE::MT_ThreadEntry(void* data)
+{
+ ((VCE*)data)->MT_RenderLoop();
+
+ return 0;
+}
+
+void VCE::MT_RenderLoop(void)
+{
+ MTRender* const m = mt;
+ uint32 ReadPos = 0;
+ uint32 WritePos = 0;
+ bool Running = true;
+
+ while(MDFN_LIKELY(Running))
+ {
+  WritePos = m->TMP_WritePos.load(std::memory_order_acquire);
+
+  while(ReadPos == WritePos)
+  {
+   MThreading::Sem_Post(m->WakeupSem);
+   MThreading::Sem_TimedWait(m->RT_WakeupSem, 1);
+   WritePos = m->TMP_WritePos.load(std::memory_order_acquire);
+  }
+
+  while(ReadPos != WritePos)
+  {
+   const uint32* p = &m->Q[ReadPos];
+   uint32 len = 1;
+
+   switch(p[0] & 0xF)
+   {
+    case MTCMD_SPAN:
+	{
+	 const int32 dots = p[0] >> 4;
+	 const uint32 n0 = p[6];
+	 const uint32 n1 = p[7];
+
+	 m->vdc[0].ReplayRenderStream(p + 8, n0, m->pixel_buffer[0]);
+
+	 if(n1)
+	  m->vdc[1].ReplayRenderStream(p + 8 + n0, n1, m->pixel_buffer[1]);
+
+	 if(dots)
+	 {
+	  uint32* target = m->fb + p[1];
+	  int32 po = p[2];
+	  int32 wc[2] = { (int32)p[3], (int32)p[4] };
+	  const uint8 prio[2] = { (uint8)p[5], (uint8)(p[5] >> 8) };
+	  const int32 ratio = (p[5] >> 16) & 0xFF;
+	  const unsigned flags = p[5] >> 24;
+
+#ifdef MDFN_PCE_VCE_AWESOMEMODE
+	  if(sgfx)
+	   MixDots<true, true>(target, po, wc, prio, ratio, flags, m->color_table_cache, m->pixel_buffer[0], m->pixel_buffer[1], dots);
+	  else
+	   MixDots<false, true>(target, po, wc, prio, ratio, flags, m->color_table_cache, m->pixel_buffer[0], m->pixel_buffer[1], dots);
+#else
+	  if(sgfx)
+	   MixDots<true, false>(target, po, wc, prio, ratio, flags, m->color_table_cache, m->pixel_buffer[0], m->pixel_buffer[1], dots);
+	  else
+	   MixDots<false, false>(target, po, wc, prio, ratio, flags, m->color_table_cache, m->pixel_buffer[0], m->pixel_buffer[1], dots);
+#endif
+	 }
+
+	 len = 8 + n0 + n1;
+	}
+	break;
+
+    case MTCMD_PCACHE:
+	m->color_table_cache[p[0] >> 4] = p[1];
+	len = 2;
+	break;
+
+    case MTCMD_WRAP:
+	len = MTQ_SIZE - ReadPos;
+	break;
+
+    case MTCMD_EXIT:
+	Running = false;
+	break;
+   }
+
+   ReadPos = (ReadPos + len) & (MTQ_SIZE - 1);
+   m->TMP_ReadPos.store(ReadPos, std::memory_order_release);
+  }
+ }
+}
+
 template<bool TA_SuperGrafx, bool TA_AwesomeMode>
 INLINE void VCE::SyncSub(int32 clocks)
 {
@@ -375,141 +932,18 @@ INLINE void VCE::SyncSub(int32 clocks)
 
   if(div_clocks > 0)
   {
-   child_event[0] = vdc[0].Run(div_clocks, pixel_buffer[0], skipframe);
-   if(TA_SuperGrafx)
-    child_event[1] = vdc[1].Run(div_clocks, pixel_buffer[1], skipframe);
-
-   if(!skipframe)
    {
-    if(TA_SuperGrafx)
-    {
-     for(int32 i = 0; MDFN_LIKELY(i < div_clocks); i++) // * vce_ratios[dot_clock]; i++)
-     {
-      static const int prio_select[4] = { 1, 1, 0, 0 };
-      static const int prio_shift[4] = { 4, 0, 4, 0 };
-      uint32 pix;
-      int in_window = 0;
+    MDFN_ProfileZone pz(PROFZONE_VDC);
 
-      if(window_counter[0] > 0x40)
-      {
-       in_window |= 1;
-       window_counter[0]--;
-      }
-
-      if(window_counter[1] > 0x40)
-      {
-       in_window |= 2;
-       window_counter[1]--;
-      }
-
-      uint8 pb = (priority[prio_select[in_window]] >> prio_shift[in_window]) & 0xF;
-      uint32 vdc2_pixel, vdc1_pixel;
-
-      vdc2_pixel = vdc1_pixel = 0;
-
-      if(pb & 1)
-       vdc1_pixel = pixel_buffer[0][i] & 0x3FF;
-      if(pb & 2)
-       vdc2_pixel = pixel_buffer[1][i] & 0x3FF;
-
-      /* Dai MakaiMura uses setting 1, and expects VDC #2 sprites in front of VDC #1 background, but
-        behind VDC #1's sprites.
-      */
-      switch(pb & 3)
-      {
-        case 0:
-           vdc1_pixel = 0;
-           vdc2_pixel = 0;
-           break;
-
-        case 1:
-           vdc2_pixel = 0;
-           break;
-
-        case 2:
-           vdc1_pixel = 0;
-           break;
-
-        default:
-           switch(pb >> 2)
-           {
-            case 1:
-                     if((vdc2_pixel & 0x100) && !(vdc1_pixel & 0x100) && (vdc2_pixel & 0xF))
-                             vdc1_pixel = 0; //amask;
-                     break;
-            case 2:
-                     if((vdc1_pixel & 0x100) && !(vdc2_pixel & 0x100) && (vdc2_pixel & 0xF))
-                             vdc1_pixel = 0; //|= amask;
-                     break;
-           }
-      }
-      if ( (pixel_buffer[0][i] & VDC_BOUND_BOX_MASK) || (pixel_buffer[1][i] & VDC_BOUND_BOX_MASK) )
-       pix = boundbox_color;  // magenta bound box
-      else
-      {
-       if ((vdc1_pixel & 0x0f) != 0)
-         pix = color_table_cache[vdc1_pixel & 0x1FF];
-       else
-         pix = color_table_cache[((vdc2_pixel & 0x1FF) ? vdc2_pixel : vdc1_pixel) & 0x1FF];
-      }
+    child_event[0] = vdc[0].Run(div_clocks, pixel_buffer[0], skipframe);
+    if(TA_SuperGrafx)
+     child_event[1] = vdc[1].Run(div_clocks, pixel_buffer[1], skipframe);
+   }
 
-      if(TA_AwesomeMode)
-      {
-       for(int32 s_i = 0; s_i < dot_clock_ratio; s_i++)
-       {
-        scanline_out_ptr[pixel_offset & 2047] = pix;
-        scanline_out_ptr[(pixel_offset & 2047) + 1] = boundbox_color;  // see the location of the raster scan
-        scanline_out_ptr[(pixel_offset & 2047) + 2] = boundbox_color;
-        pixel_offset++;
-       }
-      }
-      else
-      {
-       scanline_out_ptr[pixel_offset & 2047] = pix;
-       scanline_out_ptr[(pixel_offset & 2047) + 1] = boundbox_color;  // see the location of the raster scan
-       scanline_out_ptr[(pixel_offset & 2047) + 2] = boundbox_color;
-       pixel_offset++;
-      }
-     }
-    }
-    else
-    {
-     if(TA_AwesomeMode)
-     {
-      for(int32 i = 0; MDFN_LIKELY(i < div_clocks); i++)
-      {
-       for(int32 si = 0; si < dot_clock_ratio; si++)
-       {
-        uint32 pix;
-        if (pixel_buffer[0][i] & VDC_BOUND_BOX_MASK)
-         pix = boundbox_color;  // magenta bound box
-        else
-         pix = color_table_cache[pixel_buffer[0][i] & 0x3FF];
-
-        scanline_out_ptr[pixel_offset & 2047] = pix;
-        scanline_out_ptr[(pixel_offset & 2047) + 1] = boundbox_color;  // see the location of the raster scan
-        scanline_out_ptr[(pixel_offset & 2047) + 2] = boundbox_color;
-        pixel_offset++;
-       }
-      }
-     }
-     else
-     {
-      for(int32 i = 0; MDFN_LIKELY(i < div_clocks); i++) // * vce_ratios[dot_clock]; i++)
-      {
-       uint32 pix;
-       if (pixel_buffer[0][i] & VDC_BOUND_BOX_MASK)
-        pix = boundbox_color;  // magenta bound box
-       else
-        pix = color_table_cache[pixel_buffer[0][i] & 0x3FF];
-       scanline_out_ptr[pixel_offset & 2047] = pix;
-       scanline_out_ptr[(pixel_offset & 2047) + 1] = boundbox_color;  // see the location of the raster scan
-       scanline_out_ptr[(pixel_offset & 2047) + 2] = boundbox_color;
-       pixel_offset++;
-      }
-     }
-    }
-   }	// end if(!skipframe)
+   if(mt_recording)
+    MT_AddDots<TA_SuperGrafx, TA_AwesomeMode>(div_clocks);
+   else if(!skipframe)
+    MixDots<TA_SuperGrafx, TA_AwesomeMode>(scanline_out_ptr, pixel_offset, window_counter, priority, dot_clock_ratio, mix_flags, color_table_cache, pixel_buffer[0], pixel_buffer[1], div_clocks);
   } // end if(div_clocks > 0)
 
   clocks -= chunk_clocks;
@@ -525,6 +959,12 @@ INLINE void VCE::SyncSub(int32 clocks)
    }
    else
    {
+    if(mt_recording)
+    {
+     MT_Flush();
+     MT_Wakeup(false);
+    }
+
     if(sgfx)
     {
      int add = 8 + ((dot_clock == 1) ? 38 : 24);
@@ -609,9 +1049,13 @@ INLINE void VCE::SyncSub(int32 clocks)
    }
    hblank_counter = hblank ? 237 : 1128;
 
-   child_event[0] = vdc[0].HSync(hblank);
-   if(TA_SuperGrafx)
-    child_event[1] = vdc[1].HSync(hblank);
+   {
+    MDFN_ProfileZone pz(PROFZONE_VDC);
+
+    child_event[0] = vdc[0].HSync(hblank);
+    if(TA_SuperGrafx)
+     child_event[1] = vdc[1].HSync(hblank);
+   }
   }
 
   vblank_counter -= chunk_clocks;
@@ -625,23 +1069,24 @@ INLINE void VCE::SyncSub(int32 clocks)
     NeedSLReset = true;
    }
 
-   child_event[0] = vdc[0].VSync(vblank);
-   if(TA_SuperGrafx)
-    child_event[1] = vdc[1].VSync(vblank);
+   {
+    MDFN_ProfileZone pz(PROFZONE_VDC);
+
+    child_event[0] = vdc[0].VSync(vblank);
+    if(TA_SuperGrafx)
+     child_event[1] = vdc[1].VSync(vblank);
+   }
   }
  }
 }
 
-// If we ignore the return value of Sync(), we must do "HuCPU.SetEvent(CalcNextEvent());"
-// before the function(read/write functions) that called Sync() return!
+// If we ignore the return value of Sync(), we must do "SetEvent();" before the function(read/write functions) that
+// called Sync() return!
 INLINE int32 VCE::SyncReal(const int32 timestamp)
 {
+ MDFN_ProfileZone pz(PROFZONE_VCE);
  int32 clocks = timestamp - last_ts;
 
- cd_event -= clocks;
- if(cd_event <= 0)
-  cd_event = PCECD_Run(timestamp);
-
 #ifdef MDFN_PCE_VCE_AWESOMEMODE
  if(sgfx)
   SyncSub<true, true>(clocks);
@@ -669,18 +1114,16 @@ static MDFN_FASTCALL NO_INLINE int32 Sync(const int32 timestamp)
  return vce->SyncReal(timestamp);
 }
 
-// So wrong, but feels so...MUSHROOMY.
-// THIS IS BROKEN!
-// We need to put Sync() call before that, or bias
-// cd_event and the value to HuCPU.SetEvent by (HuCPU.timestamp - last_ts)
-void VCE::SetCDEvent(const int32 cycles)
+int32 VCE::Update(const int32 timestamp)
 {
- const int32 time_behind = HuCPU.Timestamp() - last_ts;
-
- assert(time_behind >= 0);
+ return SyncReal(timestamp);
+}
 
- cd_event = cycles + time_behind;
- HuCPU.SetEvent(CalcNextEvent() - time_behind);
+// Relative to the CPU's current timestamp rather than last_ts, so cycles stolen by WS_Hook() after Sync() push the
+// next VCE event back with them.
+INLINE void VCE::SetEvent(void)
+{
+ PCE_SetEvent(PCE_EVENT_VCE, HuCPU.Timestamp() + CalcNextEvent());
 }
 
 void VCE::FixPCache(int entry)
@@ -690,13 +1133,21 @@ void VCE::FixPCache(int entry)
  if(!(entry & 0xFF))
  {
   for(int x = 0; x < 16; x++)
+  {
    color_table_cache[(entry & 0x100) + (x << 4)] = csl[color_table[entry & 0x100]];
+
+   if(mt_recording)
+    MT_PCache((entry & 0x100) + (x << 4));
+  }
  }
 
  if(!(entry & 0xF))
   return;
 
  color_table_cache[entry] = csl[color_table[entry]];
+
+ if(mt_recording)
+  MT_PCache(entry);
 }
 
 void VCE::SetVCECR(uint8 V)
@@ -790,7 +1241,7 @@ uint8 VCE::Read(uint32 A)
  }
 
  if(!PCE_InDebug)
-  HuCPU.SetEvent(CalcNextEvent());
+  SetEvent();
 
  return(ret);
 }
@@ -806,6 +1257,9 @@ void VCE::Write(uint32 A, uint8 V)
 	  {
 	   int old_dot_clock = dot_clock;
 
+	   if(mt_recording)
+	    MT_Flush();
+
 	   SetVCECR(V);
 
 	   if(old_dot_clock != dot_clock)	// FIXME, this is wrong.  A total fix will require changing the meaning
@@ -819,19 +1273,25 @@ void VCE::Write(uint32 A, uint8 V)
   case 2: ctaddress &= 0x100; ctaddress |= V; break;
   case 3: ctaddress &= 0x0FF; ctaddress |= (V & 1) << 8; break;
 
-  case 4: color_table[ctaddress & 0x1FF] &= 0x100;
+  case 4: if(mt_recording)
+	   MT_Flush();
+
+	  color_table[ctaddress & 0x1FF] &= 0x100;
 	  color_table[ctaddress & 0x1FF] |= V;
 	  FixPCache(ctaddress & 0x1FF);
           break;
 
-  case 5: color_table[ctaddress & 0x1FF] &= 0xFF;
+  case 5: if(mt_recording)
+	   MT_Flush();
+
+	  color_table[ctaddress & 0x1FF] &= 0xFF;
 	  color_table[ctaddress & 0x1FF] |= (V & 1) << 8;
 	  FixPCache(ctaddress & 0x1FF);
 	  ctaddress = (ctaddress + 1) & 0x1FF;
 	  break;
  }
 
- HuCPU.SetEvent(CalcNextEvent());
+ SetEvent();
 }
 
 uint8 VCE::ReadVDC(uint32 A)
@@ -881,7 +1341,7 @@ uint8 VCE::ReadVDC(uint32 A)
  }
 
  if(!PCE_InDebug)
-  HuCPU.SetEvent(CalcNextEvent());
+  SetEvent();
 
  return(ret);
 }
@@ -905,6 +1365,9 @@ void VCE::WriteVDC(uint32 A, uint8 V)
 
   if(A & 0x8)
   {
+   if(mt_recording)
+    MT_Flush();
+
    switch(A)
    {
     case 0x8: priority[0] = V; break;
@@ -923,7 +1386,7 @@ void VCE::WriteVDC(uint32 A, uint8 V)
   }
  }
 
- HuCPU.SetEvent(CalcNextEvent());
+ SetEvent();
 }
 
 void VCE::WriteVDC_ST(uint32 A, uint8 V)
@@ -940,7 +1403,7 @@ void VCE::WriteVDC_ST(uint32 A, uint8 V)
   vdc[chip].Write(A, V, child_event[chip]);
  }
 
- HuCPU.SetEvent(CalcNextEvent());
+ SetEvent();
 }
 
 void VCE::SetLayerEnableMask(uint64 mask)
@@ -954,6 +1417,14 @@ void VCE::SetLayerEnableMask(uint64 mask)
   else
     vdc[chip].SetSprBoundBox(true);
  }
+
+ if(mt_recording)
+  MT_Flush();
+
+ mix_flags &= ~MIXF_BOUNDBOX;
+
+ if(!((mask >> 9) & 1))
+  mix_flags |= MIXF_BOUNDBOX;
 }
 
 void VCE::StateAction(StateMem *sm, const unsigned load, const bool data_only)
@@ -1018,9 +1489,6 @@ void VCE::StateAction(StateMem *sm, const unsigned load, const bool data_only)
   else if(vblank_counter > 400000)
    vblank_counter = 400000;
 
-  if(cd_event < 1)
-   cd_event = 1;
-
   for(unsigned chip = 0; chip < chip_count; chip++)
   {
    if(child_event[chip] < 1)
@@ -36,14 +36,20 @@ class VCE final
 	void SetShowHorizOS(bool show);
 	void SetLayerEnableMask(uint64 mask);
 
+	// Moves BG/sprite composition and VCE mixing for non-skipped frames into a separate render thread; an affinity of 0 leaves the
+	// thread's CPU affinity alone.
+	void SetMTRender(const bool enable, const uint64 affinity = 0);
+
 	void StateAction(StateMem *sm, const unsigned load, const bool data_only);
 
 	void SetPixelFormat(const MDFN_PixelFormat &format, const uint8* CustomColorMap, const uint32 CustomColorMapLen);
 
 	void StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, int32 *LineWidths, int skip);
 	bool RunPartial(void);
+	void EndFrame(void);
 
-        void Update(const int32 timestamp);
+	// Synchronizes the VCE and VDC(s) to 'timestamp', and returns the number of cycles until their next event.
+	int32 Update(const int32 timestamp);
 
 	INLINE void ResetTS(int ts_base)
 	{
@@ -202,7 +208,6 @@ class VCE final
 
         bool WS_Hook(int32 vdc_cycles);
 
-	void SetCDEvent(const int32 cycles);
 
 	//
 	//
@@ -216,6 +221,42 @@ class VCE final
 	template<bool TA_SuperGrafx, bool TA_AwesomeMode>
 	void SyncSub(int32 clocks);
 
+	enum
+	{
+	 MIXF_BOUNDBOX = 0x1
+	};
+
+	template<bool TA_SuperGrafx, bool TA_BoundBox>
+	uint32 MixDot(int32* wc, const uint8* prio, const uint32* ctc, const uint16 p0, const uint16 p1);
+
+	template<bool TA_SuperGrafx, bool TA_AwesomeMode, bool TA_BoundBox, int32 TA_Ratio>
+	void MixDotsT(uint32* target, int32& pixel_offset_io, int32* window_counter_io, const uint8* prio, const uint32* ctc, const uint16* pb0, const uint16* pb1, const int32 count);
+
+	template<bool TA_SuperGrafx, bool TA_AwesomeMode>
+	void MixDots(uint32* target, int32& pixel_offset_io, int32* window_counter_io, const uint8* prio, const int32 ratio, const unsigned flags, const uint32* ctc, const uint16* pb0, const uint16* pb1, const int32 count);
+
+	//
+	// Multithreaded rendering; the VDCs record into render streams, which are sent with the state needed for
+	// mixing to the render thread in spans of dots that end at the end of a line, or before a VCE or VPC change that affects mixing.
+	//
+	struct MTRender;
+	MTRender* mt;
+	bool mt_recording;
+
+	void MT_Begin(void);
+	void MT_End(void);
+	void MT_Flush(void);
+	template<bool TA_SuperGrafx, bool TA_AwesomeMode>
+	void MT_AddDots(const int32 count);
+	void MT_PCache(const unsigned entry);
+	uint32* MT_Reserve(const uint32 count);
+	void MT_Commit(const uint32 count);
+	void MT_WaitSpace(const uint32 count);
+	void MT_Wakeup(const bool wait_until_empty);
+	void MT_Kill(void) MDFN_COLD;
+	static int MT_ThreadEntry(void* data);
+	void MT_RenderLoop(void);
+
         void FixPCache(int entry);
         void SetVCECR(uint8 V);
 
@@ -224,14 +265,14 @@ class VCE final
 	#endif
 
 	int32 CalcNextEvent(void);
+	void SetEvent(void);
 	int32 child_event[2];
 
-        int32 cd_event;
-
 	uint32 *fb;	// Pointer to the framebuffer.
 	uint32 pitch32;	// Pitch(in 32-bit pixels)
 	bool FrameDone;
 	bool ShowHorizOS;
+	unsigned mix_flags;	// MIXF_*
 	bool sgfx;
 
 	bool mwr_approximate;  // flag whether to approximate MWR timing round-robin
@@ -17,6 +17,7 @@
 
 #include "pce.h"
 #include "vdc.h"
+#include <mednafen/profile.h>
 
 namespace MDFN_IEN_PCE_FAST
 {
@@ -606,6 +607,7 @@ void HuC6280_Power(void)
 
 void HuC6280_Run(int32 cycles)
 {
+	MDFN_ProfileZone pz(PROFZONE_CPU);
 	const int32 next_user_event = HuCPU.previous_next_user_event + cycles * pce_overclocked;
 
 	HuCPU.previous_next_user_event = next_user_event;
@@ -26,6 +26,7 @@
 #include <mednafen/hw_misc/arcade_card/arcade_card.h>
 #include <mednafen/mempatcher.h>
 #include <mednafen/cdrom/CDInterface.h>
+#include <mednafen/profile.h>
 
 namespace MDFN_IEN_PCE_FAST
 {
@@ -119,7 +120,11 @@ static DECLFW(IOWrite)
 	       break;
 
   case 2: PCEIODataBuffer = V;
-	       psg->Write(HuCPU.timestamp / pce_overclocked, A, V);
+	       {
+		MDFN_ProfileZone pz(PROFZONE_PSG);
+
+	        psg->Write(HuCPU.timestamp / pce_overclocked, A, V);
+	       }
 	       break;
 
   case 3: PCEIODataBuffer = V;
@@ -524,21 +529,29 @@ static void Emulate(EmulateSpecStruct *espec)
    sbuf[y].bass_freq(10);
   }
  }
- VDC_RunFrame(espec, IsHES);
+ {
+  MDFN_ProfileZone pz(PROFZONE_VDC);
+
+  VDC_RunFrame(espec, IsHES);
+ }
 
  if(PCE_IsCD)
  {
   PCECD_Run(HuCPU.timestamp * 3);
  }
 
- psg->EndFrame(HuCPU.timestamp / pce_overclocked);
-
- if(espec->SoundBuf)
  {
-  for(int y = 0; y < 2; y++)
+  MDFN_ProfileZone pz(PROFZONE_PSG);
+
+  psg->EndFrame(HuCPU.timestamp / pce_overclocked);
+
+  if(espec->SoundBuf)
   {
-   sbuf[y].end_frame(HuCPU.timestamp / pce_overclocked);
-   espec->SoundBufSize = sbuf[y].read_samples(espec->SoundBuf + y, espec->SoundBufMaxSize, 1);
+   for(int y = 0; y < 2; y++)
+   {
+    sbuf[y].end_frame(HuCPU.timestamp / pce_overclocked);
+    espec->SoundBufSize = sbuf[y].read_samples(espec->SoundBuf + y, espec->SoundBufMaxSize, 1);
+   }
   }
  }
 
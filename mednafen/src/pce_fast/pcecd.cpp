@@ -27,6 +27,7 @@
 #include <mednafen/cdrom/CDInterface.h>
 #include <mednafen/cdrom/SimpleFIFO.h>
 #include <mednafen/sound/okiadpcm.h>
+#include <mednafen/profile.h>
 
 using namespace Mednafen;
 
@@ -384,6 +385,7 @@ bool PCECD_IsBRAMEnabled(void)
 
 MDFN_FASTCALL uint8 PCECD_Read(uint32 timestamp, uint32 A)
 {
+ MDFN_ProfileZone pz(PROFZONE_CD);
  uint8 ret = 0;
 
  if((A & 0x18c0) == 0x18c0)
@@ -511,6 +513,7 @@ static INLINE void Fader_Run(const int32 clocks)
 
 MDFN_FASTCALL void PCECD_Write(uint32 timestamp, uint32 physAddr, uint8 data)
 {
+ MDFN_ProfileZone pz(PROFZONE_CD);
 	const uint8 V = data;
 
 	#ifdef PCECD_DEBUG
@@ -855,6 +858,7 @@ static INLINE void ADPCM_Run(const int32 clocks, const int32 timestamp)
 
 MDFN_FASTCALL void PCECD_Run(uint32 in_timestamp)
 {
+ MDFN_ProfileZone pz(PROFZONE_CD);
  int32 clocks = in_timestamp - lastts;
  int32 running_ts = lastts;
 
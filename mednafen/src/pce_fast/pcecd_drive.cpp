@@ -436,9 +436,10 @@ static void CommandCCError(int key, int asc = 0, int ascq = 0)
  SendStatusAndMessage(STATUS_CHECK_CONDITION, 0x00);
 }
 
-static bool ValidateRawDataSector(uint8 *data, const uint32 lba)
+// 'cooked' is from ReadRawSectorCooked(); the EDC/L-EC check is skipped for such sectors.
+static bool ValidateRawDataSector(uint8 *data, const uint32 lba, const bool cooked)
 {
- if(!edc_lec_check_and_correct(data, false))
+ if(!cooked && !edc_lec_check_and_correct(data, false))
  {
   MDFN_Notify(MDFN_NOTICE_WARNING, _("Uncorrectable error(s) in sector %d."), lba);
 
@@ -982,6 +983,7 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
    else
    {
     uint8 tmp_read_buf[2352 + 96];
+    bool tmp_read_cooked;
 
     if(TrayOpen)
     {
@@ -998,13 +1000,13 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
     {
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST, NSE_END_OF_VOLUME);
     }
-    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr))	//, SectorAddr + SectorCount))
+    else if(!Cur_CDIF->ReadRawSectorCooked(tmp_read_buf, SectorAddr, &tmp_read_cooked))	//, SectorAddr + SectorCount))
     {
      cd.data_transfer_done = false;
 
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST);
     }
-    else if(ValidateRawDataSector(tmp_read_buf, SectorAddr))
+    else if(ValidateRawDataSector(tmp_read_buf, SectorAddr, tmp_read_cooked))
     {
      memcpy(cd.SubPWBuf, tmp_read_buf + 2352, 96);
 
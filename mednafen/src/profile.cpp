@@ -0,0 +1,91 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* profile.cpp:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "mednafen.h"
+#include "profile.h"
+#include "Time.h"
+
+namespace Mednafen
+{
+
+bool MDFNPROF_Active = false;
+static unsigned CurZone;
+static int64 LastTime;
+static int64 ZoneTime[PROFZONE__COUNT];
+
+static const char* const ZoneNames[PROFZONE__COUNT] =
+{
+ "none",
+ "cpu",
+ "vdc",
+ "vce",
+ "psg",
+ "cd",
+ "process_audio",
+ "deinterlace",
+ "tblur",
+};
+
+void MDFNPROF_Start(void)
+{
+ memset(ZoneTime, 0, sizeof(ZoneTime));
+ CurZone = PROFZONE_NONE;
+ LastTime = Time::MonoNS();
+ MDFNPROF_Active = true;
+}
+
+void MDFNPROF_Stop(void)
+{
+ if(MDFNPROF_Active)
+ {
+  MDFNPROF_Switch(PROFZONE_NONE);
+  MDFNPROF_Active = false;
+ }
+}
+
+void MDFNPROF_GetZoneTimes(int64 (&zone_ns)[PROFZONE__COUNT])
+{
+ if(MDFNPROF_Active)
+  MDFNPROF_Switch(CurZone);
+
+ memcpy(zone_ns, ZoneTime, sizeof(ZoneTime));
+}
+
+const char* MDFNPROF_GetZoneName(const unsigned zone)
+{
+ assert(zone < PROFZONE__COUNT);
+
+ return ZoneNames[zone];
+}
+
+unsigned MDFNPROF_Switch(const unsigned zone)
+{
+ const int64 now = Time::MonoNS();
+ const unsigned ret = CurZone;
+
+ ZoneTime[CurZone] += now - LastTime;
+ LastTime = now;
+ CurZone = zone;
+
+ return ret;
+}
+
+}
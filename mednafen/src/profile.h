@@ -0,0 +1,83 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* profile.h:
+**  Copyright (C) 2024 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_PROFILE_H
+#define __MDFN_PROFILE_H
+
+namespace Mednafen
+{
+
+//
+// Coarse per-subsystem accounting of emulation thread time, for benchmarking.  Time is charged only to the innermost
+// active zone, so a zone entered from inside another one(e.g. the VDC being caught up from a CPU I/O write) isn't
+// counted twice.  While profiling isn't running, an MDFN_ProfileZone costs a single well-predicted branch.
+//
+enum : unsigned
+{
+ PROFZONE_NONE = 0,	// Time outside of all other zones.
+ PROFZONE_CPU,
+ PROFZONE_VDC,
+ PROFZONE_VCE,
+ PROFZONE_PSG,
+ PROFZONE_CD,
+ PROFZONE_PROCESS_AUDIO,
+ PROFZONE_DEINTERLACE,
+ PROFZONE_TBLUR,
+
+ PROFZONE__COUNT
+};
+
+void MDFNPROF_Start(void);
+void MDFNPROF_Stop(void);
+
+// Nanoseconds spent in each zone since MDFNPROF_Start().
+void MDFNPROF_GetZoneTimes(int64 (&zone_ns)[PROFZONE__COUNT]);
+const char* MDFNPROF_GetZoneName(const unsigned zone);
+
+// Only for MDFN_ProfileZone; returns the previously-active zone.
+unsigned MDFNPROF_Switch(const unsigned zone);
+
+MDFN_HIDE extern bool MDFNPROF_Active;
+
+class MDFN_ProfileZone
+{
+ public:
+
+ INLINE MDFN_ProfileZone(const unsigned zone) : prev_zone(MDFN_UNLIKELY(MDFNPROF_Active) ? MDFNPROF_Switch(zone) : ~0U)
+ {
+
+ }
+
+ INLINE ~MDFN_ProfileZone()
+ {
+  if(MDFN_UNLIKELY(prev_zone != ~0U))
+   MDFNPROF_Switch(prev_zone);
+ }
+
+ private:
+ MDFN_ProfileZone(const MDFN_ProfileZone&) = delete;
+ MDFN_ProfileZone& operator=(const MDFN_ProfileZone&) = delete;
+
+ const unsigned prev_zone;
+};
+
+}
+#endif
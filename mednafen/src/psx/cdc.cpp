@@ -226,6 +226,7 @@ void PS_CDC::Power(void)
  SPU->Power();
 
  memset(SectorPipe, 0, sizeof(SectorPipe));
+ memset(SectorPipe_Cooked, 0, sizeof(SectorPipe_Cooked));
  memset(SB, 0, sizeof(SB));
  memset(AsyncResultsPending, 0, sizeof(AsyncResultsPending));
  memset(&DMABuffer.data[0], 0, DMABuffer.data.size());
@@ -289,6 +290,7 @@ void PS_CDC::StateAction(StateMem *sm, const unsigned load, const bool data_only
   SFVAR(SB_In),
 
   SFVARN(SectorPipe, "&SectorPipe[0][0]"),
+  SFVAR(SectorPipe_Cooked),
   SFVAR(SectorPipe_Pos),
   SFVAR(SectorPipe_In),
 
@@ -874,6 +876,7 @@ void PS_CDC::EnbufferizeCDDASector(const uint8 *buf)
 void PS_CDC::HandlePlayRead(void)
 {
  uint8 read_buf[2352 + 96];
+ bool read_cooked;
 
  //PSX_WARNING("Read sector: %d", CurSector);
 
@@ -892,9 +895,16 @@ void PS_CDC::HandlePlayRead(void)
   PSX_WARNING("[CDC] In leadout area: %u", CurSector);
  }
 
- Cur_CDIF->ReadRawSector(read_buf, CurSector);	// FIXME: error out on error.
+ Cur_CDIF->ReadRawSectorCooked(read_buf, CurSector, &read_cooked);	// FIXME: error out on error.
  DecodeSubQ(read_buf + 2352);
 
+ // Playing(the report level) uses the whole raw sector; reading fills in the EDC/L-EC later, for sectors actually delivered.
+ if(read_cooked && DriveStatus == DS_PLAYING)
+ {
+  encode_mode1_sector(LBA_to_ABA(CurSector), read_buf);
+  read_cooked = false;
+ }
+
  if(SubQBuf_Safe[1] == 0xAA && (DriveStatus == DS_PLAYING || (DriveStatus == DS_READING && !(SubQBuf_Safe[0] & 0x40) && (Mode & MODE_CDDA))))
  {
   HeaderBufValid = false;
@@ -973,6 +983,7 @@ void PS_CDC::HandlePlayRead(void)
  if(SectorPipe_In >= SectorPipe_Count)
  {
   uint8* buf = SectorPipe[SectorPipe_Pos];
+  const bool cooked = SectorPipe_Cooked[SectorPipe_Pos];
   SectorPipe_In--;
 
   if(SubQBuf_Safe[0] & 0x40) // Data sector
@@ -1028,7 +1039,11 @@ void PS_CDC::HandlePlayRead(void)
     else
     {
      // maybe if(!(Mode & 0x30)) too?
-     if(!(buf[12 + 6] & 0x20))
+     // Every mode's window into a mode 1 sector includes at least its EDC, so fill in what was skipped; the
+     // check is still unnecessary.
+     if(cooked)
+      encode_mode1_sector(AMSF_to_ABA(BCD_to_U8(buf[12 + 0]), BCD_to_U8(buf[12 + 1]), BCD_to_U8(buf[12 + 2])), buf);
+     else if(!(buf[12 + 6] & 0x20))
      {
       if(!edc_lec_check_and_correct(buf, true))
       {
@@ -1094,6 +1109,7 @@ void PS_CDC::HandlePlayRead(void)
  }
 
  memcpy(SectorPipe[SectorPipe_Pos], read_buf, 2352);
+ SectorPipe_Cooked[SectorPipe_Pos] = read_cooked;
  SectorPipe_Pos = (SectorPipe_Pos + 1) % SectorPipe_Count;
  SectorPipe_In++;
 
@@ -106,6 +106,7 @@ class PS_CDC
 
  enum { SectorPipe_Count = 2 };
  uint8 SectorPipe[SectorPipe_Count][2352];
+ bool SectorPipe_Cooked[SectorPipe_Count];	// EDC/L-EC not synthesized, see CDInterface::ReadRawSectorCooked().
  uint8 SectorPipe_Pos;
  uint8 SectorPipe_In;
 
@@ -26,6 +26,7 @@
 #include "state.h"
 #include "movie.h"
 #include "netplay.h"
+#include "netplay_rollback.h"
 #include "video.h"
 #include "video/resize.h"
 
@@ -53,6 +54,9 @@ struct StateMem
 
  std::map<std::string, StateSectionMapEntry> secmap; // For loads
 
+ uint32 delta_token = 0; // For MDFNSS_SaveSMDelta()
+ uint64 layout = 0;	 // Hash of the data-only state layout, for MDFNSS_SaveSMDelta() and MDFNSS_LoadSMDelta()
+
  std::exception_ptr deferred_error;
  void ThrowDeferred(void);
 };
@@ -303,9 +307,16 @@ static void ReadStateChunk(Stream *st, const SFORMAT *sf, const char* sname, uin
 //
 // Fast raw chunk reader/writer.
 //
+static INLINE void LayoutHash(StateMem* sm, const uint64 v)
+{
+ sm->layout = (sm->layout ^ v) * 0x100000001B3ULL;
+}
+
 template<bool load>
-static void FastRWChunk(Stream *st, const SFORMAT *sf)
+static void FastRWChunk(StateMem* sm, const SFORMAT *sf)
 {
+ Stream* st = sm->st;
+
  while(sf->size || sf->name)	// Size can sometimes be zero, so also check for the text name.  These two should both be zero only at the end of a struct.
  {
   if(!sf->size || !sf->data)
@@ -316,7 +327,7 @@ static void FastRWChunk(Stream *st, const SFORMAT *sf)
 
   if(sf->size == ~0U)		/* Link to another struct.	*/
   {
-   FastRWChunk<load>(st, (const SFORMAT *)sf->data);
+   FastRWChunk<load>(sm, (const SFORMAT *)sf->data);
 
    sf++;
    continue;
@@ -339,6 +350,32 @@ static void FastRWChunk(Stream *st, const SFORMAT *sf)
   if(bytesize >= 65536)
    st->seek((st->tell() + 15) &~ 15, SEEK_SET);
 
+  LayoutHash(sm, (uint64)bytesize | ((uint64)repcount << 32));
+  LayoutHash(sm, p);
+
+  if(!load && sm->delta_token && !repcount && bytesize > 0 && (uint32)bytesize >= (1U << StateDirtyMap::PageShift))
+  {
+   StateDirtyMap* dm = StateDirtyMap::Find((void*)p, bytesize);
+
+   if(dm)
+   {
+    const uint32 page_size = 1U << StateDirtyMap::PageShift;
+
+    for(uint32 offs = 0, page = 0; offs < (uint32)bytesize; offs += page_size, page++)
+    {
+     const uint32 count = std::min<uint32>(page_size, bytesize - offs);
+
+     if(dm->PageChanged(page, sm->delta_token))
+      st->write((uint8*)p + offs, count);
+     else
+      st->seek(count, SEEK_CUR);
+    }
+
+    sf++;
+    continue;
+   }
+  }
+
   do
   {
    if(load)
@@ -381,7 +418,8 @@ bool MDFNSS_StateAction(StateMem *sm, const unsigned load, const bool data_only,
     if(memcmp(sname_canary + 32, SSFastCanary, 8))
      throw MDFN_Error(0, _("Section canary is a zombie AAAAAAAAAAGH!"));
 
-    FastRWChunk<true>(st, sf);
+    LayoutHash(sm, 32 + 8);
+    FastRWChunk<true>(sm, sf);
    }
    else
    {
@@ -390,7 +428,8 @@ bool MDFNSS_StateAction(StateMem *sm, const unsigned load, const bool data_only,
     memcpy(sname_canary + 32, SSFastCanary, 8);
     st->write(sname_canary, 32 + 8);
 
-    FastRWChunk<false>(st, sf);
+    LayoutHash(sm, 32 + 8);
+    FastRWChunk<false>(sm, sf);
    }
   }
   else
@@ -585,6 +624,153 @@ void MDFNSS_SaveSM(Stream *st, bool data_only, const MDFN_Surface *surface, cons
 	}
 }
 
+StateDirtyMap* StateDirtyMap::Head = nullptr;
+uint32 StateDirtyMap::Epoch = 1;
+
+StateDirtyMap::StateDirtyMap()
+{
+
+}
+
+StateDirtyMap::~StateDirtyMap()
+{
+ Kill();
+}
+
+void StateDirtyMap::Kill(void)
+{
+ if(pages)
+ {
+  if(prev)
+   prev->next = next;
+  else
+   Head = next;
+
+  if(next)
+   next->prev = prev;
+
+  prev = next = nullptr;
+  pages.reset(nullptr);
+ }
+
+ data = nullptr;
+ size = 0;
+}
+
+void StateDirtyMap::Init(const void* data_, const uint32 size_)
+{
+ if(!pages)
+ {
+  next = Head;
+  prev = nullptr;
+
+  if(Head)
+   Head->prev = this;
+
+  Head = this;
+ }
+
+ data = (const uint8*)data_;
+ size = size_;
+ pages.reset(new uint32[(size + (1U << PageShift) - 1) >> PageShift]);
+
+ MarkAll();
+}
+
+void StateDirtyMap::MarkAll(void)
+{
+ std::fill(pages.get(), pages.get() + ((size + (1U << PageShift) - 1) >> PageShift), Epoch);
+}
+
+void StateDirtyMap::MarkAllMaps(void)
+{
+ for(StateDirtyMap* dm = Head; dm; dm = dm->next)
+  dm->MarkAll();
+}
+
+void StateDirtyMap::MarkPtr(const void* p)
+{
+ for(StateDirtyMap* dm = Head; dm; dm = dm->next)
+ {
+  if((const uint8*)p >= dm->data && (const uint8*)p < (dm->data + dm->size))
+   dm->Mark((const uint8*)p - dm->data);
+ }
+}
+
+StateDirtyMap* StateDirtyMap::Find(const void* p, const uint32 size)
+{
+ for(StateDirtyMap* dm = Head; dm; dm = dm->next)
+ {
+  if(dm->data == p && dm->size >= size)
+   return dm;
+ }
+
+ return nullptr;
+}
+
+//
+// Any page written to after this call will have an epoch >= the returned token, and any page not written to will have an epoch < the
+// returned token.
+//
+uint32 StateDirtyMap::NewToken(void)
+{
+ return ++Epoch;
+}
+
+void MDFNSS_SaveSMDelta(MemoryStream* st, StateDeltaToken* token)
+{
+ if(!MDFNGameInfo->StateAction)
+ {
+  throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
+ }
+
+ uint32 delta_token = st->size() ? token->epoch : 0;
+
+ for(;;)
+ {
+  StateMem sm(st);
+
+  sm.delta_token = delta_token;
+  st->rewind();
+  MDFN_StateAction(&sm, 0, true);
+  sm.ThrowDeferred();
+  st->truncate(st->tell());
+
+  //
+  // Skipped-over pages are only valid if every variable is at the same position in the stream as it was in the state "token" was
+  // obtained for; if the layout changed(e.g. a variable-sized array grew), redo the save in full.
+  //
+  if(delta_token && sm.layout != token->layout)
+  {
+   delta_token = 0;
+   continue;
+  }
+
+  token->epoch = StateDirtyMap::NewToken();
+  token->layout = sm.layout;
+  break;
+ }
+}
+
+void MDFNSS_LoadSMDelta(MemoryStream* st, StateDeltaToken* token)
+{
+ if(!MDFNGameInfo->StateAction)
+ {
+  throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
+ }
+
+ StateDirtyMap::MarkAllMaps();
+
+ StateMem sm(st);
+
+ st->rewind();
+ MDFN_StateAction(&sm, MEDNAFEN_VERSION_NUMERIC, true);
+ sm.ThrowDeferred();
+
+ token->epoch = StateDirtyMap::NewToken();
+ token->layout = sm.layout;
+}
+
 void MDFNSS_LoadSM(Stream *st, bool data_only, const int fuzz)
 {
 	if(!MDFNGameInfo->StateAction)
@@ -592,6 +778,8 @@ void MDFNSS_LoadSM(Stream *st, bool data_only, const int fuzz)
 	 throw MDFN_Error(0, _("Module \"%s\" doesn't support save states."), MDFNGameInfo->shortname);
 	}
 
+	StateDirtyMap::MarkAllMaps();
+
 	if(MDFN_LIKELY(data_only))
 	{
 	 StateMem sm(st);
@@ -862,6 +1050,9 @@ bool MDFNI_LoadState(const char *fname, const char *suffix) noexcept
      from this ;)).
   */
 
+  if(MDFNrollback)
+   throw MDFN_Error(0, _("Can't load states during rollback netplay."));
+
   {
    GZFileStream st(fname ? std::string(fname) : MDFN_MakeFName(MDFNMKF_STATE,CurrentState,suffix), GZFileStream::MODE::READ);
    uint8 header[32];
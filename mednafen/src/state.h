@@ -32,6 +32,7 @@ namespace Mednafen
 void MDFNSS_GetStateInfo(const std::string& path, StateStatusStruct* status);
 
 struct StateMem;
+class MemoryStream;
 
 enum : int
 {
@@ -59,6 +60,22 @@ enum : int
 void MDFNSS_SaveSM(Stream *st, bool data_only = false, const MDFN_Surface *surface = (MDFN_Surface *)NULL, const MDFN_Rect *DisplayRect = (MDFN_Rect*)NULL, const int32 *LineWidths = (int32*)NULL);
 void MDFNSS_LoadSM(Stream *st, bool data_only = false, const int fuzz = MDFNSS_FUZZ_DISABLED);
 
+//
+// Data-only save into a MemoryStream that already holds a data-only save state of the currently-loaded game, skipping over pages of
+// dirty-tracked arrays(see StateDirtyMap) that haven't been written to since "st" was last saved to or loaded from via these functions.
+// "token" tracks that, and must be kept with "st"; a default-constructed token, or an empty "st", forces a full save.
+//
+// MDFNSS_LoadSMDelta() is a data-only load from the start of "st" that updates "token".
+//
+struct StateDeltaToken
+{
+ uint32 epoch = 0;
+ uint64 layout = 0;
+};
+
+void MDFNSS_SaveSMDelta(MemoryStream* st, StateDeltaToken* token);
+void MDFNSS_LoadSMDelta(MemoryStream* st, StateDeltaToken* token);
+
 void MDFNSS_CheckStates(void);
 
 // For emulation modules' internal use.
@@ -233,6 +250,61 @@ static_assert(sizeof(double) == 8, "sizeof(double) != 8");
 
 #define SFEND { nullptr, nullptr, 0, 0, SFORMAT::FORM::GENERIC, 0, 0 }
 
+//
+// Optional page-granular write tracking for a large array saved via SFORMAT, so that MDFNSS_SaveSMDelta() can skip over unchanged pages.
+//
+// Init() the map with the same pointer used in the array's SFORMAT entry, then call Mark() with the byte offset of every write to
+// the array.  Writes that bypass the emulated write paths(power-on initialization, cheats, debugger pokes) must be followed by
+// MarkAll(), MarkAllMaps(), or MarkPtr(); loading a save state marks everything as changed.
+//
+class StateDirtyMap
+{
+ public:
+
+ enum : unsigned { PageShift = 10 };
+
+ StateDirtyMap();
+ ~StateDirtyMap();
+
+ void Init(const void* data, const uint32 size);
+ void Kill(void);
+
+ INLINE void Mark(const uint32 offset)
+ {
+  pages[offset >> PageShift] = Epoch;
+ }
+
+ void MarkAll(void);
+
+ static void MarkAllMaps(void);
+ static void MarkPtr(const void* p);
+
+ // For the save state code.
+ static StateDirtyMap* Find(const void* p, const uint32 size);
+ static uint32 NewToken(void);
+
+ INLINE bool PageChanged(const uint32 page, const uint32 token) const
+ {
+  return pages[page] >= token;
+ }
+
+ private:
+
+ StateDirtyMap(const StateDirtyMap&) = delete;
+ StateDirtyMap& operator=(const StateDirtyMap&) = delete;
+
+ const uint8* data = nullptr;
+ uint32 size = 0;
+ std::unique_ptr<uint32[]> pages;
+
+ // Intrusive list of initialized maps; not a container, so that destruction order of static maps doesn't matter.
+ StateDirtyMap* prev = nullptr;
+ StateDirtyMap* next = nullptr;
+ static StateDirtyMap* Head;
+
+ static uint32 Epoch;
+};
+
 //
 // 'load' is 0 on save, and the version numeric contained in the save state on load.
 //
@@ -25,6 +25,7 @@
 #include "state_rewind.h"
 
 #include <mednafen/MemoryStream.h>
+#include <mednafen/MThreading.h>
 #include <mednafen/quicklz/quicklz.h>
 
 #if QLZ_COMPRESSION_LEVEL != 0
@@ -47,6 +48,7 @@ static size_t bcs_pos;
 
 static uint32 SRW_AllocHint;
 static std::unique_ptr<MemoryStream> ss_prev;
+static std::unique_ptr<MemoryStream> ss_spare;	// Recycled uncompressed state buffer, handed back by the compression thread.
 
 static union
 {
@@ -54,10 +56,152 @@ static union
  char decompress[QLZ_SCRATCH_DECOMPRESS];
 } qlz_scratch;
 
+//
+// XOR filtering and compression of the previous state are done in a separate thread, overlapping with emulation of
+// the next frame.  The emulation thread waits on ack_sem before touching bcs[], bcs_pos, ss_spare, or the compression
+// thread's error status, and before handing off the next command.
+//
+enum
+{
+ Command_NOP = 0,
+ Command_Compress,
+ Command_Exit
+};
+
+static MThreading::Thread* CompressThread = nullptr;
+static MThreading::Sem* command_sem = nullptr;
+static MThreading::Sem* ack_sem = nullptr;
+static uint32 pending_command;
+static std::unique_ptr<MemoryStream> pending_prev;
+static MemoryStream* pending_cur;
+static std::unique_ptr<MemoryStream> compress_buf;
+static std::string CompressError;
+
+static void StopCompressThread(void)
+{
+ if(CompressThread)
+ {
+  MThreading::Sem_Wait(ack_sem);
+  pending_command = Command_Exit;
+  MThreading::Sem_Post(command_sem);
+  //
+  MThreading::Thread_Wait(CompressThread, nullptr);
+  CompressThread = nullptr;
+ }
+
+ if(command_sem)
+ {
+  MThreading::Sem_Destroy(command_sem);
+  command_sem = nullptr;
+ }
+
+ if(ack_sem)
+ {
+  MThreading::Sem_Destroy(ack_sem);
+  ack_sem = nullptr;
+ }
+}
+
 static void Cleanup(void)
 {
+ StopCompressThread();
+
  bcs.clear();
  ss_prev.reset(nullptr);
+ ss_spare.reset(nullptr);
+ pending_prev.reset(nullptr);
+ pending_cur = nullptr;
+ compress_buf.reset(nullptr);
+ CompressError.clear();
+}
+
+static INLINE void DoXORFilter(MemoryStream* prev, MemoryStream* cur) noexcept
+{
+ MDFN_FastMemXOR(prev->map(), cur->map(), std::min(prev->size(), cur->size()));
+}
+
+//
+// Compresses into the packet's existing buffer when it has one(the packet being overwritten is the oldest in the
+// ring), rather than allocating a new buffer for every frame.
+//
+static INLINE void DoCompress(StateMemPacket* smp, MemoryStream* data)
+{
+ const uint32 uncompressed_len = data->size();
+ const uint32 max_compressed_len = (uncompressed_len + 400);
+ uint32 dst_len;
+
+ if(!compress_buf)
+  compress_buf.reset(new MemoryStream(max_compressed_len, -1));
+ else if(compress_buf->size() < max_compressed_len)
+  compress_buf->truncate(max_compressed_len);
+
+ dst_len = qlz_compress(data->map(), (char*)compress_buf->map(), uncompressed_len, qlz_scratch.compress);
+
+ if(!smp->data)
+  smp->data.reset(new MemoryStream(dst_len, -1));
+ else
+  smp->data->truncate(dst_len);
+
+ memcpy(smp->data->map(), compress_buf->map(), dst_len);
+ smp->uncompressed_len = uncompressed_len;
+}
+
+static int CompressThreadStart(void* data)
+{
+ bool running = true;
+
+ while(running)
+ {
+  MThreading::Sem_Wait(command_sem);
+  //
+  const uint32 command = pending_command;
+
+  if(command == Command_Exit)
+   running = false;
+  else if(command == Command_Compress && CompressError.empty())
+  {
+   try
+   {
+    DoXORFilter(pending_prev.get(), pending_cur);
+    DoCompress(&bcs[bcs_pos], pending_prev.get());
+    bcs_pos = (bcs_pos + 1) % bcs.size();
+    ss_spare = std::move(pending_prev);
+   }
+   catch(std::exception& e)
+   {
+    CompressError = e.what();
+   }
+  }
+
+  pending_prev.reset(nullptr);
+  pending_cur = nullptr;
+  MThreading::Sem_Post(ack_sem);
+ }
+
+ return 0;
+}
+
+//
+// Waits for the compression thread to finish any pending work; must be followed by a call to PostCommand().
+//
+static void WaitCompress(void)
+{
+ MThreading::Sem_Wait(ack_sem);
+
+ if(!CompressError.empty())
+ {
+  const std::string err = CompressError;
+
+  MThreading::Sem_Post(ack_sem);
+
+  throw MDFN_Error(0, "%s", err.c_str());
+ }
+}
+
+static void PostCommand(const uint32 command)
+{
+ pending_command = command;
+ MThreading::Sem_Post(command_sem);
 }
 
 void MDFNSRW_Begin(void) noexcept
@@ -75,6 +219,11 @@ void MDFNSRW_Begin(void) noexcept
 
    SRW_AllocHint = 8192;
 
+   command_sem = MThreading::Sem_Create();
+   ack_sem = MThreading::Sem_Create();
+   CompressThread = MThreading::Thread_Create(CompressThreadStart, nullptr, "MDFN State Rewind");
+   PostCommand(Command_NOP);
+
    Active = true;
   }
   catch(std::exception &e)
@@ -101,60 +250,62 @@ bool MDFNSRW_IsRunning(void) noexcept
  return Active;
 }
 
-static INLINE void DoXORFilter(MemoryStream* prev, MemoryStream* cur) noexcept
-{
- MDFN_FastMemXOR(prev->map(), cur->map(), std::min(prev->size(), cur->size()));
-}
-
-
-static INLINE std::unique_ptr<MemoryStream> DoCompress(MemoryStream* data)
-{
- const uint32 uncompressed_len = data->size();
- const uint32 max_compressed_len = (uncompressed_len + 400);
- std::unique_ptr<MemoryStream> tmp_buf(new MemoryStream(max_compressed_len, -1));
- uint32 dst_len;
-
- dst_len = qlz_compress(data->map(), (char*)tmp_buf->map(), uncompressed_len, qlz_scratch.compress);
- tmp_buf->truncate(dst_len);
- tmp_buf->shrink_to_fit();
-
- return tmp_buf;
-}
-
 //
 //
 //
 static bool DoRewind(void)
 {
- //
- // No save states available.
- //
- if(!ss_prev)
-  return false;
+ WaitCompress();
 
- //
- // Load most recent state.
- //
- ss_prev->rewind();
- MDFNSS_LoadSM(ss_prev.get(), true);
+ try
+ {
+  //
+  // No save states available.
+  //
+  if(!ss_prev)
+  {
+   PostCommand(Command_NOP);
+   return false;
+  }
 
- //
- // If a compressed state exists, decompress it.
- //
- StateMemPacket* smp = &bcs[(bcs_pos + bcs.size() - 1) % bcs.size()];
+  //
+  // Load most recent state.
+  //
+  ss_prev->rewind();
+  MDFNSS_LoadSM(ss_prev.get(), true);
 
- if(smp->data)
- {
-  std::unique_ptr<MemoryStream> tmp(new MemoryStream(smp->uncompressed_len, -1));
-  qlz_decompress((char*)smp->data->map(), tmp->map(), qlz_scratch.decompress);
-  smp->data.reset(nullptr);
-  bcs_pos = (bcs_pos + bcs.size() - 1) % bcs.size();
   //
-  DoXORFilter(tmp.get(), ss_prev.get());
+  // If a compressed state exists, decompress it.
   //
-  ss_prev = std::move(tmp);
+  StateMemPacket* smp = &bcs[(bcs_pos + bcs.size() - 1) % bcs.size()];
+
+  if(smp->data)
+  {
+   std::unique_ptr<MemoryStream> tmp(std::move(ss_spare));
+
+   if(!tmp)
+    tmp.reset(new MemoryStream(smp->uncompressed_len, -1));
+   else
+    tmp->truncate(smp->uncompressed_len);
+
+   qlz_decompress((char*)smp->data->map(), tmp->map(), qlz_scratch.decompress);
+   smp->data.reset(nullptr);
+   bcs_pos = (bcs_pos + bcs.size() - 1) % bcs.size();
+   //
+   DoXORFilter(tmp.get(), ss_prev.get());
+   //
+   ss_spare = std::move(ss_prev);
+   ss_prev = std::move(tmp);
+  }
+ }
+ catch(...)
+ {
+  PostCommand(Command_NOP);
+  throw;
  }
 
+ PostCommand(Command_NOP);
+
  return true;
 }
 
@@ -163,33 +314,48 @@ static bool DoRewind(void)
 //
 static void DoRecord(void)
 {
- //
- // Save current state
- //
- std::unique_ptr<MemoryStream> ss_cur(new MemoryStream(SRW_AllocHint));
+ WaitCompress();
 
- MDFNSS_SaveSM(ss_cur.get(), true);
+ try
+ {
+  //
+  // Save current state
+  //
+  std::unique_ptr<MemoryStream> ss_cur(std::move(ss_spare));
 
- SRW_AllocHint = std::max<uint32>(SRW_AllocHint, ss_cur->size());
+  if(!ss_cur)
+   ss_cur.reset(new MemoryStream(SRW_AllocHint));
+  else
+  {
+   ss_cur->rewind();
+   ss_cur->truncate(0);
+  }
 
- //
- // Compress previous state if it exists.
- //
- if(ss_prev)
- {
-  DoXORFilter(ss_prev.get(), ss_cur.get());
+  MDFNSS_SaveSM(ss_cur.get(), true);
 
-  //printf("Compress: %zu\n", ss_prev->size());
+  SRW_AllocHint = std::max<uint32>(SRW_AllocHint, ss_cur->size());
 
-  bcs[bcs_pos].data = DoCompress(ss_prev.get());
-  bcs[bcs_pos].uncompressed_len = ss_prev->size();
-  bcs_pos = (bcs_pos + 1) % bcs.size();
+  //
+  // Hand off the previous state, if it exists, to the compression thread.
+  //
+  if(ss_prev)
+  {
+   pending_prev = std::move(ss_prev);
+   pending_cur = ss_cur.get();
+  }
+
+  //
+  // Make current state previous for next time.
+  //
+  ss_prev = std::move(ss_cur);
+ }
+ catch(...)
+ {
+  PostCommand(Command_NOP);
+  throw;
  }
 
- //
- // Make current state previous for next time.
- //
- ss_prev = std::move(ss_cur);
+ PostCommand(pending_prev ? Command_Compress : Command_NOP);
 }
 
 bool MDFNSRW_Frame(bool rewind) noexcept
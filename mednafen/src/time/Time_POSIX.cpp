@@ -150,6 +150,25 @@ int64 MonoUS(void)
  }
 }
 
+int64 MonoNS(void)
+{
+ if(MDFN_UNLIKELY(!Initialized))
+  Time_Init();
+
+ {
+  struct timespec tp;
+
+  if(MDFN_UNLIKELY(clock_gettime(CLOCK_MONOTONIC, &tp) == -1))
+  {
+   ErrnoHolder ene(errno);
+
+   throw MDFN_Error(ene.Errno(), _("%s failed: %s"), "clock_gettime()", ene.StrError());
+  }
+
+  return (int64)(tp.tv_sec - cgt_base.tv_sec) * 1000 * 1000 * 1000 + (tp.tv_nsec - cgt_base.tv_nsec);
+ }
+}
+
 void SleepMS(uint32 amount) noexcept
 {
  if(MDFN_UNLIKELY(!Initialized))
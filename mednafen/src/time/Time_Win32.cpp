@@ -32,12 +32,23 @@ namespace Time
 
 static bool Initialized = false;
 static uint32 tgt_base;
+static int64 qpc_base;
+static int64 qpc_freq;
 static BOOL WINAPI (*p_GetTimeZoneInformationForYear)(USHORT, PDYNAMIC_TIME_ZONE_INFORMATION, LPTIME_ZONE_INFORMATION);
 
 void Time_Init(void)
 {
  tgt_base = timeGetTime();
 
+ {
+  LARGE_INTEGER tmp;
+
+  QueryPerformanceFrequency(&tmp);
+  qpc_freq = tmp.QuadPart;
+  QueryPerformanceCounter(&tmp);
+  qpc_base = tmp.QuadPart;
+ }
+
  p_GetTimeZoneInformationForYear = (decltype(p_GetTimeZoneInformationForYear))Win32Common::GetProcAddress_TOE(Win32Common::GetModuleHandle_TOE(TEXT("kernel32.dll")), "GetTimeZoneInformationForYear");
  //
  Initialized = true;
@@ -51,6 +62,20 @@ int64 MonoUS(void)
  return (int64)1000 * (timeGetTime() - tgt_base);
 }
 
+int64 MonoNS(void)
+{
+ if(MDFN_UNLIKELY(!Initialized))
+  Time_Init();
+
+ LARGE_INTEGER tmp;
+ int64 ticks;
+
+ QueryPerformanceCounter(&tmp);
+ ticks = tmp.QuadPart - qpc_base;
+
+ return (ticks / qpc_freq) * 1000000000 + (ticks % qpc_freq) * 1000000000 / qpc_freq;
+}
+
 void SleepMS(uint32 amount) noexcept
 {
  if(MDFN_UNLIKELY(!Initialized))